@@ -5,84 +5,286 @@
     Playlisted2
 
     VSTi Fix: Logs are now saved to AppData/Playlisted/Logs instead of the Desktop.
+    PERF: Asynchronous. log() copies the message into a preallocated lock-free
+          ring of fixed-size records and returns - no lock, no allocation, no
+          file I/O - so the engine pump and the audio thread may log. A
+          background writer drains the ring every 50 ms, batches the lines
+          and rotates the file (Name.txt -> Name.1.txt ... ) at 2 MB.
+    ADDED: Runtime verbosity (setLevel, PLAYLISTED_LOG_LEVEL=error|warning|
+           info|debug). Shared by the plugin and the engine, which logs to
+           its own file (setFileName). The writer runs while an
+           AppLogger::Session exists (plugin instance, engine app), so it is
+           never started or joined from static destruction (DLL unload).
 
   ==============================================================================
 */
 
 #pragma once
 #include <juce_core/juce_core.h>
+#include <atomic>
+#include <cstring>
 #include <fstream>
 #include <mutex>
+#include <thread>
 
 class AppLogger
 {
 public:
-    enum class Level { Info, Warning, Error, Debug };
+    // In order of verbosity: a message is kept if its level <= the current level
+    enum class Level { Error = 0, Warning, Info, Debug };
+
     static AppLogger& getInstance()
     {
         static AppLogger instance;
         return instance;
     }
 
-    void log(Level level, const juce::String& message)
+    // Any thread, real-time safe. Messages that do not fit in a record are truncated;
+    // when the ring is full the message is dropped and counted.
+    void log(Level level, const char* utf8, size_t length)
     {
-        std::lock_guard<std::mutex> lock(mutex);
-        if (!logFile.is_open()) tryOpenLogFile();
-        
-        if (!logFile.is_open())
+        if (!isEnabled(level)) return;
+
+        const auto pos = claimSlot();
+        if (pos == invalidSlot)
         {
-            DBG("[LOGFILE FAILED] " + message);
+            droppedRecords.fetch_add(1, std::memory_order_relaxed);
             return;
         }
-            
-        auto time = juce::Time::getCurrentTime().toString(true, true, true, true);
-        juce::String levelStr;
-        switch (level)
-        {
-            case Level::Info:    levelStr = "INFO"; break;
-            case Level::Warning: levelStr = "WARN"; break;
-            case Level::Error:   levelStr = "ERROR"; break;
-            case Level::Debug:   levelStr = "DEBUG"; break;
-        }
-        
-        juce::String logLine = "[" + time + "] [" + levelStr + "] " + message;
-        logFile << logLine.toStdString() << std::endl;
-        logFile.flush(); 
-        DBG(logLine);
+
+        auto& record = records[pos & (RingRecords - 1)];
+        record.timeMs = juce::Time::currentTimeMillis();
+        record.level = level;
+        size_t n = juce::jmin(length, sizeof(Record::text));
+        while (n < length && n > 0 && (utf8[n] & 0xC0) == 0x80) --n;   // Truncate on a character boundary
+        record.length = (uint16_t)n;
+        std::memcpy(record.text, utf8, n);
+        record.sequence.store(pos + 1, std::memory_order_release);   // Published
     }
 
+    void log(Level level, const juce::String& message)
+    {
+        if (isEnabled(level))
+            log(level, message.toRawUTF8(), message.getNumBytesAsUTF8());
+    }
+
+    void log(Level level, const char* message) { log(level, message, std::strlen(message)); }
+
     void logInfo(const juce::String& message)    { log(Level::Info, message); }
     void logWarning(const juce::String& message) { log(Level::Warning, message); }
     void logError(const juce::String& message)   { log(Level::Error, message); }
     void logDebug(const juce::String& message)   { log(Level::Debug, message); }
 
+    // Verbosity, any thread, takes effect immediately
+    void setLevel(Level newLevel)   { level.store((int)newLevel, std::memory_order_relaxed); }
+    Level getLevel() const          { return (Level)level.load(std::memory_order_relaxed); }
+    bool isEnabled(Level l) const   { return (int)l <= level.load(std::memory_order_relaxed); }
+
+    // Log file inside AppData/Playlisted/Logs. Switches at the next batch.
+    void setFileName(const juce::String& name)
+    {
+        std::lock_guard<std::mutex> lock(fileMutex);   // Writer thread only, never taken by log()
+        if (name == fileName) return;
+        fileName = name;
+        if (logFile.is_open()) logFile.close();
+    }
+
+    // Writes everything queued so far (blocks the caller - not for hot threads)
+    void flush() { drain(); }
+
+    // Keeps the background writer running while at least one Session is alive
+    class Session
+    {
+    public:
+        Session()  { getInstance().acquireWriter(); }
+        ~Session() { getInstance().releaseWriter(); }
+        JUCE_DECLARE_NON_COPYABLE(Session)
+    };
+
 private:
-    AppLogger() { tryOpenLogFile(); }
+    static constexpr int RingRecords = 1024;        // Power of two
+    static constexpr int WriterIntervalMs = 50;
+    static constexpr int64_t RotateBytes = 2 * 1024 * 1024;
+    static constexpr int RotateKeep = 3;             // Name.1.txt .. Name.3.txt
+    static constexpr uint64_t invalidSlot = ~(uint64_t)0;
+
+    // One fixed-size record per message (256 bytes with the header)
+    struct Record
+    {
+        std::atomic<uint64_t> sequence { 0 };   // pos + 1 once written, pos + RingRecords once free again
+        juce::int64 timeMs = 0;
+        Level level = Level::Info;
+        uint16_t length = 0;
+        char text[256 - 24];
+    };
+
+    AppLogger()
+    {
+        for (uint64_t i = 0; i < (uint64_t)RingRecords; ++i)
+            records[i].sequence.store(i, std::memory_order_relaxed);
+
+        level.store((int)getLevelFromEnvironment(), std::memory_order_relaxed);
+    }
 
     ~AppLogger()
     {
+        // Sessions have stopped the writer by now
+        drain();
         if (logFile.is_open()) logFile.close();
     }
-    
-    void tryOpenLogFile()
+
+    void acquireWriter()
+    {
+        std::lock_guard<std::mutex> lock(sessionMutex);
+        if (numSessions++ > 0) return;
+        running.store(true, std::memory_order_release);
+        writer = std::thread([this] { writerLoop(); });
+    }
+
+    void releaseWriter()
+    {
+        std::lock_guard<std::mutex> lock(sessionMutex);
+        if (--numSessions > 0) return;
+        running.store(false, std::memory_order_release);
+        if (writer.joinable()) writer.join();
+        drain();
+    }
+
+    static Level getLevelFromEnvironment()
+    {
+        const auto value = juce::SystemStats::getEnvironmentVariable("PLAYLISTED_LOG_LEVEL", {}).trim().toLowerCase();
+        if (value == "error")   return Level::Error;
+        if (value == "warning") return Level::Warning;
+        if (value == "debug")   return Level::Debug;
+        return Level::Info;
+    }
+
+    // Bounded MPSC claim (per-slot sequence numbers): a slot is free for pos once its sequence equals pos
+    uint64_t claimSlot()
+    {
+        auto pos = writePos.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            auto& record = records[pos & (RingRecords - 1)];
+            const auto seq = record.sequence.load(std::memory_order_acquire);
+
+            if (seq == pos)
+            {
+                if (writePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    return pos;
+            }
+            else if (seq < pos)
+            {
+                return invalidSlot;   // Ring full: the writer has not freed this slot yet
+            }
+            else
+            {
+                pos = writePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void writerLoop()
+    {
+        while (running.load(std::memory_order_acquire))
+        {
+            drain();
+            std::this_thread::sleep_for(std::chrono::milliseconds(WriterIntervalMs));
+        }
+    }
+
+    // Writer side: everything published so far as one batch, then rotate if needed
+    void drain()
+    {
+        std::lock_guard<std::mutex> lock(fileMutex);
+
+        juce::MemoryOutputStream batch;
+        for (;;)
+        {
+            auto& record = records[readPos & (RingRecords - 1)];
+            if (record.sequence.load(std::memory_order_acquire) != readPos + 1) break;
+
+            appendLine(batch, record.timeMs, record.level, juce::String::fromUTF8(record.text, record.length));
+            record.sequence.store(readPos + RingRecords, std::memory_order_release);   // Free for the next lap
+            ++readPos;
+        }
+
+        if (const auto dropped = droppedRecords.exchange(0, std::memory_order_relaxed))
+            appendLine(batch, juce::Time::currentTimeMillis(), Level::Warning,
+                       "Logger: " + juce::String((int)dropped) + " message(s) dropped, ring full");
+
+        if (batch.getDataSize() == 0) return;
+
+        if (!logFile.is_open()) openLogFile();
+        if (!logFile.is_open())
+        {
+            DBG("[LOGFILE FAILED] " + batch.toString());
+            return;
+        }
+
+        logFile.write(static_cast<const char*>(batch.getData()), (std::streamsize)batch.getDataSize());
+        logFile.flush();
+        DBG(batch.toString().trimEnd());
+
+        if ((int64_t)logFile.tellp() >= RotateBytes)
+            rotate();
+    }
+
+    static void appendLine(juce::MemoryOutputStream& out, juce::int64 timeMs, Level l, const juce::String& text)
+    {
+        static const char* const names[] = { "ERROR", "WARN", "INFO", "DEBUG" };
+        out << "[" << juce::Time(timeMs).toString(true, true, true, true) << "] ["
+            << names[(int)l] << "] " << text << "\n";
+    }
+
+    juce::File getLogFile(int index) const
+    {
+        auto logDir = juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+                          .getChildFile("Playlisted").getChildFile("Logs");
+        const auto name = juce::File::createLegalFileName(fileName);
+        return logDir.getChildFile(index == 0 ? name + ".txt" : name + "." + juce::String(index) + ".txt");
+    }
+
+    void openLogFile()
     {
         // FIX: Store logs in AppData, not Desktop
-        auto appData = juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory);
-        auto logDir = appData.getChildFile("Playlisted").getChildFile("Logs");
-        
-        if (!logDir.exists()) logDir.createDirectory();
-        
-        logFilePath = logDir.getChildFile("Playlisted_VST_Log.txt");
-        logFile.open(logFilePath.getFullPathName().toStdString(), std::ios::out | std::ios::app);
-        
-        if (logFile.is_open()) {
+        auto file = getLogFile(0);
+        if (!file.getParentDirectory().exists()) file.getParentDirectory().createDirectory();
+
+        logFile.open(file.getFullPathName().toStdString(), std::ios::out | std::ios::app);
+
+        if (logFile.is_open() && !sessionStarted) {
             logFile << "\n=== NEW SESSION ===\n" << std::endl;
+            sessionStarted = true;
         }
     }
 
+    // Name.txt -> Name.1.txt -> ... -> Name.<RotateKeep>.txt (oldest dropped)
+    void rotate()
+    {
+        logFile.close();
+        getLogFile(RotateKeep).deleteFile();
+        for (int i = RotateKeep - 1; i >= 0; --i)
+            getLogFile(i).moveFileTo(getLogFile(i + 1));
+        openLogFile();
+    }
+
+    Record records[RingRecords];
+    alignas(64) std::atomic<uint64_t> writePos { 0 };
+    alignas(64) std::atomic<uint32_t> droppedRecords { 0 };
+    std::atomic<int> level { (int)Level::Info };
+
+    // Writer side (fileMutex)
+    std::mutex fileMutex;
+    uint64_t readPos = 0;
     std::ofstream logFile;
-    std::mutex mutex;
-    juce::File logFilePath;
+    juce::String fileName { "Playlisted_VST_Log" };
+    bool sessionStarted = false;
+
+    std::mutex sessionMutex;
+    int numSessions = 0;
+    std::atomic<bool> running { false };
+    std::thread writer;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AppLogger)
 };
@@ -90,4 +292,4 @@ private:
 #define LOG_INFO(msg)    AppLogger::getInstance().logInfo(msg)
 #define LOG_WARNING(msg) AppLogger::getInstance().logWarning(msg)
 #define LOG_ERROR(msg)   AppLogger::getInstance().logError(msg)
-#define LOG_DEBUG(msg)   AppLogger::getInstance().logDebug(msg)
\ No newline at end of file
+#define LOG_DEBUG(msg)   AppLogger::getInstance().logDebug(msg)
@@ -10,14 +10,33 @@
          and handles the macOS /usr/bin/open process tracking issue.
     FIX: Cleans up shared memory file on shutdown.
     FIX: Desktop diagnostic logging for launch debugging.
+    PERF: Launch diagnostics go through the asynchronous AppLogger (AppData
+          log, no file I/O on the caller) instead of a desktop file.
     FIX: Wide-char API for Unicode path detection on Windows.
+    FIX: MIDI transport (audio thread) sends as IPCCaller::RealTime so it
+         never waits on the command queue.
+    ADDED: Per-instance deck segment registered in EngineControl. An engine
+           that is already running is reused, and it is only shut down
+           when no other instance still has a deck.
+    ADDED: Audio is read through DriftCompensator (adaptive resampler held
+           at a target ring fill). PLAYLISTED_DRIFT_COMP=0 reads directly.
+    ADDED: PLAYLISTED_HEADLESS=1 launches the engine with --headless
+           (audio only, no video windows).
+    ADDED: Playlist auto-advance (moved from PlaylistComponent). The next
+           track, its wait or crossfade are armed in the engine, which times
+           the transition; the finish/countdown path remains as a fallback.
+    PERF: Startup handshake instead of 20 blind ipc.initialize() retries:
+          engine ready -> deck Active -> map the segment once, polled every
+          20 ms. Each phase is logged with its timing; the DAW sample rate is
+          (re)sent on every connect.
+    ADDED: PLAYLISTED_ENGINE_WARM=1 launches the engine with --warm (stays
+           up between sessions with a pre-initialised spare deck).
 
   ==============================================================================
 */
 
 #include "AudioEngine.h"
 #include "AppLogger.h"
-#include <fstream>
 
 #if JUCE_WINDOWS
     #include <windows.h>
@@ -28,31 +47,19 @@
 
 using namespace juce;
 
-// ==============================================================================
-// Desktop diagnostic log
-// ==============================================================================
-static void logLaunchDiag(const juce::String& text)
-{
-    auto desktop = juce::File::getSpecialLocation(juce::File::userDesktopDirectory);
-    auto logFile = desktop.getChildFile("Playlisted_LaunchDiag.txt");
-    
-    std::ofstream stream(logFile.getFullPathName().toStdString(), std::ios::app);
-    if (stream.is_open())
-    {
-        auto time = juce::Time::getCurrentTime().toString(true, true, true, true);
-        stream << "[" << time.toStdString() << "] " << text.toStdString() << std::endl;
-    }
-}
-
 AudioEngine::AudioEngine()
 {
     formatManager.registerBasicFormats();
     remotePlayer = std::make_unique<RemotePlayerFacade>(ipc);
+
+    // Every instance gets its own segment (deck) inside the shared engine
+    ipc.setSegmentName(IPCConfig::makeDeckSegmentName(juce::Uuid().toString().substring(0, 16)));
     
-    logLaunchDiag("=== AudioEngine constructor called ===");
+    LOG_INFO("=== AudioEngine constructor called (" + ipc.getSegmentName() + ") ===");
     
-    launchEngine();
-    startTimer(200); 
+    beginEngineLink();
+    updateEngineLink();
+    startTimer(linkPollMs);
 }
 
 AudioEngine::~AudioEngine()
@@ -63,15 +70,31 @@ AudioEngine::~AudioEngine()
     cleanupSharedMemory();
 }
 
-// FIX: Remove stale shared memory file
+// FIX: Remove our deck segment in case the engine died without doing it
+// (this instance's deck only, the control segment is shared)
 void AudioEngine::cleanupSharedMemory()
 {
-    auto tempDir = juce::File::getSpecialLocation(juce::File::tempDirectory);
-    auto sharedFile = tempDir.getChildFile("Playlisted2_SharedMem_v4.dat");
-    if (sharedFile.existsAsFile())
+    SharedMemorySegment::remove(ipc.getSegmentName());
+}
+
+// Claim a deck slot in the engine registry (again, if the engine dropped ours)
+void AudioEngine::registerDeck()
+{
+    if (!control.isOpen())
     {
-        sharedFile.deleteFile();
+        if (!control.open()) return;
+        ipc.setDoorbell(&control.getDoorbell());
     }
+
+    if (control.isDeckOwnedBy(deckSlot, ipc.getSegmentName())) return;
+
+    const auto format = IPCConfig::getDeploymentAudioFormat();
+    deckSlot = control.claimDeck(ipc.getSegmentName(), format);
+
+    if (deckSlot >= 0)
+        LOG_INFO("Registered deck " + String(deckSlot) + ": " + ipc.getSegmentName());
+    else
+        LOG_ERROR("Deck registration FAILED (all " + String(IPCConfig::MaxDecks) + " decks in use)");
 }
 
 void AudioEngine::setPitchSemitones(int semitones)
@@ -142,47 +165,329 @@ void AudioEngine::processPitchShift(juce::AudioBuffer<float>& buffer)
 
 void AudioEngine::timerCallback()
 {
-    if (!ipc.isConnected()) 
+    // FIX: IPC initialization happens here (timer thread), NOT on audio thread
+    updateEngineLink();
+    if (linkState != EngineLink::Connected) return;
+
+    remotePlayer->updateStatus();
+    sendHeartbeat();
+    updateAutoAdvance();
+
+    // Every ~30 s at the 40 ms tick
+    if (useDriftCompensation && ++driftLogCounter >= 750)
+    {
+        driftLogCounter = 0;
+        LOG_INFO("AudioEngine: drift ratio=" + String(driftCompensator.getRatio(), 6)
+                 + " fillError=" + String(driftCompensator.getFillErrorFrames(), 1)
+                 + " target=" + String(driftCompensator.getTargetFillFrames())
+                 + " underruns=" + String((int)driftCompensator.getUnderrunCount())
+                 + " resyncs=" + String((int)driftCompensator.getResyncCount()));
+    }
+}
+
+// ==============================================================================
+// Engine link (startup handshake)
+// ==============================================================================
+void AudioEngine::beginEngineLink()
+{
+    linkBeginMs = Time::getMillisecondCounterHiRes();
+    engineReadyAtMs = deckActiveAtMs = 0.0;
+    spawnMs = -1.0;
+    launchAttempts = 0;   // Each chain (first link, reconnect, retry after the back-off) may launch again
+    setEngineLinkState(EngineLink::Registering);
+}
+
+void AudioEngine::setEngineLinkState(EngineLink newState)
+{
+    static const char* const names[] = { "Registering", "WaitingForEngine", "WaitingForDeck", "Connected", "Failed" };
+
+    if (newState != linkState)
+        LOG_INFO("Engine link: " + String(names[(int)linkState]) + " -> " + String(names[(int)newState])
+                 + " (+" + String(Time::getMillisecondCounterHiRes() - linkBeginMs, 1) + " ms)");
+
+    linkState = newState;
+    linkStateSinceMs = Time::getMillisecondCounter();
+
+    const int interval = newState == EngineLink::Connected ? 40 : linkPollMs;
+    if (getTimerInterval() != interval) startTimer(interval);
+}
+
+void AudioEngine::failEngineLink(const String& reason)
+{
+    LOG_ERROR("Engine link FAILED: " + reason + " - retrying in " + String((int)linkRetryMs / 1000) + " s");
+    setEngineLinkState(EngineLink::Failed);
+}
+
+// Message thread. Steps through as many states as are already satisfied.
+void AudioEngine::updateEngineLink()
+{
+    for (int step = 0; step < 4; ++step)
     {
-        if (startupRetries < 20)
+        const auto state = linkState;
+        const auto inState = Time::getMillisecondCounter() - linkStateSinceMs;
+
+        switch (state)
         {
-            // FIX: IPC initialization happens here (timer thread), NOT on audio thread
-            ipc.initialize();
-            if (!engineProcess.isRunning())
-            {
-                launchEngine();
-            }
-            startupRetries++;
+            case EngineLink::Registering:
+                registerDeck();
+                if (deckSlot < 0)
+                {
+                    // No control segment or no free slot yet
+                    if (inState > deckActiveTimeoutMs) failEngineLink("could not register a deck");
+                    break;
+                }
+                if (!control.isEngineAlive() && launchAttempts < maxLaunchAttempts)
+                {
+                    ++launchAttempts;
+                    launchEngine();
+                }
+                setEngineLinkState(EngineLink::WaitingForEngine);
+                break;
+
+            case EngineLink::WaitingForEngine:
+                if (control.isEngineReady())
+                {
+                    engineReadyAtMs = Time::getMillisecondCounterHiRes();
+                    setEngineLinkState(EngineLink::WaitingForDeck);
+                }
+                else if (inState > engineReadyTimeoutMs)
+                {
+                    failEngineLink("engine not ready after " + String((int)engineReadyTimeoutMs) + " ms");
+                }
+                break;
+
+            case EngineLink::WaitingForDeck:
+                if (!control.isEngineAlive() || !control.isDeckOwnedBy(deckSlot, ipc.getSegmentName()))
+                {
+                    // Engine went away, or freed our request (restart / invalid) - claim again
+                    setEngineLinkState(EngineLink::Registering);
+                }
+                else if (control.isDeckActive(deckSlot, ipc.getSegmentName()))
+                {
+                    deckActiveAtMs = Time::getMillisecondCounterHiRes();
+                    if (ipc.initialize()) onEngineConnected();
+                    else failEngineLink("deck segment " + ipc.getSegmentName() + " could not be mapped");
+                }
+                else if (inState > deckActiveTimeoutMs)
+                {
+                    failEngineLink("deck " + String(deckSlot) + " not opened by the engine");
+                }
+                break;
+
+            case EngineLink::Connected:
+                if (!ipc.isConnected())
+                {
+                    LOG_WARNING("Engine link lost (deck closed or engine gone) - reconnecting");
+                    beginEngineLink();
+                }
+                break;
+
+            case EngineLink::Failed:
+                if (inState > linkRetryMs) beginEngineLink();
+                break;
+        }
+
+        if (linkState == state) break;
+    }
+}
+
+void AudioEngine::onEngineConnected()
+{
+    if (dawSampleRate > 0.0)
+    {
+        ipc.setDawSampleRate((int)dawSampleRate);
+        ipc.setAudioTargetFill(driftCompensator.getTargetFillFrames());
+    }
+    ipc.flushAudioBuffer();
+
+    lastEngineBeatMs = 0;   // Restart stall detection
+    setEngineLinkState(EngineLink::Connected);
+
+    const double now = Time::getMillisecondCounterHiRes();
+    LOG_INFO("Engine link: connected in " + String(now - linkBeginMs, 1) + " ms ("
+             + (spawnMs >= 0.0 ? "spawn " + String(spawnMs, 1) + " ms" : String("attached to running engine"))
+             + ", engine ready +" + String(engineReadyAtMs - linkBeginMs, 1)
+             + " ms, deck active +" + String(deckActiveAtMs - linkBeginMs, 1)
+             + " ms, mapped +" + String(now - linkBeginMs, 1)
+             + " ms; engine startup " + String((int)control.getEngineStartupMs())
+             + " ms" + (control.isEngineWarm() ? " (warm)" : "")
+             + ", deck open " + String((int)control.getDeckOpenMs(deckSlot)) + " ms)");
+
+    if (!windowShownOnce)
+    {
+        showVideoWindow();
+        windowShownOnce = true;
+    }
+}
+
+// ==============================================================================
+// Playlist transport
+// ==============================================================================
+void AudioEngine::selectTrack(int index)
+{
+    if (index < 0 || index >= (int)playlist.size()) return;
+
+    activeTrackIndex = index;
+    waitingForTransition = false;
+    finishTicks = 0;
+
+    // The load drops the engine's preload; the next tick arms the new next track
+    preloadedIndex = -1;
+    preloadedItem = PlaylistItem();
+
+    auto& item = playlist[index];
+    remotePlayer->loadFile(item.filePath);
+    remotePlayer->setVolume(item.volume);
+    remotePlayer->setRate(item.playbackSpeed);
+    setPitchSemitones(item.pitchSemitones);
+}
+
+void AudioEngine::playTrack(int index)
+{
+    selectTrack(index);
+    remotePlayer->play();
+}
+
+int AudioEngine::getWaitSecondsRemaining() const
+{
+    double seconds = remotePlayer->getWaitSecondsRemaining();
+    if (waitingForTransition)
+        seconds = (int)(transitionDueMs - Time::getMillisecondCounter()) / 1000.0;
+    return seconds > 0.0 ? (int)std::ceil(seconds) : 0;
+}
+
+void AudioEngine::updateAutoAdvance()
+{
+    // The engine already switched to the preloaded track - just follow it
+    if (remotePlayer->takeGaplessAdvance())
+    {
+        if (preloadedIndex >= 0 && preloadedIndex < (int)playlist.size())
+        {
+            activeTrackIndex = preloadedIndex;
+            setPitchSemitones(playlist[activeTrackIndex].pitchSemitones);
         }
+        preloadedIndex = -1;
+        preloadedItem = PlaylistItem();
+        finishTicks = 0;
     }
-    else 
+
+    updateNextTrackPreload();
+
+    if (!autoPlayEnabled || activeTrackIndex < 0 || activeTrackIndex >= (int)playlist.size())
+        return;
+
+    // Fallback for a next track the engine did not take (video with a window, JSON commands)
+    if (waitingForTransition)
     {
-        if (getTimerInterval() != 40) startTimer(40);
-        if (startupRetries < 999) 
+        if ((int)(Time::getMillisecondCounter() - transitionDueMs) < 0) return;
+
+        waitingForTransition = false;
+        const int nextIndex = activeTrackIndex + 1;
+        if (nextIndex < (int)playlist.size()) playTrack(nextIndex);
+        else stopAllPlayback();
+        return;
+    }
+
+    // Debounced so a brief end-of-stream during a speed change never skips the track
+    if (!remotePlayer->hasFinished()) { finishTicks = 0; return; }
+    if (++finishTicks <= finishDebounceTicks) return;
+    finishTicks = 0;
+
+    if (activeTrackIndex + 1 < (int)playlist.size())
+    {
+        waitingForTransition = true;
+        remotePlayer->pause();
+
+        const int sec = playlist[activeTrackIndex].transitionDelaySec;
+        transitionDueMs = Time::getMillisecondCounter() + (juce::uint32)(sec > 0 ? sec * 1000 : 500);
+    }
+}
+
+// Arms the track after the current one in the engine: spliced in gaplessly,
+// started after the current item's Wait, or crossfaded into when "F" is set
+// (the Wait is ignored then). The engine skips video tracks it cannot preload;
+// those finish and go through the fallback above.
+void AudioEngine::updateNextTrackPreload()
+{
+    int wanted = -1;
+    float fadeSec = 0.0f, waitSec = 0.0f;
+    int fadeCurve = 0;
+
+    if (autoPlayEnabled && !waitingForTransition
+        && activeTrackIndex >= 0 && activeTrackIndex + 1 < (int)playlist.size())
+    {
+        const auto& current = playlist[activeTrackIndex];
+        wanted = activeTrackIndex + 1;
+        if (current.isCrossfade)
         {
-             showVideoWindow();
-             startupRetries = 999; 
+            fadeSec = current.crossfadeSec;
+            fadeCurve = current.crossfadeCurve;
         }
-        remotePlayer->updateStatus();
-        sendHeartbeat();
+        else
+            waitSec = (float)current.transitionDelaySec;
+    }
+
+    if (wanted == preloadedIndex)
+    {
+        if (wanted < 0) return;
+
+        // Same slot - only re-arm if the track, its settings or the transition changed
+        const auto& item = playlist[wanted];
+        if (item.filePath == preloadedItem.filePath && item.volume == preloadedItem.volume
+            && item.playbackSpeed == preloadedItem.playbackSpeed
+            && fadeSec == preloadedFadeSec && fadeCurve == preloadedFadeCurve && waitSec == preloadedWaitSec)
+            return;
+    }
+
+    if (wanted >= 0)
+    {
+        const auto& item = playlist[wanted];
+        remotePlayer->preloadNext(item.filePath, item.volume, item.playbackSpeed,
+                                  fadeSec, (IPCProtocol::FadeCurve)fadeCurve, waitSec);
+        preloadedItem = item;
+    }
+    else
+    {
+        remotePlayer->preloadNext({});
+        preloadedItem = PlaylistItem();
     }
+    preloadedIndex = wanted;
+    preloadedFadeSec = fadeSec;
+    preloadedFadeCurve = fadeCurve;
+    preloadedWaitSec = waitSec;
 }
 
+// Liveness through the deck segment's counters: we bump ours, and watch the engine's move
 void AudioEngine::sendHeartbeat()
 {
     if (!ipc.isConnected()) return;
-    juce::DynamicObject::Ptr o = new juce::DynamicObject();
-    o->setProperty("type", "heartbeat");
-    ipc.sendCommand(JSON::toString(var(o.get())));
+    ipc.beatHeartbeat();
+
+    const auto now = Time::getMillisecondCounter();
+    const auto engineBeat = ipc.getPeerHeartbeat();
+    if (engineBeat != lastEngineBeat || lastEngineBeatMs == 0)
+    {
+        if (engineStallLogged)
+            LOG_INFO("AudioEngine: engine deck responding again");
+        lastEngineBeat = engineBeat;
+        lastEngineBeatMs = now;
+        engineStallLogged = false;
+    }
+    else if (!engineStallLogged && now - lastEngineBeatMs > (juce::uint32)IPCConfig::EngineAliveTimeoutMs)
+    {
+        LOG_INFO("AudioEngine: no engine heartbeat for " + String((int)(now - lastEngineBeatMs)) + " ms");
+        engineStallLogged = true;
+    }
 }
 
-void AudioEngine::launchEngine()
+bool AudioEngine::launchEngine()
 {
-    if (engineProcess.isRunning()) return;
+    // Another instance (or an earlier session of this one) already runs the engine
+    if (engineProcess.isRunning() || control.isEngineAlive()) return false;
     File engineExe;
     File pluginDir;
 
-    logLaunchDiag("launchEngine() called");
+    LOG_INFO("launchEngine() called");
 
     #if JUCE_WINDOWS
         HMODULE hModule = NULL;
@@ -195,20 +500,20 @@ void AudioEngine::launchEngine()
             if (GetModuleFileNameW(hModule, wpath, MAX_PATH))
             {
                 pluginDir = File(String(wpath)).getParentDirectory();
-                logLaunchDiag("GetModuleFileNameW found plugin DLL at: " + pluginDir.getFullPathName());
+                LOG_INFO("GetModuleFileNameW found plugin DLL at: " + pluginDir.getFullPathName());
             }
             else
             {
-                logLaunchDiag("GetModuleFileNameW FAILED, error: " + String((int)GetLastError()));
+                LOG_ERROR("GetModuleFileNameW FAILED, error: " + String((int)GetLastError()));
             }
         }
         else
         {
-            logLaunchDiag("GetModuleHandleExW FAILED, error: " + String((int)GetLastError()));
+            LOG_ERROR("GetModuleHandleExW FAILED, error: " + String((int)GetLastError()));
         }
         engineExe = pluginDir.getChildFile("PlaylistedEngine.exe");
-        logLaunchDiag("Looking for engine at: " + engineExe.getFullPathName());
-        logLaunchDiag("Exists: " + String(engineExe.existsAsFile() ? "YES" : "NO"));
+        LOG_INFO("Looking for engine at: " + engineExe.getFullPathName());
+        LOG_INFO("Exists: " + String(engineExe.existsAsFile() ? "YES" : "NO"));
         
     #elif JUCE_MAC
         Dl_info info;
@@ -216,23 +521,21 @@ void AudioEngine::launchEngine()
         if (dladdr((void*)&dummyAnchor, &info))
         {
             pluginDir = File(info.dli_fname).getParentDirectory();
-            logLaunchDiag("dladdr found plugin at: " + pluginDir.getFullPathName());
             LOG_INFO("AudioEngine: dladdr found plugin at: " + pluginDir.getFullPathName());
         }
         else
         {
-            logLaunchDiag("dladdr FAILED");
+            LOG_ERROR("dladdr FAILED");
         }
         
         engineExe = pluginDir.getChildFile("PlaylistedEngine");
-        logLaunchDiag("Looking for engine at: " + engineExe.getFullPathName() + " exists: " + String(engineExe.existsAsFile() ? "YES" : "NO"));
+        LOG_INFO("Looking for engine at: " + engineExe.getFullPathName() + " exists: " + String(engineExe.existsAsFile() ? "YES" : "NO"));
         
         if (!engineExe.existsAsFile())
         {
             File resourcesDir = pluginDir.getParentDirectory().getChildFile("Resources");
             engineExe = resourcesDir.getChildFile("PlaylistedEngine");
-            logLaunchDiag("Trying Resources path: " + engineExe.getFullPathName() + " exists: " + String(engineExe.existsAsFile() ? "YES" : "NO"));
-            LOG_INFO("AudioEngine: Trying Resources path: " + engineExe.getFullPathName());
+            LOG_INFO("Trying Resources path: " + engineExe.getFullPathName() + " exists: " + String(engineExe.existsAsFile() ? "YES" : "NO"));
         }
     #endif
 
@@ -240,7 +543,7 @@ void AudioEngine::launchEngine()
     if (!engineExe.existsAsFile())
     {
         File hostFile = File::getSpecialLocation(File::currentApplicationFile);
-        logLaunchDiag("Primary path failed. Host app: " + hostFile.getFullPathName());
+        LOG_INFO("Primary path failed. Host app: " + hostFile.getFullPathName());
         
         #if JUCE_WINDOWS
             File siblingExe = hostFile.getSiblingFile("PlaylistedEngine.exe");
@@ -248,7 +551,7 @@ void AudioEngine::launchEngine()
             File siblingExe = hostFile.getSiblingFile("PlaylistedEngine");
         #endif
         
-        logLaunchDiag("Trying sibling: " + siblingExe.getFullPathName() + " exists: " + String(siblingExe.existsAsFile() ? "YES" : "NO"));
+        LOG_INFO("Trying sibling: " + siblingExe.getFullPathName() + " exists: " + String(siblingExe.existsAsFile() ? "YES" : "NO"));
         
         if (siblingExe.existsAsFile())
         {
@@ -259,7 +562,6 @@ void AudioEngine::launchEngine()
     if (engineExe.existsAsFile())
     {
         LOG_INFO("AudioEngine: Launching External Process: " + engineExe.getFullPathName());
-        logLaunchDiag("LAUNCHING: " + engineExe.getFullPathName());
         
         #if JUCE_MAC
             engineExe.setExecutePermission(true);
@@ -268,102 +570,122 @@ void AudioEngine::launchEngine()
         // FIX: Store the engine path for terminate fallback on macOS
         engineExePath = engineExe.getFullPathName();
         
+        // Ring geometry travels with the deck request in EngineControl; the arguments are the engine modes
+        String engineArgs;
+        if (IPCConfig::useHeadlessEngine()) engineArgs << " " << IPCConfig::HeadlessFlag;
+        if (IPCConfig::useWarmEngine())     engineArgs << " " << IPCConfig::WarmFlag;
+
         #if JUCE_WINDOWS
-            String launchCmd = "\"" + engineExe.getFullPathName() + "\"";
+            String launchCmd = "\"" + engineExe.getFullPathName() + "\"" + engineArgs;
         #elif JUCE_MAC
-            String launchCmd = "/usr/bin/open -a \"" + engineExe.getFullPathName() + "\"";
+            String launchCmd = "/usr/bin/open -a \"" + engineExe.getFullPathName() + "\""
+                             + (engineArgs.isEmpty() ? String() : " --args" + engineArgs);
         #else
-            String launchCmd = engineExe.getFullPathName();
+            String launchCmd = engineExe.getFullPathName() + engineArgs;
         #endif
         
-        logLaunchDiag("Launch command: " + launchCmd);
+        LOG_INFO("Launch command: " + launchCmd);
         
+        const double spawnStartMs = Time::getMillisecondCounterHiRes();
         bool started = engineProcess.start(launchCmd);
+        spawnMs = Time::getMillisecondCounterHiRes() - spawnStartMs;
         
         if (started)
         {
-            LOG_INFO("AudioEngine: Process started successfully.");
-            logLaunchDiag("Process started SUCCESSFULLY");
-            ipc.initialize();
+            LOG_INFO("AudioEngine: Process started successfully (" + String(spawnMs, 1) + " ms).");
         }
         else
         {
             LOG_ERROR("AudioEngine: Failed to start process!");
-            logLaunchDiag("Process start FAILED");
             
             #if JUCE_MAC
-                logLaunchDiag("Trying direct launch as fallback...");
-                String directCmd = "\"" + engineExe.getFullPathName() + "\"";
+                LOG_WARNING("Trying direct launch as fallback...");
+                String directCmd = "\"" + engineExe.getFullPathName() + "\"" + engineArgs;
                 started = engineProcess.start(directCmd);
+                spawnMs = Time::getMillisecondCounterHiRes() - spawnStartMs;
                 if (started)
                 {
-                    logLaunchDiag("Direct launch SUCCEEDED");
-                    ipc.initialize();
+                    LOG_INFO("Direct launch SUCCEEDED");
                 }
                 else
                 {
-                    logLaunchDiag("Direct launch also FAILED");
+                    LOG_ERROR("Direct launch also FAILED");
                 }
             #endif
         }
+
+        if (!started) spawnMs = -1.0;
+        return started;
     }
     else
     {
         LOG_ERROR("AudioEngine: CRITICAL - Could not find PlaylistedEngine executable at " + pluginDir.getFullPathName());
-        logLaunchDiag("CRITICAL: Engine exe NOT FOUND. pluginDir=" + pluginDir.getFullPathName());
-        logLaunchDiag("--- Search path dump ---");
+        LOG_INFO("--- Search path dump ---");
         #if JUCE_WINDOWS
-            logLaunchDiag("  Expected: " + pluginDir.getChildFile("PlaylistedEngine.exe").getFullPathName());
+            LOG_INFO("  Expected: " + pluginDir.getChildFile("PlaylistedEngine.exe").getFullPathName());
         #else
-            logLaunchDiag("  Expected: " + pluginDir.getChildFile("PlaylistedEngine").getFullPathName());
+            LOG_INFO("  Expected: " + pluginDir.getChildFile("PlaylistedEngine").getFullPathName());
         #endif
-        logLaunchDiag("  Host app: " + File::getSpecialLocation(File::currentApplicationFile).getFullPathName());
-        logLaunchDiag("  Current dir: " + File::getCurrentWorkingDirectory().getFullPathName());
+        LOG_INFO("  Host app: " + File::getSpecialLocation(File::currentApplicationFile).getFullPathName());
+        LOG_INFO("  Current dir: " + File::getCurrentWorkingDirectory().getFullPathName());
     }
+    return false;
 }
 
-void AudioEngine::showVideoWindow()
+void AudioEngine::showVideoWindow(IPCCaller caller)
 {
-    if (!ipc.isConnected())
-    {
-        if (!engineProcess.isRunning()) launchEngine();
-        return;
-    }
-    juce::DynamicObject::Ptr o = new juce::DynamicObject();
-    o->setProperty("type", "show_window");
-    ipc.sendCommand(JSON::toString(var(o.get())));
+    // Still connecting: the link launches the engine if needed and shows the window once connected
+    if (!ipc.isConnected()) return;
+    remotePlayer->showWindow(caller);
 }
 
 void AudioEngine::terminateEngine() 
 {
-    // Step 1: Send quit command for graceful shutdown
+    // Step 1: Close our deck (quit command + registry release)
     if (ipc.isConnected())
+        remotePlayer->quit();
+
+    control.releaseDeck(deckSlot);
+    deckSlot = -1;
+
+    // Other instances still play through this engine - leave it running
+    if (control.getNumClaimedDecks() > 0)
+    {
+        LOG_INFO("Deck released, engine still serves " + String(control.getNumClaimedDecks()) + " other deck(s)");
+        return;
+    }
+
+    // A warm engine stays up for the next instance (it quits after its own idle limit)
+    if (control.isEngineWarm() && control.isEngineAlive())
+    {
+        LOG_INFO("Deck released, warm engine left running");
+        return;
+    }
+
+    // Step 2: The engine quits on its own once its last deck is gone
+    if (ipc.isConnected() || control.isEngineAlive())
     {
-        juce::DynamicObject::Ptr o = new juce::DynamicObject();
-        o->setProperty("type", "quit");
-        ipc.sendCommand(JSON::toString(var(o.get())));
-        
         // FIX: Wait up to 2 seconds for graceful shutdown instead of just 100ms
         for (int i = 0; i < 20; ++i)
         {
             Thread::sleep(100);
-            if (!engineProcess.isRunning())
+            if (!engineProcess.isRunning() && !control.isEngineAlive())
             {
-                logLaunchDiag("Engine quit gracefully after " + String((i + 1) * 100) + "ms");
+                LOG_INFO("Engine quit gracefully after " + String((i + 1) * 100) + "ms");
                 return;
             }
         }
-        logLaunchDiag("Engine did not quit gracefully after 2s, force killing...");
+        LOG_WARNING("Engine did not quit gracefully after 2s, force killing...");
     }
     
-    // Step 2: Force kill via ChildProcess handle
+    // Step 3: Force kill via ChildProcess handle
     if (engineProcess.isRunning())
     {
         engineProcess.kill();
         Thread::sleep(100);
     }
     
-    // Step 3: macOS fallback — if we used /usr/bin/open, the ChildProcess handle
+    // Step 4: macOS fallback — if we used /usr/bin/open, the ChildProcess handle
     // tracks the 'open' command, not the actual engine. Use killall as last resort.
     #if JUCE_MAC
     {
@@ -374,7 +696,7 @@ void AudioEngine::terminateEngine()
             juce::String output = check.readAllProcessOutput();
             if (output.trim().isNotEmpty())
             {
-                logLaunchDiag("Engine still running after kill(), using killall...");
+                LOG_WARNING("Engine still running after kill(), using killall...");
                 juce::ChildProcess killer;
                 killer.start("killall PlaylistedEngine");
                 killer.waitForProcessToFinish(1000);
@@ -387,6 +709,7 @@ void AudioEngine::terminateEngine()
 void AudioEngine::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
     ipcBuffer.setSize(2, samplesPerBlock);
+    driftCompensator.prepare(2, samplesPerBlock, sampleRate, IPCConfig::getDriftTargetFillFrames(samplesPerBlock));
     
     pitchDelayBuffer.setSize(2, 16384);
     pitchDelayBuffer.clear();
@@ -394,15 +717,11 @@ void AudioEngine::prepareToPlay(double sampleRate, int samplesPerBlock)
     pitchReadPos = 0.0f;
     pitchCrossfade = 0.0f;
     
-    // FIX: IPC init only if not already connected (NOT on audio thread path)
-    if (!ipc.isConnected())
-    {
-        ipc.initialize();
-    }
-    
-    // Send DAW sample rate to engine via shared memory
+    // Send DAW sample rate to engine via shared memory (again on every connect, see onEngineConnected)
+    dawSampleRate = sampleRate;
     ipc.setDawSampleRate(static_cast<int>(sampleRate));
-    logLaunchDiag("prepareToPlay: DAW sampleRate=" + String(sampleRate) + " blockSize=" + String(samplesPerBlock));
+    ipc.setAudioTargetFill(driftCompensator.getTargetFillFrames());   // Engine delivers up to this fill
+    LOG_INFO("prepareToPlay: DAW sampleRate=" + String(sampleRate) + " blockSize=" + String(samplesPerBlock));
     
     if (ipc.isConnected())
     {
@@ -434,8 +753,17 @@ void AudioEngine::processPluginBlock(juce::AudioBuffer<float>& buffer, juce::Mid
     
     if (ipc.isConnected())
     {
-        ipcBuffer.clear();
-        ipc.popAudio(ipcBuffer);
+        if (useDriftCompensation)
+        {
+            // Pads priming/underrun with silence itself, no clear needed
+            auto result = driftCompensator.process(ipc, ipcBuffer.getArrayOfWritePointers(), 2, numSamples);
+            if (result.underrun) ipc.countUnderrun();
+        }
+        else
+        {
+            // popAudio pads any underrun with silence, no clear needed
+            ipc.popAudio(ipcBuffer, numSamples);
+        }
         
         for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
         {
@@ -459,24 +787,24 @@ void AudioEngine::handleMidi(juce::MidiBuffer& midiMessages)
             int note = message.getNoteNumber();
             if (note == 15)
             {
-                if (remotePlayer->isPlaying()) remotePlayer->pause();
-                else remotePlayer->play();
+                if (remotePlayer->isPlaying()) remotePlayer->pause(IPCCaller::RealTime);
+                else remotePlayer->play(IPCCaller::RealTime);
             }
             else if (note == 16)
             {
-                stopAllPlayback();
+                stopAllPlayback(IPCCaller::RealTime);
             }
             else if (note == 17)
             {
-                showVideoWindow();
+                showVideoWindow(IPCCaller::RealTime);
             }
         }
     }
 }
 
-void AudioEngine::stopAllPlayback()
+void AudioEngine::stopAllPlayback(IPCCaller caller)
 {
-    if (remotePlayer) remotePlayer->stop();
+    if (remotePlayer) remotePlayer->stop(caller);
 }
 
 void AudioEngine::updateCrossfadeState()
@@ -498,6 +826,8 @@ XmlElement* AudioEngine::getStateXml()
         itemXml->setAttribute("speed", item.playbackSpeed);
         itemXml->setAttribute("delay", item.transitionDelaySec);
         itemXml->setAttribute("xfade", item.isCrossfade);
+        itemXml->setAttribute("xfadeSec", item.crossfadeSec);
+        itemXml->setAttribute("xfadeCurve", item.crossfadeCurve);
         playlistXml->addChildElement(itemXml);
     }
     xml->addChildElement(playlistXml);
@@ -521,16 +851,13 @@ void AudioEngine::setStateXml(const XmlElement* xml)
             item.playbackSpeed = (float)itemXml->getDoubleAttribute("speed", 1.0);
             item.transitionDelaySec = itemXml->getIntAttribute("delay", 0);
             item.isCrossfade = itemXml->getBoolAttribute("xfade", false);
+            item.crossfadeSec = (float)itemXml->getDoubleAttribute("xfadeSec", 4.0);
+            item.crossfadeCurve = itemXml->getIntAttribute("xfadeCurve", 0);
             playlist.push_back(item);
         }
     }
 
+    activeTrackIndex = -1;
     if (!playlist.empty())
-    {
-        auto& first = playlist[0];
-        remotePlayer->loadFile(first.filePath);
-        remotePlayer->setVolume(first.volume);
-        remotePlayer->setRate(first.playbackSpeed);
-        setPitchSemitones(first.pitchSemitones);
-    }
+        selectTrack(0);
 }
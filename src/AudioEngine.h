@@ -6,6 +6,28 @@
 
     FIX: Added cleanupSharedMemory() to remove stale IPC files on shutdown.
     FIX: Added engineExePath for macOS terminate fallback.
+    PERF: RemotePlayerFacade sends binary IPCProtocol messages
+          (JSON only when PLAYLISTED_IPC_JSON=1).
+    FIX: Every send names its caller class (IPCCaller). The audio thread
+         never blocks, heartbeats can't crowd out transport commands.
+    PERF: Heartbeats are a counter in the deck segment, not queued commands.
+    ADDED: Each instance registers its own deck/segment in EngineControl and
+           shares one engine process with the other instances.
+    ADDED: DriftCompensator between the IPC ring and the DAW block - the
+           ring is held at a target fill instead of drifting with the clocks.
+    ADDED: Status comes from one consistent engine snapshot. Position is
+           extrapolated from its timestamp between updates, and
+           hasFinished() only reports the track this instance last loaded.
+    ADDED: preloadNext() for gapless playback; the facade notices when the
+           engine switched to the preloaded track (takeGaplessAdvance).
+    ADDED: preloadNext() can ask for a crossfade (length + curve); the
+           engine mixes both tracks, nothing extra runs on the DAW side.
+    ADDED: Playlist auto-advance lives here instead of PlaylistComponent, so
+           it keeps running with the editor closed. Waits between tracks go
+           to the engine with the preload and are timed on its sample clock.
+    ADDED: Engine startup is a handshake state machine (EngineLink) driven
+           by flags the engine raises in EngineControl, instead of calling
+           ipc.initialize() every 200 ms; every phase is timed and logged.
 
   ==============================================================================
 */
@@ -16,6 +38,9 @@
 #include <juce_audio_basics/juce_audio_basics.h>
 #include <juce_audio_formats/juce_audio_formats.h>
 #include "IPC/SharedMemoryManager.h"
+#include "IPC/EngineControl.h"
+#include "IPC/DriftCompensator.h"
+#include "AppLogger.h"
 #include "UI/PlaylistDataStructures.h"
 
 // ==============================================================================
@@ -24,52 +49,190 @@
 class RemotePlayerFacade
 {
 public:
-    RemotePlayerFacade(SharedMemoryManager& manager) : ipc(manager) {}
+    RemotePlayerFacade(SharedMemoryManager& manager)
+        : ipc(manager), useJson(IPCConfig::useJsonCommands()) {}
 
     void loadFile(const juce::String& path, float vol = 1.0f, float rate = 1.0f)
     {
-        juce::DynamicObject::Ptr o = new juce::DynamicObject();
-        o->setProperty("type", "load");
-        o->setProperty("path", path);
-        o->setProperty("vol", vol);
-        o->setProperty("speed", rate);
-        ipc.sendCommand(juce::JSON::toString(juce::var(o.get())));
+        // The engine tags the new track with this sequence number (snapshot trackId)
+        expectedTrackId = sendPath(IPCProtocol::Opcode::Load, path, vol, rate);
+
+        // A load drops whatever the engine had preloaded
+        preloadedTrackId = 0;
+        advancedToPreloaded = false;
+    }
+
+    // Gapless: the engine opens this track behind the current one and switches to it
+    // at the exact end of the current track, crossfades into it over fadeSeconds, or
+    // starts it waitSeconds after the end. An empty path cancels the preload.
+    void preloadNext(const juce::String& path, float vol = 1.0f, float rate = 1.0f,
+                     float fadeSeconds = 0.0f, IPCProtocol::FadeCurve curve = IPCProtocol::FadeCurve::EqualPower,
+                     float waitSeconds = 0.0f)
+    {
+        // JSON commands carry no sequence to recognise the switch by - keep the regular path
+        if (useJson) return;
+
+        preloadedTrackId = sendPath(IPCProtocol::Opcode::Preload, path, vol, rate, fadeSeconds, curve, waitSeconds);
+        if (path.isEmpty()) preloadedTrackId = 0;
     }
 
-    void play()     { send("play"); }
-    void pause()    { send("pause"); }
-    void stop()     { send("stop"); }
+    // True once after the engine switched to the preloaded track on its own
+    bool takeGaplessAdvance() { return std::exchange(advancedToPreloaded, false); }
+
+    // Transport can be triggered from MIDI on the audio thread - pass IPCCaller::RealTime there
+    void play(IPCCaller caller = IPCCaller::Message)  { send(IPCProtocol::Opcode::Play, caller); }
+    void pause(IPCCaller caller = IPCCaller::Message) { send(IPCProtocol::Opcode::Pause, caller); }
+    void stop(IPCCaller caller = IPCCaller::Message)  { send(IPCProtocol::Opcode::Stop, caller); }
 
-    void setPosition(float pos) { send("seek", "pos", pos); }
-    void setVolume(float v)     { send("volume", "val", v); }
-    void setRate(float r)       { send("rate", "val", r); }
+    void setPosition(float pos) { send(IPCProtocol::Opcode::Seek, "pos", pos); }
+    void setVolume(float v)     { send(IPCProtocol::Opcode::Volume, "val", v); }
+    void setRate(float r)       { send(IPCProtocol::Opcode::Rate, "val", r); }
 
+    void showWindow(IPCCaller caller = IPCCaller::Message) { send(IPCProtocol::Opcode::ShowWindow, caller); }
+    void quit()                 { send(IPCProtocol::Opcode::Quit, IPCCaller::Message); }
+
+    // Message thread: take a fresh snapshot (keeps the previous one if the engine was mid-write)
     void updateStatus()
     {
-        status = ipc.getEngineStatus();
+        EngineStatusSnapshot fresh;
+        if (!ipc.getEngineStatus(fresh)) return;
+
+        // The engine spliced in the preloaded track: from now on that is the one we follow
+        if (preloadedTrackId != 0 && fresh.trackId == preloadedTrackId)
+        {
+            expectedTrackId = preloadedTrackId;
+            preloadedTrackId = 0;
+            advancedToPreloaded = true;
+        }
+
+        status = fresh;
+
+        // The wait between tracks counts as playing: transport toggles pause it
+        const auto state = fresh.getState();
+        playing.store(state == EnginePlayState::Playing || state == EnginePlayState::Waiting, std::memory_order_relaxed);
+    }
+
+    // Also read by the audio thread (MIDI transport)
+    bool isPlaying() const { return playing.load(std::memory_order_relaxed); }
+
+    // Only for the track we loaded last - never a stale "finished" from the previous one
+    bool hasFinished() const
+    {
+        return status.getState() == EnginePlayState::Finished
+            && (expectedTrackId == 0 || status.trackId == expectedTrackId);
+    }
+
+    bool isWindowOpen() const { return status.isWindowOpen(); }
+
+    // Audible time until the engine starts the preloaded track (0 unless it is waiting)
+    double getWaitSecondsRemaining() const
+    {
+        if (status.getState() != EnginePlayState::Waiting || status.sampleRate == 0) return 0.0;
+
+        // Silence still to be rendered plus what already sits in the ring
+        const double elapsed = (double)(IPCProtocol::nowMicros() - status.timestampUs) * 1.0e-6;
+        const double frames = (double)status.waitRemainingSamples + (double)status.bufferedFrames;
+        return juce::jmax(0.0, frames / status.sampleRate - elapsed);
     }
 
-    bool isPlaying()   const { return status.playing; }
-    bool hasFinished()  const { return status.finished; }
-    bool isWindowOpen() const { return status.winOpen; }
-    float getPosition() const { return status.pos; }
-    int64_t getLengthMs() const { return status.len; }
+    // Audible position (decoder position minus what still sits in the ring),
+    // extrapolated from the snapshot timestamp while playing
+    double getPositionSeconds() const
+    {
+        if (status.sampleRate == 0) return 0.0;
+
+        double samples = (double)status.positionSamples - (double)status.bufferedFrames * status.playbackRate;
+
+        if (status.getState() == EnginePlayState::Playing)
+        {
+            const auto elapsedUs = juce::jlimit<int64_t>(0, maxExtrapolationUs,
+                                                         (int64_t)(IPCProtocol::nowMicros() - status.timestampUs));
+            samples += (double)elapsedUs * 1.0e-6 * status.sampleRate * status.playbackRate;
+        }
+
+        if (status.lengthSamples > 0) samples = juce::jmin(samples, (double)status.lengthSamples);
+        return juce::jmax(0.0, samples) / status.sampleRate;
+    }
+
+    // Normalised 0..1
+    float getPosition() const
+    {
+        const auto lengthMs = getLengthMs();
+        return lengthMs > 0 ? (float)juce::jlimit(0.0, 1.0, getPositionSeconds() * 1000.0 / (double)lengthMs) : 0.0f;
+    }
+
+    int64_t getLengthMs() const
+    {
+        return status.sampleRate > 0 ? status.lengthSamples * 1000 / status.sampleRate : 0;
+    }
+
+    const EngineStatusSnapshot& getStatusSnapshot() const { return status; }
 
 private:
+    // Never run further ahead of the engine than this if its updates stop
+    static constexpr int64_t maxExtrapolationUs = 250 * 1000;
+
     SharedMemoryManager& ipc;
-    SharedMemoryManager::EngineStatus status;
+    EngineStatusSnapshot status;
+    std::atomic<bool> playing { false };
+    uint32_t expectedTrackId = 0;   // 0: unknown (JSON commands), accept any track
+    uint32_t preloadedTrackId = 0;  // Sequence of the pending Preload, 0 = none
+    bool advancedToPreloaded = false;
+    const bool useJson;
+
+    // Load / Preload. Returns the message sequence (the engine's trackId), 0 if unknown or not sent.
+    uint32_t sendPath(IPCProtocol::Opcode op, const juce::String& path, float vol, float rate,
+                      float fadeSeconds = 0.0f, IPCProtocol::FadeCurve curve = IPCProtocol::FadeCurve::EqualPower,
+                      float waitSeconds = 0.0f)
+    {
+        if (useJson)
+        {
+            juce::DynamicObject::Ptr o = new juce::DynamicObject();
+            o->setProperty("type", IPCProtocol::getOpcodeName(op));
+            o->setProperty("path", path);
+            o->setProperty("vol", vol);
+            o->setProperty("speed", rate);
+            if (fadeSeconds > 0.0f) {
+                o->setProperty("fade", fadeSeconds);
+                o->setProperty("curve", (int)curve);
+            }
+            if (waitSeconds > 0.0f) o->setProperty("wait", waitSeconds);
+            ipc.sendCommand(juce::JSON::toString(juce::var(o.get())));
+            return 0;
+        }
+
+        char msg[IPCConfig::CommandBufferSize];
+        const auto sequence = ipc.nextSequence();
+        auto size = IPCProtocol::encodeLoad(msg, sizeof(msg), sequence,
+                                            path.toRawUTF8(), path.getNumBytesAsUTF8(), vol, rate, op,
+                                            fadeSeconds, curve, waitSeconds);
+        return (size > 0 && ipc.sendCommand(msg, size)) ? sequence : 0;
+    }
 
-    void send(const juce::String& type) {
-        juce::DynamicObject::Ptr o = new juce::DynamicObject();
-        o->setProperty("type", type);
-        ipc.sendCommand(juce::JSON::toString(juce::var(o.get())));
+    // Binary messages are encoded on the stack - no allocation, safe from the audio thread
+    void send(IPCProtocol::Opcode op, IPCCaller caller) {
+        if (useJson) {
+            juce::DynamicObject::Ptr o = new juce::DynamicObject();
+            o->setProperty("type", IPCProtocol::getOpcodeName(op));
+            ipc.sendCommand(juce::JSON::toString(juce::var(o.get())), caller);
+            return;
+        }
+        char msg[sizeof(IPCProtocol::MessageHeader)];
+        auto size = IPCProtocol::encode(msg, sizeof(msg), op, ipc.nextSequence());
+        if (size > 0) ipc.sendCommand(msg, size, caller);
     }
     
-    void send(const juce::String& type, const juce::String& key, float val) {
-        juce::DynamicObject::Ptr o = new juce::DynamicObject();
-        o->setProperty("type", type);
-        o->setProperty(key, val);
-        ipc.sendCommand(juce::JSON::toString(juce::var(o.get())));
+    void send(IPCProtocol::Opcode op, const char* key, float val) {
+        if (useJson) {
+            juce::DynamicObject::Ptr o = new juce::DynamicObject();
+            o->setProperty("type", IPCProtocol::getOpcodeName(op));
+            o->setProperty(key, val);
+            ipc.sendCommand(juce::JSON::toString(juce::var(o.get())));
+            return;
+        }
+        char msg[sizeof(IPCProtocol::MessageHeader) + sizeof(IPCProtocol::FloatPayload)];
+        auto size = IPCProtocol::encodeFloat(msg, sizeof(msg), op, ipc.nextSequence(), val);
+        if (size > 0) ipc.sendCommand(msg, size);
     }
 };
 
@@ -81,32 +244,67 @@ public:
     void prepareToPlay(double sampleRate, int samplesPerBlockExpected);
     void releaseResources();
     void processPluginBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages);
-    void stopAllPlayback();
+    void stopAllPlayback(IPCCaller caller = IPCCaller::Message);
     
     RemotePlayerFacade& getMediaPlayer() { return *remotePlayer; }
     std::vector<PlaylistItem>& getPlaylist() { return playlist; }
     juce::AudioFormatManager& getFormatManager() { return formatManager; }
     
     void updateCrossfadeState();
-    void showVideoWindow();
+    void showVideoWindow(IPCCaller caller = IPCCaller::Message);
 
     // Pitch Control (Master)
     void setPitchSemitones(int semitones);
 
+    // Clock drift compensation (safe from any thread)
+    double getDriftRatio() const       { return driftCompensator.getRatio(); }
+    float getDriftFillError() const    { return driftCompensator.getFillErrorFrames(); }
+
     // Persistent Track Index Accessors
     int getActiveTrackIndex() const { return activeTrackIndex; }
-    void setActiveTrackIndex(int i) { activeTrackIndex = i; }
+    void setActiveTrackIndex(int i) { activeTrackIndex = i; if (i < 0) waitingForTransition = false; }
+
+    // Playlist transport (message thread). Auto-advance runs on this object's timer,
+    // so it keeps going while the editor is closed.
+    void selectTrack(int index);
+    void playTrack(int index);
+    void setAutoPlayEnabled(bool shouldAutoPlay) { autoPlayEnabled = shouldAutoPlay; }
+    bool isAutoPlayEnabled() const { return autoPlayEnabled; }
+    int getWaitSecondsRemaining() const;   // Countdown to the next track, 0 if not waiting
+
+    // Connection to the engine, advanced by the timer. Each step waits for a flag the
+    // engine raises in EngineControl - nothing is retried blindly.
+    enum class EngineLink
+    {
+        Registering,        // Control segment + deck slot; launch the engine if none is alive
+        WaitingForEngine,   // Engine starting up (not ready yet)
+        WaitingForDeck,     // Engine ready, our deck not open (Active) yet
+        Connected,          // Deck segment mapped
+        Failed              // Timed out, starts over after linkRetryMs
+    };
+    EngineLink getEngineLinkState() const { return linkState; }
     
     juce::XmlElement* getStateXml();
     void setStateXml(const juce::XmlElement* xml);
     
 private:
-    void launchEngine();
+    bool launchEngine();
+    void beginEngineLink();
+    void updateEngineLink();
+    void setEngineLinkState(EngineLink newState);
+    void failEngineLink(const juce::String& reason);
+    void onEngineConnected();
     void terminateEngine();
     void cleanupSharedMemory();
+    void registerDeck();
     void handleMidi(juce::MidiBuffer& midiMessages);
     void timerCallback() override;
     void sendHeartbeat();
+    void updateAutoAdvance();
+    void updateNextTrackPreload();
+
+    // Keeps the log writer running; first member, so it outlives everything that logs
+    AppLogger::Session logSession;
 
     // --- Pitch Shifter DSP ---
     void processPitchShift(juce::AudioBuffer<float>& buffer);
@@ -120,15 +318,54 @@ private:
 
     juce::AudioFormatManager formatManager;
     juce::AudioBuffer<float> ipcBuffer;
+    DriftCompensator driftCompensator;
+    const bool useDriftCompensation = IPCConfig::useDriftCompensation();
+    int driftLogCounter = 0;
+    EngineControl control { EngineControl::Mode::Plugin_Client };   // Before ipc: ipc uses its doorbell
     SharedMemoryManager ipc { SharedMemoryManager::Mode::Plugin_Client };
+    int deckSlot = -1;
     std::unique_ptr<RemotePlayerFacade> remotePlayer;
     juce::ChildProcess engineProcess;
     juce::String engineExePath;  // FIX: Store path for macOS terminate fallback
     
     std::vector<PlaylistItem> playlist;
-    int startupRetries = 0;
+
+    // Engine link (message thread)
+    static constexpr int linkPollMs = 20;                  // Only atomics are polled while connecting
+    static constexpr juce::uint32 engineReadyTimeoutMs = 15000;
+    static constexpr juce::uint32 deckActiveTimeoutMs = 10000;
+    static constexpr juce::uint32 linkRetryMs = 5000;
+    static constexpr int maxLaunchAttempts = 3;            // Per link attempt chain, reset by beginEngineLink
+    EngineLink linkState = EngineLink::Registering;
+    juce::uint32 linkStateSinceMs = 0;
+    int launchAttempts = 0;
+    bool windowShownOnce = false;
+    double dawSampleRate = 0.0;   // Written to the deck segment on every (re)connect
+
+    // Startup timing of the current attempt (hi-res ms), logged once connected
+    double linkBeginMs = 0.0, engineReadyAtMs = 0.0, deckActiveAtMs = 0.0;
+    double spawnMs = -1.0;        // Time spent starting the process, -1 = attached to a running engine
+
+    // Engine liveness: its heartbeat counter, timed on our clock
+    uint32_t lastEngineBeat = 0;
+    juce::uint32 lastEngineBeatMs = 0;
+    bool engineStallLogged = false;
 
     // Store the active track index here so it survives UI close/open
     int activeTrackIndex = -1;
+    bool autoPlayEnabled = true;
+
+    // Next track armed in the engine (-1 = none) and the transition it was armed with
+    int preloadedIndex = -1;
+    PlaylistItem preloadedItem;
+    float preloadedFadeSec = 0.0f, preloadedWaitSec = 0.0f;
+    int preloadedFadeCurve = 0;
+
+    // Fallback for a next track the engine did not take: finish -> wait -> play
+    static constexpr int finishDebounceTicks = 5;   // ~200 ms at the 40 ms tick
+    int finishTicks = 0;
+    bool waitingForTransition = false;
+    juce::uint32 transitionDueMs = 0;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AudioEngine)
 };
@@ -4,14 +4,90 @@
     EngineMain.cpp
     Playlisted2 Engine (Standalone Process)
     
-    SINGLE DECK ARCHITECTURE - CROSS PLATFORM (Win/Mac)
+    MULTI DECK ARCHITECTURE - CROSS PLATFORM (Win/Mac/Linux)
+    One engine process serves every plugin instance: each instance registers
+    a deck in EngineControl and gets its own segment, player and window.
     - Windows: Uses VLCMediaPlayer_Desktop (Direct HWND Rendering)
     - macOS: Uses NativeMediaPlayer_Apple (AVFoundation Image Extraction)
+    - Linux: Uses JuceMediaPlayer_Linux (JUCE format readers, audio only)
     
     ADDED: Heartbeat watchdog - auto-quit if plugin stops responding
     FIX: Engine reads DAW sample rate from IPC and reconfigures VLC accordingly.
     FIX: Faster audio pump loop (1ms instead of 2ms) to reduce underruns.
+    PERF: Pump is event-driven - sleeps on the IPC doorbell until the plugin
+          consumes audio / posts a command, or a deadline passes. Only a
+          playing deck is woken by the plugin's reads.
+    PERF: Commands arrive as binary IPCProtocol messages, decoded without
+          allocation; JSON is still accepted as a debug fallback.
+    ADDED: Pump stats include commands dropped per caller class (MPSC queue).
+    PERF: IPC segments live in RAM (shm_open / named mapping); orphans from
+          crashed runs are swept at startup.
+    ADDED: Multi-deck engine. Decks come and go with plugin instances, one
+           pump thread serves all of them; the engine quits once the last
+           deck is gone.
     FIX: OpenGL-accelerated video rendering on macOS for smooth playback.
+    ADDED: Status is published as one seqlock snapshot per deck: track id
+           (load sequence), sample position/length, state, ring fill and
+           timestamp, so the plugin can extrapolate between updates.
+    ADDED: Headless mode (--headless / PLAYLISTED_HEADLESS=1, always on Linux):
+           no video windows and no video decoding, only the pump and decoder
+           threads run. Otherwise video is only decoded - and the window only
+           raised - for tracks that are video files.
+    ADDED: Gapless playback. Each deck keeps a second player: a Preload
+           command opens the next track there, it pre-rolls shortly before
+           the current one ends and takes over at the exact sample the
+           current track runs out (block-accurate on macOS).
+    ADDED: Crossfades. A Preload may carry a fade length and curve (equal
+           power, linear, S-curve); the incoming track is opened a few seconds
+           ahead and both are mixed in the pump, so the DAW side does nothing extra.
+    ADDED: Waits between tracks are scheduled here too: a Preload's gap is
+           counted in output frames (silence into the ring) and the next track
+           starts on the exact frame it runs out, GUI open or not. A Pause
+           holds the wait where it is; Play resumes it.
+    PERF: Liveness through the deck segment's heartbeat counters. The
+          watchdog times the plugin's counter on the wall clock; no
+          heartbeat commands are queued or parsed any more.
+    PERF: logToDesktop replaced by the shared asynchronous AppLogger - the
+          pump only copies into a lock-free ring, the file is written on the
+          logger's thread (AppData/Playlisted/Logs/Playlisted_Engine_Log.txt).
+    ADDED: Readiness handshake - engineReady is raised once initialisation is
+           done, a deck slot turns Active only after its deck is fully open,
+           and both timings are published in EngineControl and logged.
+    ADDED: Warm engine (--warm): pre-spawned or kept alive without decks,
+           with a spare deck whose players (media backend) are already
+           initialised; the next deck request takes it instead of building one.
+    PERF: Real-time profile for the pump thread (RealtimeProfile: SCHED_FIFO/RR,
+          Mach time constraint or MMCSS, optional CPU affinity and memory
+          locking), prefaulted stack, segments and scratch buffers. Wake-up
+          lateness / missed deadlines and pump work time go in the pump stats.
+    PERF: Decode and delivery are separate stages. Decoding fills a per-deck
+          PCM queue up to a prebuffer (PLAYLISTED_ENGINE_PREBUFFER_MS, default
+          100); delivery tops the IPC ring up to the fill the plugin reads at,
+          in whatever chunk sizes fit. Decoder bursts land in the queue, not in
+          the ring, so the ring (and the latency it adds) stays at its target.
+    ADDED: Seek pipeline. Seeks while playing are coalesced (latest target
+           wins, at most one in flight per seekReissueMs); the audio already
+           queued keeps playing until the player has pre-rolled at the target,
+           then the old audio fades out and the new fades in. Seek-to-audio
+           latency goes in the pump stats.
+    ADDED: Pump stats include the decoder FIFO's dropped frames (VLC, now
+           lock-free between its callback and the pump) and late blocks: the
+           times the decode stage ran dry short of its prebuffer while the
+           track was playing (all backends).
+    ADDED: The deck tells the player how much audio is queued behind it, for
+           the measured A/V sync; skew and correction go in the pump stats.
+    ADDED: Pitch-preserving speed changes. Audio-only tracks on Linux and
+           macOS decode at 1x and go through a WSOLA time-stretcher
+           (TimeStretcher) in SingleDeckPlayer: the rate changes at the next
+           hop, with no flush, and no longer moves the pitch. Video tracks and
+           VLC keep changing speed in the player.
+    PERF: Preloaded tracks are opened on a per-deck loader thread
+          (NextTrackLoader); the pump only takes over a player that is
+          already armed, so a slow file open no longer stalls it.
+    PERF: Track changes (crossfade or wait start, switch), DAW rate changes and
+          the watchdog are posted by the pump as fixed-size events, and the
+          pump stats as plain numbers; both are logged from the message
+          thread, so the pump does not build log strings.
 
   ==============================================================================
 */
@@ -22,7 +98,11 @@
 #include <juce_gui_basics/juce_gui_basics.h>
 #include <juce_opengl/juce_opengl.h>
 #include "IPC/SharedMemoryManager.h"
-#include <fstream>
+#include "IPC/EngineControl.h"
+#include "AppLogger.h"
+#include "engine/RealtimeProfile.h"
+#include "engine/TimeStretcher.h"
+#include <array>
 
 // --- PLATFORM INCLUDES ---
 #if JUCE_WINDOWS
@@ -31,19 +111,18 @@
 #elif JUCE_MAC
     #include "engine/NativeMediaPlayer_Apple.h"
     using PlatformPlayer = NativeMediaPlayer_Apple;
+#elif JUCE_LINUX
+    #include "engine/JuceMediaPlayer_Linux.h"
+    using PlatformPlayer = JuceMediaPlayer_Linux;
 #endif
 
-void logToDesktop(const juce::String& text)
+// Startup timing: taken during static initialisation, before JUCE starts the app
+static const double processStartMs = juce::Time::getMillisecondCounterHiRes();
+
+// Decks only open / decode video for files that have it; everything else plays audio only
+static bool isVideoFile(const juce::String& path)
 {
-    auto desktop = juce::File::getSpecialLocation(juce::File::userDesktopDirectory);
-    auto logFile = desktop.getChildFile("OnStage_EngineLog.txt");
-    
-    std::ofstream stream(logFile.getFullPathName().toStdString(), std::ios::app);
-    if (stream.is_open())
-    {
-        auto time = juce::Time::getCurrentTime().toString(true, true, true, true);
-        stream << "[" << time.toStdString() << "] " << text.toStdString() << std::endl;
-    }
+    return juce::File(path).hasFileExtension("mp4;mov;m4v;avi;mkv;webm;wmv;mpg;mpeg;flv");
 }
 
 // ==============================================================================
@@ -67,7 +146,7 @@ public:
         glContext.setComponentPaintingEnabled(false); // We handle all rendering in GL
         glContext.attachTo(*this);
         
-        logToDesktop("VideoComponent: OpenGL context attached");
+        LOG_INFO("VideoComponent: OpenGL context attached");
     }
     
     ~VideoComponent() override
@@ -107,7 +186,7 @@ public:
     
     void newOpenGLContextCreated() override
     {
-        logToDesktop("VideoComponent: OpenGL context created");
+        LOG_INFO("VideoComponent: OpenGL context created");
         textureID = 0;
         textureWidth = 0;
         textureHeight = 0;
@@ -115,7 +194,7 @@ public:
     
     void openGLContextClosing() override
     {
-        logToDesktop("VideoComponent: OpenGL context closing");
+        LOG_INFO("VideoComponent: OpenGL context closing");
         if (textureID != 0)
         {
             juce::gl::glDeleteTextures(1, &textureID);
@@ -242,7 +321,7 @@ private:
             textureWidth = w;
             textureHeight = h;
             
-            logToDesktop("VideoComponent: Created GL texture " + juce::String(w) + "x" + juce::String(h));
+            LOG_INFO("VideoComponent: Created GL texture " + juce::String(w) + "x" + juce::String(h));
         }
         else
         {
@@ -292,8 +371,8 @@ public:
 class VideoWindow : public juce::DocumentWindow
 {
 public:
-    VideoWindow() 
-        : DocumentWindow("Playlisted2 Video Output", juce::Colours::black, DocumentWindow::allButtons)
+    explicit VideoWindow(const juce::String& title = "Playlisted2 Video Output")
+        : DocumentWindow(title, juce::Colours::black, DocumentWindow::allButtons)
     {
         setUsingNativeTitleBar(true);
         videoComp = new VideoComponent();
@@ -305,7 +384,7 @@ public:
         setVisible(true);
         toFront(true);
         
-        logToDesktop("VideoWindow created and set visible");
+        LOG_INFO("VideoWindow created and set visible");
     }
     
     void* getNativeHandle()
@@ -321,7 +400,7 @@ public:
         if (videoComp) 
         {
             videoComp->setPlayer(player);
-            logToDesktop("VideoWindow: Player bound to VideoComponent (OpenGL)");
+            LOG_INFO("VideoWindow: Player bound to VideoComponent (OpenGL)");
         }
         #else
         juce::ignoreUnused(player);
@@ -366,14 +445,26 @@ public:
     {
         if (newRate == currentSampleRate || newRate < 8000) return;
         
-        currentSampleRate = newRate;
-        logToDesktop("SingleDeckPlayer: Reconfiguring to DAW sample rate: " + juce::String(newRate));
+        currentSampleRate = newRate;   // Logged by the deck (also called on the pump: no string here)
         player.prepareToPlay(512, (double)newRate);
+        stretcher.prepare((double)newRate);
     }
     
     int getCurrentSampleRate() const { return currentSampleRate; }
 
-    void load(const juce::String& path, float vol, float rate)
+    // Takes effect on the next load
+    void setVideoEnabled(bool enabled)
+    {
+        withVideo = enabled;
+
+        #if JUCE_WINDOWS || JUCE_LINUX
+            player.setVideoEnabled(enabled);
+        #else
+            juce::ignoreUnused(enabled);   // AVFoundation only extracts frames the window asks for
+        #endif
+    }
+
+    bool load(const juce::String& path, float vol, float rate)
     {
         player.stop();
         
@@ -382,244 +473,1709 @@ public:
             player.setWindowHandle(window->getNativeHandle());
         #endif
 
-        logToDesktop("SingleDeckPlayer: Loading file: " + path);
+        LOG_INFO("SingleDeckPlayer: Loading file: " + path);
         
+        stretcher.reset();
         bool loaded = player.loadFile(path);
         if (loaded)
         {
+            // Audio-only tracks from an on-demand decoder play at 1x through the stretcher; video
+            // tracks (the picture has to follow) and VLC (paced at 1x) change speed in the player
+            stretchInEngine = !withVideo && !isRealtimePaced();
+            stretcher.setRate(rate);
             player.setVolume(vol);
-            player.setRate(rate);
-            logToDesktop("SingleDeckPlayer: File loaded successfully");
+            player.setRate(stretchInEngine ? 1.0f : rate);
+            LOG_INFO("SingleDeckPlayer: File loaded successfully");
         }
         else
         {
-            logToDesktop("SingleDeckPlayer: FAILED to load file!");
+            LOG_ERROR("SingleDeckPlayer: FAILED to load file!");
         }
+        return loaded;
     }
 
     void play() { player.play(); }
     void pause() { player.pause(); }
-    void stop() { player.stop(); }
+    void stop() { player.stop(); stretcher.reset(); }
 
     void getNextAudioBlock(const juce::AudioSourceChannelInfo& info)
     {
-        player.getNextAudioBlock(info);
+        if (!stretchInEngine) { player.getNextAudioBlock(info); return; }
+
+        // Hops until the block is there; the player is asked for what it has, never more
+        while (stretcher.getNumOutputReady() < info.numSamples)
+        {
+            if (stretcher.processHop(false)) continue;
+
+            const int n = juce::jmin(juce::jmax(stretcher.getInputNeeded(), stretchChunkFrames), stretcher.getInputRoom(),
+                                     stretchInput.getNumSamples(), getSourceFramesAvailable());
+            if (n > 0)
+            {
+                stretchInput.clear(0, n);
+                juce::AudioSourceChannelInfo source { &stretchInput, 0, n };
+                player.getNextAudioBlock(source);
+                stretcher.pushInput(stretchInput.getReadPointer(0), stretchInput.getReadPointer(1), n);
+                continue;
+            }
+
+            // Source dry: at the end of the track its last frames come out, otherwise the block is short
+            if (!isAtEndOfStream() || !stretcher.processHop(true)) break;
+        }
+
+        const int got = stretcher.readOutput(info.buffer->getWritePointer(0, info.startSample),
+                                             info.buffer->getWritePointer(1, info.startSample), info.numSamples);
+        if (got < info.numSamples)
+            info.buffer->clear(info.startSample + got, info.numSamples - got);
     }
 
     bool isPlaying() { return player.isPlaying(); }
     bool hasFinished() { return player.hasFinished(); }
     float getPosition() { return player.getPosition(); }
+    double getPositionSeconds() { return player.getPositionSeconds(); }
     int64_t getLengthMs() { return player.getLengthMs(); }
     
     void setVolume(float v) { player.setVolume(v); }
-    void setRate(float r) { player.setRate(r); }
-    void setPosition(float p) { player.setPosition(p); }
-    
+    void setPosition(float p) { player.setPosition(p); stretcher.reset(); }
+
+    // Smooth either way: the stretcher picks the new rate up at its next hop, nothing is flushed
+    void setRate(float r)
+    {
+        if (stretchInEngine) stretcher.setRate(r);
+        else                 player.setRate(r);
+    }
+
+    // In output frames, at the current speed
     int getNumAudioSamplesAvailable() 
     { 
+        const int source = getSourceFramesAvailable();
+        return stretchInEngine ? stretcher.getOutputFramesFor(source, isAtEndOfStream()) : source;
+    }
+
+    // Decoder FIFO counter (VLC only): frames dropped because it was full
+    uint32_t getDecoderDroppedFrames()
+    {
         #if JUCE_WINDOWS
-            return player.getNumAudioSamplesAvailable(); 
+            return player.getDroppedFrames();
+        #else
+            return 0;
+        #endif
+    }
+
+    // A/V sync (VLC only): frames queued after the player, and the measured skew / correction in ms
+    void setOutputLatencyFrames(int frames)
+    {
+        #if JUCE_WINDOWS
+            player.setOutputLatencyFrames(frames);
+        #else
+            juce::ignoreUnused(frames);
+        #endif
+    }
+
+    // Message thread: the libVLC half of the last A/V correction (VLC only)
+    void applyPendingAudioDelay()
+    {
+        #if JUCE_WINDOWS
+            player.applyPendingAudioDelay();
+        #endif
+    }
+
+    bool getAvSyncStats(double& skewMs, double& correctionMs)
+    {
+        #if JUCE_WINDOWS
+            skewMs = player.getAvSkewMs();
+            correctionMs = player.getAvCorrectionMs();
+            return true;
+        #else
+            juce::ignoreUnused(skewMs, correctionMs);
+            return false;
+        #endif
+    }
+
+    // Audio arrives at the playback clock (VLC's amem callbacks) rather than on demand:
+    // that clock may drift from the DAW's, so a growing backlog has to reach the plugin
+    bool isRealtimePaced() const
+    {
+        #if JUCE_WINDOWS
+            return true;
+        #else
+            return false;   // Read-ahead (Linux) and pull (macOS) sources decode whenever asked
+        #endif
+    }
+
+    // Decoded to the end: getNumAudioSamplesAvailable() is the tail of the track
+    bool isAtEndOfStream()
+    {
+        #if JUCE_LINUX
+            return player.isAtEndOfStream();
         #else
-            return 4096; 
+            return player.hasFinished();
         #endif
     }
 
 private:
+    int getSourceFramesAvailable()
+    {
+        #if JUCE_WINDOWS || JUCE_LINUX
+            return player.getNumAudioSamplesAvailable(); 
+        #else
+            // Pull-based transport: always a block ready until the stream ends (block-accurate splice)
+            return player.hasFinished() ? 0 : 4096; 
+        #endif
+    }
+
+    static constexpr int stretchChunkFrames = 512;   // Smallest pull from the player
+
     PlatformPlayer player;
     VideoWindow* window = nullptr;
     int currentSampleRate = 44100;
+    bool withVideo = false;
+
+    // Pitch-preserving speed (TimeStretcher): storage for up to 192 kHz and 4096-frame pulls
+    TimeStretcher stretcher { 192000.0, 4096 };
+    juce::AudioBuffer<float> stretchInput { 2, 4096 };
+    bool stretchInEngine = false;
 };
 
 // ==============================================================================
-// APPLICATION MAIN
+// DECK PCM QUEUE
+// Decoded stereo audio waiting for the IPC ring: the decode stage writes whole
+// blocks, the delivery stage takes whatever the ring should get. Pump thread
+// only. Storage is sized once at open() for the highest rate; the deck limits
+// how much of it is used (the prebuffer) at the current one.
 // ==============================================================================
-class PlaylistedEngineApplication : public juce::JUCEApplication, public juce::Thread
+class DeckPcmQueue
 {
 public:
-    PlaylistedEngineApplication() : Thread("AudioPumpThread") {}
+    // Message thread, before the pump sees the deck
+    void allocate(int capacityFrames)
+    {
+        buffer.setSize(2, capacityFrames);
+        buffer.clear();
+        reset();
+    }
 
-    const juce::String getApplicationName() override       { return "PlaylistedEngine"; }
-    const juce::String getApplicationVersion() override    { return "2.0.0"; }
-    bool moreThanOneInstanceAllowed() override             { return false; }
-    
-    void anotherInstanceStarted(const juce::String&) override
+    int getCapacity() const  { return buffer.getNumSamples(); }
+    int getNumReady() const  { return numReady; }
+
+    void reset() { readPos = numReady = 0; }
+
+    // Caller checked the room
+    void write(const juce::AudioBuffer<float>& source, int numFrames)
     {
-        logToDesktop("Another instance attempted to start - showing existing window");
-        if (videoWin)
+        const int writePos = (readPos + numReady) % getCapacity();
+        const int first = juce::jmin(numFrames, getCapacity() - writePos);
+        for (int ch = 0; ch < 2; ++ch)
         {
-            videoWin->setVisible(true);
-            if (videoWin->isMinimised()) videoWin->setMinimised(false);
-            videoWin->toFront(true);
+            buffer.copyFrom(ch, writePos, source, ch, 0, first);
+            if (numFrames > first) buffer.copyFrom(ch, 0, source, ch, first, numFrames - first);
         }
+        numReady += numFrames;
     }
 
-    void initialise(const juce::String&) override
+    // Up to maxFrames into the ring, one push per contiguous run. Returns frames delivered.
+    int deliverTo(SharedMemoryManager& ipc, int maxFrames)
     {
-        logToDesktop("=== Engine Process Started (Single Deck Mode) ===");
-        
-        if (!ipc.initialize()) 
-        { 
-            logToDesktop("FATAL: IPC initialization failed!");
-            quit(); 
-            return;
+        const int numFrames = juce::jmin(maxFrames, numReady);
+        if (numFrames <= 0) return 0;
+
+        auto push = [&](int start, int size)
+        {
+            const float* channels[2] = { buffer.getReadPointer(0, start), buffer.getReadPointer(1, start) };
+            return ipc.pushAudio(channels, 2, size);
+        };
+
+        const int first = juce::jmin(numFrames, getCapacity() - readPos);
+        int delivered = push(readPos, first);
+        if (delivered == first && numFrames > first) delivered += push(0, numFrames - first);
+
+        readPos = (readPos + delivered) % getCapacity();
+        numReady -= delivered;
+        return delivered;
+    }
+
+    // Seek splice: the oldest fadeFrames still queued ramp down to silence, everything after them goes
+    void fadeOutAndTruncate(int fadeFrames)
+    {
+        numReady = juce::jmin(numReady, fadeFrames);
+        if (numReady == 0) return;
+
+        const int first = juce::jmin(numReady, getCapacity() - readPos);
+        const float split = 1.0f - (float)first / (float)numReady;
+        for (int ch = 0; ch < 2; ++ch)
+        {
+            buffer.applyGainRamp(ch, readPos, first, 1.0f, split);
+            if (numReady > first) buffer.applyGainRamp(ch, 0, numReady - first, split, 0.0f);
         }
-        
-        logToDesktop("IPC initialized successfully");
+    }
+
+private:
+    juce::AudioBuffer<float> buffer;
+    int readPos = 0, numReady = 0;
+};
+
+// ==============================================================================
+// NEXT TRACK LOADER
+// Opens a deck's preloaded track on a background thread: load() blocks on the
+// file and the media backend for tens to hundreds of ms, which the pump cannot
+// afford. The pump hands the idle next player over with request() and leaves
+// it alone until getState() says Armed or Failed, then takes it back with
+// release(). An open that is cancelled while running is stopped here.
+// ==============================================================================
+class NextTrackLoader : private juce::Thread
+{
+public:
+    enum class State { Idle, Loading, Cancelling, Armed, Failed };
+
+    NextTrackLoader() : juce::Thread("Playlisted Preload") {}
+    ~NextTrackLoader() override { stopThread(4000); }
+
+    // Message thread, when the deck opens
+    void start() { if (!isThreadRunning()) startThread(juce::Thread::Priority::low); }
+
+    // Pump thread
+    State getState() const { return state.load(std::memory_order_acquire); }
+
+    // The player is the loader's until the open has finished
+    bool isBusy() const
+    {
+        const auto s = getState();
+        return s == State::Loading || s == State::Cancelling;
+    }
+
+    // Pump thread, Idle only
+    void request(SingleDeckPlayer& next, const juce::String& path, float volume, float rate, int sampleRate)
+    {
+        target = &next;
+        targetPath = path;
+        targetVolume = volume;
+        targetRate = rate;
+        targetSampleRate = sampleRate;
+        state.store(State::Loading, std::memory_order_release);
+        notify();
+    }
+
+    // Armed / Failed -> Idle: the player is the pump's again
+    void release() { state.store(State::Idle, std::memory_order_release); }
+
+    // Pump thread: drops the request. True if a loaded player came back (the caller stops it);
+    // an open still running is stopped by the loader once it returns.
+    bool cancel()
+    {
+        auto expected = State::Loading;
+        if (state.compare_exchange_strong(expected, State::Cancelling, std::memory_order_acq_rel)) return false;
+        if (expected != State::Armed && expected != State::Failed) return false;
+
+        release();
+        return expected == State::Armed;
+    }
+
+private:
+    void run() override
+    {
+        while (!threadShouldExit())
+        {
+            wait(-1);
+
+            const auto current = getState();
+            if (current == State::Cancelling) release();   // Cancelled before the open started
+            if (current != State::Loading) continue;
+
+            target->reconfigureSampleRate(targetSampleRate);
+            target->setVideoEnabled(false);   // Preloads are audio only
+            const bool loaded = target->load(targetPath, targetVolume, targetRate);
+
+            auto expected = State::Loading;
+            if (state.compare_exchange_strong(expected, loaded ? State::Armed : State::Failed, std::memory_order_acq_rel))
+                continue;
+
+            // Cancelled while opening
+            if (loaded) target->stop();
+            release();
+        }
+    }
+
+    std::atomic<State> state { State::Idle };
+
+    // Written by the pump while Idle, read here while Loading
+    SingleDeckPlayer* target = nullptr;
+    juce::String targetPath;
+    float targetVolume = 1.0f, targetRate = 1.0f;
+    int targetSampleRate = 44100;
+
+    JUCE_DECLARE_NON_COPYABLE(NextTrackLoader)
+};
+
+// ==============================================================================
+// ENGINE DECK
+// One plugin instance: its own IPC segment, two players (current and
+// preloaded next track) and a video window (none in headless mode).
+// Created and destroyed on the message thread, pumped by the audio pump thread.
+// Constructing one initialises the players (the slow part of opening a deck),
+// so a warm engine builds one ahead of time and open()s it on request.
+// ==============================================================================
+class EngineDeck
+{
+public:
+    static constexpr int blockSize = 512;
+    static constexpr int idleTimeoutMs = 20;            // Nothing playing: status/commands only
+    static constexpr int maxPlayingTimeoutMs = 10;      // Playing: poll the decoder at least this often
+    static constexpr int deferredLoadPollMs = 2;        // A Load waiting for the loader: check it this often
+
+    EngineDeck(IPCDoorbell& engineDoorbell, bool headlessMode)
+        : headless(headlessMode), ipc(SharedMemoryManager::Mode::Engine_Server)
+    {
+        ipc.setDoorbell(&engineDoorbell);
+    }
+
+    // Message thread: create the deck's segment and bind the players to it
+    bool open(int slotIndex, const juce::String& segmentName, const IPCConfig::AudioFormat& format)
+    {
+        slot = slotIndex;
+        ipc.setSegmentName(segmentName);
+        ipc.setRequestedAudioFormat(format);
+        if (!ipc.initialize()) return false;
+
+        ipc.setAudioWakeThreshold(wakeThresholdFrames);
+
+        // Room for the configured prebuffer at the highest DAW rate, in whole blocks
+        prebufferMs = IPCConfig::getEnginePrebufferMs();
+        pcmQueue.allocate((prebufferMs * (maxSampleRate / 1000) / blockSize + 1) * blockSize);
 
         // FIX: Read DAW sample rate early and apply it
-        int dawRate = ipc.getDawSampleRate();
-        logToDesktop("DAW sample rate from IPC: " + juce::String(dawRate));
+        const int dawRate = ipc.getDawSampleRate();
+        LOG_INFO("Deck " + juce::String(slot) + ": " + ipc.getSegmentName() + " (ring "
+                 + juce::String(ipc.getRingCapacityFrames()) + " frames x " + juce::String(ipc.getNumChannels())
+                 + " ch), DAW sample rate " + juce::String(dawRate) + ", prebuffer " + juce::String(prebufferMs) + " ms");
+
+        if (!headless)
+        {
+            juce::String title = "Playlisted2 Video Output";
+            if (slot > 0) title << " (" << juce::String(slot + 1) << ")";
+            videoWin = std::make_unique<VideoWindow>(title);
+            videoWin->toFront(true);
+        }
 
-        // Create video window on message thread
-        videoWin = std::make_unique<VideoWindow>();
-        videoWin->toFront(true);
-        
-        logToDesktop("VideoWindow created, binding player...");
-        
         // FIX: Configure player with DAW sample rate before binding
-        player.reconfigureSampleRate(dawRate);
-        player.setVideoWindow(videoWin.get());
+        primaryPlayer.reconfigureSampleRate(dawRate);
+        primaryPlayer.setVideoEnabled(!headless);
+        primaryPlayer.setVideoWindow(videoWin.get());
+        secondaryPlayer.reconfigureSampleRate(dawRate);
+        secondaryPlayer.setVideoEnabled(false);   // Preloads are audio only
+        lastKnownRate = primaryPlayer.getCurrentSampleRate();
+        updatePipelineTargets();
+        nextLoader.start();
 
-        logToDesktop("Starting audio pump thread...");
-        startThread(juce::Thread::Priority::highest);
-        
-        logToDesktop("Engine initialization complete");
+        // Map the pump's scratch pages now rather than on the first block
+        for (auto* buffer : { &tempBuffer, &fadeBuffer })
+            for (int ch = 0; ch < buffer->getNumChannels(); ++ch)
+                juce::FloatVectorOperations::clear(buffer->getWritePointer(ch), buffer->getNumSamples());
+
+        lastHeartbeatMs = juce::Time::getMillisecondCounter();
+        lastPluginBeat = ipc.getPeerHeartbeat();
+        lastUnderruns = ipc.getAudioUnderrunBlocks();
+        lastDropped = ipc.getAudioDroppedFrames();
+        return true;
     }
 
-    void shutdown() override
+    int getSlot() const { return slot; }
+
+    // Set by the pump (quit command / heartbeat lost), acted on by the message thread
+    bool shouldClose() const { return closeRequested.load(); }
+
+    // Message thread
+    void showWindow()
     {
-        logToDesktop("Engine shutting down...");
-        signalThreadShouldExit();
-        stopThread(2000);
-        videoWin = nullptr;
-        logToDesktop("Engine shutdown complete");
+        if (videoWin)
+        {
+            if (videoWin->isMinimised()) videoWin->setMinimised(false);
+            videoWin->setVisible(true);
+            videoWin->toFront(true);
+        }
     }
 
-    void run() override
+    // Message thread: libVLC calls the pump's A/V corrections need (they take libVLC's locks)
+    void applyAvCorrections()
     {
-        const int blockSize = 512;
-        juce::AudioBuffer<float> tempBuffer(2, blockSize);
-        juce::AudioSourceChannelInfo info(&tempBuffer, 0, blockSize);
-        int counter = 0;
-        
-        // Heartbeat watchdog - quit if no heartbeat for 10 seconds
-        const int heartbeatTimeoutFrames = 10 * 1000; // 10 seconds at 1ms loop
-        int framesSinceHeartbeat = 0;
-        
-        // FIX: Track sample rate changes from DAW
-        int lastKnownRate = player.getCurrentSampleRate();
+        primaryPlayer.applyPendingAudioDelay();
+        secondaryPlayer.applyPendingAudioDelay();
+    }
 
-        while (!threadShouldExit())
+    // Message thread: writes out what the pump posted (building the text allocates, so it is done here)
+    void logEvents()
+    {
+        int start1, size1, start2, size2;
+        eventFifo.prepareToRead(eventFifo.getNumReady(), start1, size1, start2, size2);
+
+        for (int i = 0; i < size1 + size2; ++i)
         {
-            juce::String cmdJson = ipc.getNextCommand();
-            if (cmdJson.isNotEmpty()) 
-            {
-                if (cmdJson.contains("\"heartbeat\""))
-                {
-                    framesSinceHeartbeat = 0;
-                }
-                else
-                {
-                    handleCommand(cmdJson);
-                }
-            }
-            
-            framesSinceHeartbeat++;
-            
-            if (framesSinceHeartbeat > heartbeatTimeoutFrames)
-            {
-                logToDesktop("WATCHDOG: No heartbeat for 10 seconds - plugin likely terminated. Quitting engine.");
-                juce::MessageManager::callAsync([this]() {
-                    quit();
-                });
-                return;
-            }
+            const auto& e = events[(size_t)(i < size1 ? start1 + i : start2 + i - size1)];
+            const auto prefix = "Deck " + juce::String(slot) + ": ";
 
-            // FIX: Check for sample rate changes from DAW (poll every ~500ms)
-            if (counter % 500 == 0)
+            switch (e.kind)
             {
-                int dawRate = ipc.getDawSampleRate();
-                if (dawRate != lastKnownRate && dawRate > 1000)
-                {
-                    logToDesktop("DAW sample rate changed: " + juce::String(lastKnownRate) + " -> " + juce::String(dawRate));
-                    player.reconfigureSampleRate(dawRate);
-                    lastKnownRate = dawRate;
-                }
+                case DeckEvent::Kind::Crossfade:
+                    LOG_INFO(prefix + "crossfading into track #" + juce::String((int)e.trackId) + " over " + juce::String(e.seconds, 1) + " s");
+                    break;
+                case DeckEvent::Kind::Waiting:
+                    LOG_INFO(prefix + "waiting " + juce::String(e.seconds, 2) + " s before track #" + juce::String((int)e.trackId));
+                    break;
+                case DeckEvent::Kind::Switched:
+                    LOG_INFO(prefix + "switched to track #" + juce::String((int)e.trackId));
+                    break;
+                case DeckEvent::Kind::RateChanged:
+                    LOG_INFO(prefix + "DAW sample rate changed: " + juce::String(e.oldRate) + " -> " + juce::String(e.newRate));
+                    break;
+                case DeckEvent::Kind::Watchdog:
+                    LOG_WARNING("WATCHDOG: Deck " + juce::String(slot) + " - no heartbeat for 10 seconds, plugin likely terminated.");
+                    break;
             }
+        }
+        eventFifo.finishedRead(size1 + size2);
+    }
 
-            // Audio Pumping
-            if (player.getNumAudioSamplesAvailable() >= blockSize)
-            {
-                tempBuffer.clear();
-                player.getNextAudioBlock(info);
-                ipc.pushAudio(tempBuffer.getArrayOfReadPointers(), 2, blockSize);
-            }
+    // Pump thread: commands, audio, status. Returns how long this deck may sleep.
+    int pump(juce::uint32 now, char* commandBuffer, size_t commandBufferSize)
+    {
+        // A deferred Load holds back the commands behind it until it has run
+        if (loadDeferred && !nextLoader.isBusy()) runDeferredLoad();
+
+        uint32_t sequence = 0;
+        while (!loadDeferred)
+        {
+            const size_t n = ipc.getNextCommand(commandBuffer, commandBufferSize, &sequence);
+            if (n == 0) break;
+
+            IPCProtocol::Message msg;
+            const bool valid = IPCProtocol::isBinary(commandBuffer, n)
+                             ? IPCProtocol::decode(commandBuffer, n, msg)
+                             : parseJsonCommand(juce::String::fromUTF8(commandBuffer, (int)n), msg);
+            if (!valid) continue;
+
+            // JSON has no header; the queue record carries the same sequence binary messages use
+            msg.sequence = sequence;
 
-            if (counter++ % 8 == 0)
+            // Legacy heartbeat command (JSON debug clients) counts as a beat too
+            if (msg.opcode == IPCProtocol::Opcode::Heartbeat)
+                lastHeartbeatMs = now;
+            else
+                handleCommand(msg);
+        }
+
+        // The plugin bumps its counter from its timer; any movement is a beat
+        const auto pluginBeat = ipc.getPeerHeartbeat();
+        if (pluginBeat != lastPluginBeat)
+        {
+            lastPluginBeat = pluginBeat;
+            lastHeartbeatMs = now;
+        }
+
+        // Heartbeat watchdog - close the deck if its plugin stopped responding (wall clock, not loop count)
+        if (now - lastHeartbeatMs > heartbeatTimeoutMs)
+        {
+            postEvent(DeckEvent::Kind::Watchdog, trackId);
+            closeRequested = true;
+            return idleTimeoutMs;
+        }
+
+        // FIX: Check for sample rate changes from DAW (poll every ~500ms)
+        if (now - lastRateCheckMs >= rateCheckIntervalMs)
+        {
+            lastRateCheckMs = now;
+            int dawRate = ipc.getDawSampleRate();
+            if (dawRate != lastKnownRate && dawRate > 1000)
             {
-                bool isWinOpen = (videoWin && videoWin->isVisible());
-                ipc.setEngineStatus(
-                    player.isPlaying(), 
-                    player.hasFinished(),
-                    isWinOpen,
-                    player.getPosition(), 
-                    player.getLengthMs()
-                );
+                postEvent(DeckEvent::Kind::RateChanged, trackId, 0.0, lastKnownRate, dawRate);
+                // A player the loader is opening picks the new rate up when the pump takes it over
+                for (auto* p : { &primaryPlayer, &secondaryPlayer })
+                    if (p != nextPlayer || !nextLoader.isBusy()) p->reconfigureSampleRate(dawRate);
+                lastKnownRate = dawRate;
             }
-            
-            // FIX: 1ms pump loop for tighter audio delivery
-            wait(1);
+
+            // The plugin's target fill follows its block size
+            updatePipelineTargets();
+        }
+
+        // Next track: open it, pre-roll it and start the crossfade / wait as the current one nears its end
+        updateNextTrack();
+
+        // Seeks: issue the latest target, splice once the player has audio there
+        updateSeek(now);
+
+        // Decode, deliver, then decode again into the room delivery made
+        decodeToPrebuffer();
+        deliverAudio();
+        decodeToPrebuffer();
+
+        // Part of the A/V latency the player measures against VLC's clock
+        player->setOutputLatencyFrames(ipc.getAudioFramesReady() + pcmQueue.getNumReady());
+
+        // The wait between tracks keeps the deck on the playing schedule
+        const bool playing = player->isPlaying() || (waiting && !waitPaused);
+
+        // Reads from the plugin only wake the pump while there is a track to keep up with;
+        // a stopped deck's empty ring would otherwise ring the doorbell on every DAW block
+        ipc.setAudioWakeThreshold(playing ? wakeThresholdFrames : 0);
+
+        if (now - lastStatusMs >= statusIntervalMs)
+        {
+            lastStatusMs = now;
+            ipc.beatHeartbeat();
+            publishStatus(playing);
         }
+
+        // While playing, wake before the buffered audio falls to the threshold
+        if (!playing) return loadDeferred ? deferredLoadPollMs : idleTimeoutMs;
+
+        const int marginFrames = ipc.getAudioFramesReady() - wakeThresholdFrames;
+        const int marginMs = (int)((int64_t)marginFrames * 1000 / juce::jmax(1, lastKnownRate));
+        return juce::jlimit(1, maxPlayingTimeoutMs, marginMs / 2);
     }
 
-private:
-    void handleCommand(const juce::String& json)
+    // Pump thread, after prepareWait(): anything that must not wait for the next ring?
+    bool hasWork()
     {
-        auto var = juce::JSON::parse(json);
-        if (!var.isObject()) return;
-        juce::String type = var["type"];
-        
-        logToDesktop("Received command: " + type);
-        
-        if (type == "load") {
-            juce::String path = var["path"];
-            float vol = var.hasProperty("vol") ? (float)var["vol"] : 1.0f;
-            float rate = var.hasProperty("speed") ? (float)var["speed"] : 1.0f;
-            
-            player.load(path, vol, rate);
-            juce::MessageManager::callAsync([this]() {
-                if (videoWin && !videoWin->isVisible()) {
-                    videoWin->setVisible(true);
-                    videoWin->toFront(true);
-                }
-            });
-        }
-        else if (type == "play")  { player.play(); }
-        else if (type == "pause") { player.pause(); }
-        else if (type == "stop")  { player.stop(); }
-        else if (type == "seek")  { player.setPosition((float)var["pos"]); }
-        else if (type == "volume"){ player.setVolume((float)var["val"]); }
-        else if (type == "rate")  { player.setRate((float)var["val"]); }
-        else if (type == "show_window") {
-            juce::MessageManager::callAsync([this]() {
-                if (videoWin) {
-                    if (videoWin->isMinimised()) videoWin->setMinimised(false);
-                    videoWin->setVisible(true);
-                    videoWin->toFront(true);
-                    logToDesktop("show_window: Window shown and brought to front");
-                }
-            });
+        return (ipc.hasPendingCommand() && !loadDeferred) || hasAudioToDecode() || hasAudioToDeliver();
+    }
+
+    // One stats interval of a deck: taken on the pump, written out by the message thread
+    struct Stats
+    {
+        int slot = -1;
+        uint32_t underrunBlocks = 0, droppedFrames = 0, decoderDropped = 0, decoderLate = 0;
+        int queued = 0, prebuffer = 0, ringTarget = 0;
+        uint32_t commandsDropped[3] = {};   // rt / msg / bg
+        uint32_t seeks = 0;
+        double seekAvgMs = 0.0, seekMaxMs = 0.0;
+        bool hasAvSync = false;
+        double avSkewMs = 0.0, avCorrectionMs = 0.0;
+
+        // Message thread (allocates)
+        juce::String toString() const
+        {
+            auto text = "deck " + juce::String(slot) + ": "
+                      + juce::String((int)underrunBlocks) + " underrun blocks, "
+                      + juce::String((int)droppedFrames) + " dropped frames, decoder dropped frames/late blocks "
+                      + juce::String((int)decoderDropped) + "/" + juce::String((int)decoderLate) + ", queue "
+                      + juce::String(queued) + "/" + juce::String(prebuffer) + ", ring target "
+                      + juce::String(ringTarget) + " frames, commands dropped rt/msg/bg "
+                      + juce::String((int)commandsDropped[0]) + "/" + juce::String((int)commandsDropped[1]) + "/"
+                      + juce::String((int)commandsDropped[2]);
+
+            if (seeks > 0)
+                text << ", seeks " << (int)seeks << " (to audio avg " << juce::String(seekAvgMs, 1)
+                     << " max " << juce::String(seekMaxMs, 1) << " ms)";
+
+            if (hasAvSync)
+                text << ", A/V skew " << juce::String(avSkewMs, 1) << " ms, correction " << juce::String(avCorrectionMs, 1) << " ms";
+            return text;
         }
-        else if (type == "quit") {
-            logToDesktop("Received quit command from plugin");
-            juce::MessageManager::callAsync([this]() {
-                quit();
-            });
+    };
+
+    // Pump thread: underruns / drops since the last call. Does not allocate.
+    Stats takeStats()
+    {
+        const auto underruns = ipc.getAudioUnderrunBlocks();
+        const auto dropped = ipc.getAudioDroppedFrames();
+        const auto decoderDropped = primaryPlayer.getDecoderDroppedFrames() + secondaryPlayer.getDecoderDroppedFrames();
+        const auto decoderLate = decodeLateBlocks;
+
+        Stats s;
+        s.slot = slot;
+        s.underrunBlocks = underruns - lastUnderruns;
+        s.droppedFrames = dropped - lastDropped;
+        s.decoderDropped = decoderDropped - lastDecoderDropped;
+        s.decoderLate = decoderLate - lastDecoderLate;
+        s.queued = pcmQueue.getNumReady();
+        s.prebuffer = prebufferFrames;
+        s.ringTarget = deliveryTargetFrames;
+        s.commandsDropped[0] = ipc.getCommandsDropped(IPCCaller::RealTime);
+        s.commandsDropped[1] = ipc.getCommandsDropped(IPCCaller::Message);
+        s.commandsDropped[2] = ipc.getCommandsDropped(IPCCaller::Background);
+
+        if (seekCount > 0)
+        {
+            s.seeks = seekCount;
+            s.seekAvgMs = seekLatencySumMs / (double)seekCount;
+            s.seekMaxMs = seekLatencyMaxMs;
+            seekCount = 0;
+            seekLatencySumMs = seekLatencyMaxMs = 0.0;
         }
+
+        s.hasAvSync = player->getAvSyncStats(s.avSkewMs, s.avCorrectionMs);
+
+        lastUnderruns = underruns;
+        lastDropped = dropped;
+        lastDecoderDropped = decoderDropped;
+        lastDecoderLate = decoderLate;
+        return s;
+    }
+
+private:
+    static constexpr int wakeThresholdFrames = blockSize * 4;
+    static constexpr juce::uint32 heartbeatTimeoutMs = 10 * 1000;
+    static constexpr juce::uint32 statusIntervalMs = 8;
+    static constexpr juce::uint32 rateCheckIntervalMs = 500;
+    static constexpr int maxSampleRate = 192000;        // Sizes the PCM queue
+
+    // Seek pipeline
+    static constexpr int seekFadeFrames = 256;                // Fade-out and fade-in at the splice (< blockSize)
+    static constexpr int seekPrerollFrames = blockSize * 4;   // Decoded at the target before the splice
+    static constexpr juce::uint32 seekReissueMs = 50;         // Coalescing: newest target at most this often
+    static constexpr juce::uint32 seekTimeoutMs = 1000;       // Splice without pre-roll after this
+
+    // Pre-roll lead for the next track: VLC takes ~100-250 ms from play() to its first
+    // samples and its amem FIFO holds ~350 ms, so the new track is ready without overflowing
+    static constexpr double preRollLeadSeconds = 0.3;
+
+    // A preloaded track is only opened this long before it is due
+    static constexpr double openLeadSeconds = 5.0;
+
+    // Pump -> message thread, for the log (see logEvents)
+    struct DeckEvent
+    {
+        enum class Kind : uint8_t { Crossfade, Waiting, Switched, RateChanged, Watchdog };
+
+        Kind kind;
+        uint32_t trackId;
+        double seconds;
+        int oldRate, newRate;   // RateChanged
+    };
+
+    // Pump thread. Dropped if the message thread has fallen that far behind.
+    void postEvent(DeckEvent::Kind kind, uint32_t id, double seconds = 0.0, int oldRate = 0, int newRate = 0)
+    {
+        int start1, size1, start2, size2;
+        eventFifo.prepareToWrite(1, start1, size1, start2, size2);
+        if (size1 == 0) return;
+
+        events[(size_t)start1] = { kind, id, seconds, oldRate, newRate };
+        eventFifo.finishedWrite(1);
+    }
+
+    EnginePlayState getPlayState(bool playing)
+    {
+        if (trackId == 0) return EnginePlayState::Empty;
+        if (waiting) return waitPaused ? EnginePlayState::Paused : EnginePlayState::Waiting;
+        if (playing || crossfading) return EnginePlayState::Playing;   // The fade owns the end of the track
+        if (player->hasFinished()) return EnginePlayState::Finished;
+        return transportState;
+    }
+
+    void publishStatus(bool playing)
+    {
+        const int64_t rate = juce::jmax(1, lastKnownRate);
+
+        EngineStatusSnapshot snapshot;
+        snapshot.trackId = trackId;
+        snapshot.state = (uint32_t)getPlayState(playing);
+        snapshot.positionSamples = (int64_t)std::llround(player->getPositionSeconds() * (double)rate);
+        snapshot.lengthSamples = player->getLengthMs() * rate / 1000;
+        snapshot.sampleRate = (uint32_t)rate;
+        snapshot.bufferedFrames = (uint32_t)(ipc.getAudioFramesReady() + pcmQueue.getNumReady());
+        snapshot.timestampUs = IPCProtocol::nowMicros();
+        snapshot.playbackRate = playbackRate;
+        snapshot.flags = (videoWin && videoWin->isVisible()) ? EngineStatusSnapshot::WindowOpen : 0u;
+        snapshot.waitRemainingSamples = waiting ? gapFramesRemaining : 0;
+        ipc.setEngineStatus(snapshot);
     }
 
-    SharedMemoryManager ipc { SharedMemoryManager::Mode::Engine_Server };
-    SingleDeckPlayer player;
-    std::unique_ptr<VideoWindow> videoWin;
+    // ==============================================================================
+    // Decode stage: the render paths below write whole blocks into pcmQueue, up to
+    // the prebuffer. Delivery stage: the ring is topped up from the queue to
+    // deliveryTargetFrames - the plugin's target fill plus one pump period, so the
+    // ring does not reach the wake threshold between two passes.
+    // ==============================================================================
+
+    // Pump thread, at open and on every rate check
+    void updatePipelineTargets()
+    {
+        const int rate = juce::jmax(1, lastKnownRate);
+        const int prebuffer = (int)((int64_t)prebufferMs * rate / 1000);
+        prebufferFrames = juce::jlimit(blockSize, pcmQueue.getCapacity(), (prebuffer + blockSize - 1) / blockSize * blockSize);
+
+        const int pluginTarget = ipc.getAudioTargetFill();
+        const int target = (pluginTarget > 0 ? pluginTarget : IPCConfig::getDriftTargetFillFrames(blockSize))
+                         + maxPlayingTimeoutMs * rate / 1000;
+        deliveryTargetFrames = juce::jlimit(wakeThresholdFrames + blockSize, ipc.getRingCapacityFrames(), target);
+    }
+
+    void decodeToPrebuffer()
+    {
+        while (hasAudioToDecode())
+        {
+            tempBuffer.clear();
+            const int available = player->getNumAudioSamplesAvailable();
+
+            if (waiting)
+                renderWait(0);
+            else if (crossfading)
+                renderCrossfade(available);
+            else if (available >= blockSize || !isCurrentTrackEnding())
+                player->getNextAudioBlock(info);
+            else
+                renderTrackEnd(available);
+
+            // First block after a seek splice: the old audio faded out in the queue, this fades in
+            if (spliceFadeIn)
+            {
+                tempBuffer.applyGainRamp(0, seekFadeFrames, 0.0f, 1.0f);
+                spliceFadeIn = false;
+            }
+
+            pcmQueue.write(tempBuffer, blockSize);
+        }
+
+        countLateBlock();
+    }
+
+    void restartDecodeStage()
+    {
+        decodePrimed = false;
+        decodeStartMs = juce::Time::getMillisecondCounter();
+    }
+
+    // After the decode stage: it stopped with room for another block because the decoder
+    // has less than one. Counted once per pump pass. Filling the prebuffer after a start or
+    // splice is not late, until it was full once or decodeStartGraceMs passed; nor is a seek,
+    // a wait or the end of the track.
+    void countLateBlock()
+    {
+        if (pcmQueue.getNumReady() + blockSize > prebufferFrames) { decodePrimed = true; return; }
+        if (isSeeking() || waiting || !player->isPlaying() || isCurrentTrackEnding()) return;
+        if (!decodePrimed && juce::Time::getMillisecondCounter() - decodeStartMs < decodeStartGraceMs) return;
+
+        const bool dry = player->getNumAudioSamplesAvailable() < blockSize
+                      || (crossfading && nextPlayer->getNumAudioSamplesAvailable() < blockSize);
+        if (dry) ++decodeLateBlocks;
+    }
+
+    // What the ring should take now. A real-time paced source whose clock runs ahead of
+    // the DAW's fills the queue; past half of it the excess goes on to the ring, where the
+    // plugin's drift compensator sees it (decoded audio is never dropped here).
+    int getDeliveryWanted()
+    {
+        int wanted = deliveryTargetFrames - ipc.getAudioFramesReady();
+
+        if (player->isRealtimePaced())
+            wanted = juce::jmax(wanted, pcmQueue.getNumReady() - prebufferFrames / 2);
+
+        // While a seek is under way the last frames stay back for the fade-out at the splice
+        if (isSeeking() && !seekTailReleased)
+            wanted = juce::jmin(wanted, pcmQueue.getNumReady() - seekFadeFrames);
+
+        return juce::jmin(wanted, ipc.getAudioFramesFree());
+    }
+
+    bool hasAudioToDeliver()
+    {
+        return pcmQueue.getNumReady() > 0 && getDeliveryWanted() > 0;
+    }
+
+    void deliverAudio()
+    {
+        pcmQueue.deliverTo(ipc, getDeliveryWanted());
+    }
+
+    bool hasAudioToDecode()
+    {
+        if (pcmQueue.getNumReady() + blockSize > prebufferFrames) return false;
+        if (isSeeking()) return false;   // The player is between positions until the splice
+        if (waitPaused) return false;    // Held at the end of the track until Play
+
+        const int available = player->getNumAudioSamplesAvailable();
+        const bool ending = isCurrentTrackEnding();
+
+        // Silence until the wait runs out, then the next track from that frame on
+        if (waiting)
+            return gapFramesRemaining >= blockSize
+                || (nextStarted && nextPlayer->getNumAudioSamplesAvailable() >= blockSize - gapFramesRemaining);
+
+        // Both tracks feed every block; the outgoing one may run out before the fade ends
+        if (crossfading)
+            return nextPlayer->getNumAudioSamplesAvailable() >= blockSize && (available >= blockSize || ending);
+
+        if (available >= blockSize) return true;
+        if (!ending) return false;
+
+        // The track ends inside the next block: splice the preloaded one in as soon as it has audio,
+        // or fill up with the start of the wait
+        if (nextArmed)
+        {
+            const int64_t head = available + getGapFrames();
+            return head >= blockSize
+                || (nextStarted && head + nextPlayer->getNumAudioSamplesAvailable() >= blockSize);
+        }
+        return available > 0;
+    }
+
+    // Decoded to the end while playing (not paused near the end): what is left is its tail
+    bool isCurrentTrackEnding()
+    {
+        return player->isAtEndOfStream() && (player->isPlaying() || player->hasFinished());
+    }
+
+    // Output time left on the current track; -1 while it is not playing or its length is unknown
+    double getRemainingSeconds()
+    {
+        if (isCurrentTrackEnding()) return 0.0;
+
+        const int64_t lengthMs = player->getLengthMs();
+        if (!player->isPlaying() || lengthMs <= 0) return -1.0;
+
+        return juce::jmax(0.0, (lengthMs / 1000.0 - player->getPositionSeconds()) / juce::jmax(0.05f, playbackRate));
+    }
+
+    // The Preload's wait in output frames at the current DAW rate
+    int64_t getGapFrames() const
+    {
+        return (int64_t)std::llround(nextGapSeconds * lastKnownRate);
+    }
+
+    // ==============================================================================
+    // Seek pipeline. While playing, a Seek only records its target: the latest one
+    // is issued to the player (again at most every seekReissueMs while the user
+    // drags), and the audio already queued keeps playing. Decoding resumes once
+    // the player has seekPrerollFrames at the target; the queue is cut down to a
+    // seekFadeFrames fade-out and the new audio fades in. Paused, stopped, waiting
+    // or crossfading decks seek straight away, as before.
+    // ==============================================================================
+
+    bool isSeeking() const { return seekPending || seekInFlight; }
+
+    void requestSeek(const IPCProtocol::Message& msg)
+    {
+        if (!player->isPlaying() || waiting || crossfading)
+        {
+            seekPending = seekInFlight = seekTailReleased = false;
+            player->setPosition(msg.value);
+            rewindPreRoll();
+            pcmQueue.reset();
+            return;
+        }
+
+        // Latency is counted from the first request of a coalesced run, as the plugin sent it
+        if (!isSeeking()) seekRequestUs = msg.timestampUs != 0 ? msg.timestampUs : IPCProtocol::nowMicros();
+        seekTarget = msg.value;
+        seekPending = true;
+    }
+
+    // Transport leaves the playing state mid-seek: go to the target without a splice
+    void finishSeekNow()
+    {
+        if (seekPending) player->setPosition(seekTarget);
+        if (isSeeking()) pcmQueue.reset();
+        seekPending = seekInFlight = seekTailReleased = spliceFadeIn = false;
+    }
+
+    void updateSeek(juce::uint32 now)
+    {
+        if (seekPending && (!seekInFlight || now - seekIssuedMs >= seekReissueMs))
+        {
+            player->setPosition(seekTarget);
+            rewindPreRoll();
+            seekPending = false;
+            seekInFlight = true;
+            seekIssuedMs = now;
+            return;
+        }
+
+        // The ring is about to run dry before the player is ready: let the old audio fade out now
+        if (isSeeking() && !seekTailReleased && ipc.getAudioFramesReady() < blockSize)
+        {
+            pcmQueue.fadeOutAndTruncate(seekFadeFrames);
+            seekTailReleased = true;
+        }
+
+        // A newer target waits for its turn rather than splicing in the one in flight
+        if (!seekInFlight || seekPending) return;
+
+        const bool ready = player->getNumAudioSamplesAvailable() >= seekPrerollFrames || isCurrentTrackEnding();
+        if (!ready && now - seekIssuedMs < seekTimeoutMs) return;
+
+        spliceSeek();
+    }
+
+    void spliceSeek()
+    {
+        if (!seekTailReleased) pcmQueue.fadeOutAndTruncate(seekFadeFrames);
+        spliceFadeIn = true;
+        restartDecodeStage();   // The queue refills from the pre-roll
+        seekInFlight = seekTailReleased = false;
+
+        // Until the new audio is heard: time so far plus what plays before it
+        const double aheadMs = (double)(ipc.getAudioFramesReady() + pcmQueue.getNumReady()) * 1000.0
+                             / (double)juce::jmax(1, lastKnownRate);
+        const double latencyMs = (double)(IPCProtocol::nowMicros() - seekRequestUs) / 1000.0 + aheadMs;
+
+        ++seekCount;
+        seekLatencySumMs += latencyMs;
+        seekLatencyMaxMs = juce::jmax(seekLatencyMaxMs, latencyMs);
+
+        if (AppLogger::getInstance().isEnabled(AppLogger::Level::Debug))
+            LOG_DEBUG("Deck " + juce::String(slot) + ": seek to " + juce::String(seekTarget, 3)
+                      + ", audio after " + juce::String(latencyMs, 1) + " ms");
+    }
+
+    // ==============================================================================
+    // Next track. A Preload only records it; the loader thread opens it on the
+    // second player openLeadSeconds before it is due, and once it is armed the
+    // pump starts it preRollLeadSeconds early.
+    // Without a fade it takes over at the exact sample the current track runs
+    // out, or after its wait (silence counted in output frames); with a fade,
+    // both play for the fade length and are mixed here.
+    // ==============================================================================
+    void updateNextTrack()
+    {
+        if (!nextPending || crossfading || waitPaused) return;
+
+        const double remaining = getRemainingSeconds();
+        if (remaining < 0.0) return;
+
+        // Time until the next track's first frame
+        const double due = waiting ? (double)gapFramesRemaining / lastKnownRate
+                                   : remaining + nextGapSeconds;
+
+        if (!nextArmed && due <= nextFadeSeconds + openLeadSeconds)
+        {
+            switch (nextLoader.getState())
+            {
+                case NextTrackLoader::State::Idle:
+                    nextLoader.request(*nextPlayer, nextPath, nextVolume, nextRate, lastKnownRate);
+                    return;
+                case NextTrackLoader::State::Armed:
+                    nextLoader.release();
+                    nextArmed = true;
+                    nextPlayer->reconfigureSampleRate(lastKnownRate);   // In case the DAW rate changed meanwhile
+                    break;
+                case NextTrackLoader::State::Failed:
+                    // Unplayable: the plugin's regular finish / load path takes over
+                    nextLoader.release();
+                    cancelPreload();
+                    return;
+                case NextTrackLoader::State::Loading:
+                case NextTrackLoader::State::Cancelling:   // A cancelled open still returning
+                default:
+                    return;
+            }
+        }
+
+        if (nextArmed && !nextStarted && due <= nextFadeSeconds + preRollLeadSeconds)
+        {
+            nextPlayer->play();
+            nextStarted = true;
+        }
+
+        if (nextStarted && nextFadeSeconds > 0.0 && nextGapSeconds == 0.0 && remaining <= nextFadeSeconds)
+        {
+            crossfading = true;
+            fadePosition = 0;
+            fadeLength = juce::jmax(blockSize, (int)(remaining * lastKnownRate));
+            postEvent(DeckEvent::Kind::Crossfade, nextTrackId, remaining);
+        }
+    }
+
+    // The current track ends inside this block: its tail, then the next track right behind it
+    void renderTrackEnd(int available)
+    {
+        if (available > 0)
+        {
+            juce::AudioSourceChannelInfo tail { &tempBuffer, 0, available };
+            player->getNextAudioBlock(tail);
+        }
+
+        if (!nextArmed) return;
+
+        if (nextGapSeconds > 0.0)
+        {
+            waiting = true;
+            gapFramesRemaining = getGapFrames();
+            postEvent(DeckEvent::Kind::Waiting, nextTrackId, nextGapSeconds);
+            renderWait(available);
+            return;
+        }
+
+        switchToNextTrack();
+        juce::AudioSourceChannelInfo head { &tempBuffer, available, blockSize - available };
+        player->getNextAudioBlock(head);
+    }
+
+    // The wait between tracks from offset on (tempBuffer is already silent);
+    // the next track starts at the frame it runs out
+    void renderWait(int offset)
+    {
+        const int silent = (int)juce::jmin(gapFramesRemaining, (int64_t)(blockSize - offset));
+        gapFramesRemaining -= silent;
+        if (gapFramesRemaining > 0) return;
+
+        switchToNextTrack();
+
+        const int start = offset + silent;
+        if (start < blockSize)
+        {
+            juce::AudioSourceChannelInfo head { &tempBuffer, start, blockSize - start };
+            player->getNextAudioBlock(head);
+        }
+    }
+
+    // Outgoing and incoming track mixed with the preload's fade curve
+    void renderCrossfade(int available)
+    {
+        // Once the outgoing track runs out, its share of the block stays silent
+        const int outgoing = isCurrentTrackEnding() ? juce::jmin(available, blockSize) : blockSize;
+        if (outgoing > 0)
+        {
+            juce::AudioSourceChannelInfo out { &tempBuffer, 0, outgoing };
+            player->getNextAudioBlock(out);
+        }
+
+        fadeBuffer.clear();
+        nextPlayer->getNextAudioBlock(fadeInfo);
+
+        // Curve evaluated at both ends of the block, ramped in between
+        float out0, in0, out1, in1;
+        getFadeGains(nextFadeCurve, (float)fadePosition / (float)fadeLength, out0, in0);
+        getFadeGains(nextFadeCurve, (float)(fadePosition + blockSize) / (float)fadeLength, out1, in1);
+
+        tempBuffer.applyGainRamp(0, blockSize, out0, out1);
+        for (int ch = 0; ch < 2; ++ch)
+            tempBuffer.addFromWithRamp(ch, 0, fadeBuffer.getReadPointer(ch), blockSize, in0, in1);
+
+        fadePosition += blockSize;
+        if (fadePosition >= fadeLength)
+            switchToNextTrack();
+    }
+
+    static void getFadeGains(IPCProtocol::FadeCurve curve, float t, float& gainOut, float& gainIn)
+    {
+        t = juce::jlimit(0.0f, 1.0f, t);
+
+        switch (curve)
+        {
+            case IPCProtocol::FadeCurve::Linear:
+                gainIn = t;
+                break;
+            case IPCProtocol::FadeCurve::SCurve:
+                gainIn = 0.5f - 0.5f * std::cos(juce::MathConstants<float>::pi * t);
+                break;
+            case IPCProtocol::FadeCurve::EqualPower:
+            default:
+                gainIn = std::sin(juce::MathConstants<float>::halfPi * t);
+                gainOut = std::cos(juce::MathConstants<float>::halfPi * t);
+                return;
+        }
+        gainOut = 1.0f - gainIn;
+    }
+
+    void switchToNextTrack()
+    {
+        std::swap(player, nextPlayer);
+        nextPlayer->stop();   // The finished track; this player takes the next preload
+
+        trackId = nextTrackId;
+        playbackRate = nextRate;
+        transportState = EnginePlayState::Stopped;
+        nextPending = nextArmed = nextStarted = crossfading = waiting = waitPaused = false;
+
+        postEvent(DeckEvent::Kind::Switched, trackId);
+    }
+
+    void cancelPreload()
+    {
+        const bool loaded = nextLoader.cancel();   // Opened, not yet taken over
+        if (nextArmed || nextStarted || loaded) nextPlayer->stop();
+        nextPending = nextArmed = nextStarted = crossfading = waiting = waitPaused = false;
+    }
+
+    // Transport moved on the current track: the next one starts over once it is due again
+    void rewindPreRoll()
+    {
+        if (nextStarted) nextPlayer->stop();
+        nextStarted = crossfading = waiting = waitPaused = false;
+    }
+
+    // Pause at the end of the track: a running wait, or a finished track whose wait or
+    // switch is still to be rendered, stays where it is. The pre-roll starts over on Play.
+    void holdTrackEnd()
+    {
+        if (nextStarted) nextPlayer->stop();
+        nextStarted = false;
+        waitPaused = true;
+    }
+
+    // Debug fallback: legacy JSON commands are mapped onto the binary message view
+    bool parseJsonCommand(const juce::String& json, IPCProtocol::Message& msg)
+    {
+        auto var = juce::JSON::parse(json);
+        if (!var.isObject()) return false;
+        juce::String type = var["type"];
+
+        using Op = IPCProtocol::Opcode;
+        msg = IPCProtocol::Message();
+
+        if (type == "load" || type == "preload") {
+            jsonPath = var["path"].toString();
+            msg.opcode = (type == "load") ? Op::Load : Op::Preload;
+            msg.path = jsonPath.toRawUTF8();
+            msg.pathLength = (uint32_t)jsonPath.getNumBytesAsUTF8();
+            msg.volume = var.hasProperty("vol") ? (float)var["vol"] : 1.0f;
+            msg.rate = var.hasProperty("speed") ? (float)var["speed"] : 1.0f;
+            msg.fadeSeconds = juce::jmax(0.0f, (float)var["fade"]);
+            msg.fadeCurve = (IPCProtocol::FadeCurve)juce::jlimit(0, (int)IPCProtocol::FadeCurve::NumCurves - 1, (int)var["curve"]);
+            msg.gapSeconds = juce::jmax(0.0f, (float)var["wait"]);
+        }
+        else if (type == "play")        { msg.opcode = Op::Play; }
+        else if (type == "pause")       { msg.opcode = Op::Pause; }
+        else if (type == "stop")        { msg.opcode = Op::Stop; }
+        else if (type == "seek")        { msg.opcode = Op::Seek;   msg.value = (float)var["pos"]; }
+        else if (type == "volume")      { msg.opcode = Op::Volume; msg.value = (float)var["val"]; }
+        else if (type == "rate")        { msg.opcode = Op::Rate;   msg.value = (float)var["val"]; }
+        else if (type == "show_window") { msg.opcode = Op::ShowWindow; }
+        else if (type == "quit")        { msg.opcode = Op::Quit; }
+        else if (type == "heartbeat")   { msg.opcode = Op::Heartbeat; }
+        else return false;
+
+        return true;
+    }
+
+    // Pump thread: the Load recorded by handleCommand(), once the primary player is free
+    void runDeferredLoad()
+    {
+        loadDeferred = false;
+        const bool withVideo = !headless && isVideoFile(loadPath);
+
+        if (player != &primaryPlayer)
+        {
+            player->stop();
+            std::swap(player, nextPlayer);
+        }
+
+        player->setVideoEnabled(withVideo);
+        player->load(loadPath, loadVolume, loadRate);
+        pcmQueue.reset();   // Decoded audio of the old track goes
+        seekPending = seekInFlight = seekTailReleased = spliceFadeIn = false;
+        trackId = juce::jmax(1u, loadSequence);
+        playbackRate = loadRate;
+        transportState = EnginePlayState::Stopped;
+
+        // Audio-only tracks leave the window alone
+        if (!withVideo) return;
+
+        // The deck may be gone by the time the message thread runs this
+        juce::Component::SafePointer<VideoWindow> win (videoWin.get());
+        juce::MessageManager::callAsync([win]() {
+            if (win != nullptr && !win->isVisible()) {
+                win->setVisible(true);
+                win->toFront(true);
+            }
+        });
+    }
+
+    void handleCommand(const IPCProtocol::Message& msg)
+    {
+        using Op = IPCProtocol::Opcode;
+
+        // Per-command trace only at debug verbosity (skips building the string otherwise)
+        if (AppLogger::getInstance().isEnabled(AppLogger::Level::Debug))
+            LOG_DEBUG("Deck " + juce::String(slot) + " received command: "
+                      + juce::String(IPCProtocol::getOpcodeName(msg.opcode)) + " #" + juce::String((int)msg.sequence));
+
+        // The deck may be gone by the time the message thread runs these
+        juce::Component::SafePointer<VideoWindow> win (videoWin.get());
+
+        switch (msg.opcode)
+        {
+            case Op::Load:
+            {
+                // Loads always go to the primary player, the one bound to the video window
+                cancelPreload();
+                loadPath = juce::String::fromUTF8(msg.path, (int)msg.pathLength);
+                loadVolume = msg.volume;
+                loadRate = msg.rate;
+                loadSequence = msg.sequence;
+                loadDeferred = true;
+
+                // The primary may be the next player, still in a cancelled open: the load (and the
+                // commands behind it) wait for the loader instead of stalling the pump
+                if (player == &primaryPlayer || !nextLoader.isBusy()) runDeferredLoad();
+                break;
+            }
+            case Op::Preload:
+            {
+                cancelPreload();
+                if (msg.pathLength == 0) break;   // Empty path: cancel only
+
+                const auto path = juce::String::fromUTF8(msg.path, (int)msg.pathLength);
+
+                // The window belongs to the primary player, so video tracks take the regular load path
+                if (!headless && isVideoFile(path))
+                {
+                    LOG_INFO("Deck " + juce::String(slot) + ": not preloading video track " + path);
+                    break;
+                }
+
+                // Opened lazily by updateNextTrack(), shortly before it is due
+                nextPath = path;
+                nextPending = true;
+                nextTrackId = juce::jmax(1u, msg.sequence);
+                nextVolume = msg.volume;
+                nextRate = msg.rate;
+                nextFadeSeconds = msg.fadeSeconds;
+                nextFadeCurve = msg.fadeCurve;
+                nextGapSeconds = msg.gapSeconds;
+                break;
+            }
+            case Op::Play:
+                // Play resumes a paused wait; during a running one it skips the rest of it
+                if (waitPaused) waitPaused = false;
+                else if (waiting) gapFramesRemaining = juce::jmin(gapFramesRemaining, (int64_t)blockSize);
+                else { player->play(); restartDecodeStage(); }
+                break;
+            case Op::Pause:
+                finishSeekNow();
+                player->pause();
+                if (waiting || (nextArmed && player->hasFinished())) holdTrackEnd();
+                else rewindPreRoll();
+                transportState = EnginePlayState::Paused;
+                break;
+            case Op::Stop:
+                finishSeekNow();
+                player->stop(); rewindPreRoll(); pcmQueue.reset();
+                transportState = EnginePlayState::Stopped;
+                break;
+            case Op::Seek:   requestSeek(msg); break;
+            case Op::Volume: player->setVolume(msg.value); break;
+            case Op::Rate:   player->setRate(msg.value); playbackRate = msg.value; break;
+            case Op::ShowWindow:
+                juce::MessageManager::callAsync([win]() {
+                    if (win != nullptr) {
+                        if (win->isMinimised()) win->setMinimised(false);
+                        win->setVisible(true);
+                        win->toFront(true);
+                        LOG_INFO("show_window: Window shown and brought to front");
+                    }
+                });
+                break;
+            case Op::Quit:
+                // The plugin instance is going away: close its deck (the engine quits after the last one)
+                LOG_INFO("Deck " + juce::String(slot) + ": received quit command from plugin");
+                closeRequested = true;
+                break;
+            case Op::Heartbeat:
+            case Op::Invalid:
+            default:
+                break;
+        }
+    }
+
+    int slot = -1;
+    const bool headless;
+    SharedMemoryManager ipc;
+    // Current track and the preloaded next one. Loads always use the primary player,
+    // the only one bound to the video window; the two swap roles at a gapless switch.
+    SingleDeckPlayer primaryPlayer, secondaryPlayer;
+    SingleDeckPlayer* player = &primaryPlayer;
+    SingleDeckPlayer* nextPlayer = &secondaryPlayer;
+    std::unique_ptr<VideoWindow> videoWin;   // Declared after the players: destroyed first
+    NextTrackLoader nextLoader;               // Same: stopped before the player it may be opening goes
+    std::atomic<bool> closeRequested { false };
+
+    // Log events, written by the pump and read by the message thread
+    static constexpr int maxEvents = 32;
+    std::array<DeckEvent, maxEvents> events {};
+    juce::AbstractFifo eventFifo { maxEvents };
+
+    static constexpr juce::uint32 decodeStartGraceMs = 500;   // Player start-up: not counted as late
+
+    // Pump-thread state
+    juce::AudioBuffer<float> tempBuffer { 2, blockSize };
+    juce::AudioSourceChannelInfo info { &tempBuffer, 0, blockSize };
+    juce::AudioBuffer<float> fadeBuffer { 2, blockSize };            // Incoming track during a crossfade
+    juce::AudioSourceChannelInfo fadeInfo { &fadeBuffer, 0, blockSize };
+    DeckPcmQueue pcmQueue;                                      // Decode stage -> delivery stage
+    int prebufferMs = IPCConfig::EnginePrebufferMs;
+    int prebufferFrames = blockSize;                            // Decode stage limit at the current rate
+    int deliveryTargetFrames = wakeThresholdFrames + blockSize; // Delivery stage ring fill
+    juce::String jsonPath;
+
+    // Load waiting for the loader to give the primary player back (see runDeferredLoad)
+    bool loadDeferred = false;
+    juce::String loadPath;
+    float loadVolume = 1.0f, loadRate = 1.0f;
+    uint32_t loadSequence = 0;
+    juce::uint32 lastHeartbeatMs = 0, lastStatusMs = 0, lastRateCheckMs = 0;
+    uint32_t lastPluginBeat = 0;
+    juce::uint32 lastUnderruns = 0, lastDropped = 0;
+    uint32_t lastDecoderDropped = 0, lastDecoderLate = 0;
+    uint32_t decodeLateBlocks = 0;   // Decode stage ran dry short of the prebuffer (see countLateBlock)
+    bool decodePrimed = false;       // Prebuffer reached since the last start / splice
+    juce::uint32 decodeStartMs = 0;
+    int lastKnownRate = 44100;
+    uint32_t trackId = 0;                                       // Sequence of the last load, 0 = none
+    EnginePlayState transportState = EnginePlayState::Stopped;  // Reported while not playing / finished
+    float playbackRate = 1.0f;
+
+    // Next track (pump thread)
+    juce::String nextPath;
+    bool nextPending = false;    // Preload received, opened lazily
+    bool nextArmed = false;      // Opened on nextPlayer and taken over from nextLoader
+    bool nextStarted = false;    // Pre-roll running
+    bool crossfading = false;    // Both players mixed, fadePosition / fadeLength
+    bool waiting = false;        // Current track ended, gapFramesRemaining of silence before the next
+    bool waitPaused = false;     // Paused at the end of the track: wait / switch held until Play
+    uint32_t nextTrackId = 0;    // Sequence of the Preload, becomes trackId at the switch
+    float nextVolume = 1.0f, nextRate = 1.0f;
+    double nextFadeSeconds = 0.0;
+    IPCProtocol::FadeCurve nextFadeCurve = IPCProtocol::FadeCurve::EqualPower;
+    int fadePosition = 0, fadeLength = 0;
+
+    // Seek pipeline (pump thread)
+    bool seekPending = false;        // Target recorded, not yet issued to the player
+    bool seekInFlight = false;       // Issued, waiting for the player's pre-roll
+    bool seekTailReleased = false;   // Old audio's fade-out already let through (ring ran low)
+    bool spliceFadeIn = false;       // Fade in the next decoded block
+    float seekTarget = 0.0f;
+    uint64_t seekRequestUs = 0;
+    juce::uint32 seekIssuedMs = 0;
+    uint32_t seekCount = 0;
+    double seekLatencySumMs = 0.0, seekLatencyMaxMs = 0.0;
+    double nextGapSeconds = 0.0;
+    int64_t gapFramesRemaining = 0;
+
+    JUCE_DECLARE_NON_COPYABLE(EngineDeck)
+};
+
+// ==============================================================================
+// APPLICATION MAIN
+// ==============================================================================
+class PlaylistedEngineApplication : public juce::JUCEApplication, public juce::Thread, private juce::Timer
+{
+public:
+    PlaylistedEngineApplication() : Thread("AudioPumpThread") {}
+
+    const juce::String getApplicationName() override       { return "PlaylistedEngine"; }
+    const juce::String getApplicationVersion() override    { return "2.0.0"; }
+    bool moreThanOneInstanceAllowed() override             { return false; }
+    
+    void anotherInstanceStarted(const juce::String&) override
+    {
+        LOG_INFO("Another instance attempted to start - showing existing windows");
+        for (auto& deck : decks)
+            if (deck) deck->showWindow();
+    }
+
+    void initialise(const juce::String& commandLine) override
+    {
+        // Engine log next to the plugin's, written by the logger's background thread
+        AppLogger::getInstance().setFileName("Playlisted_Engine_Log");
+        logSession = std::make_unique<AppLogger::Session>();
+
+        const double initialiseMs = juce::Time::getMillisecondCounterHiRes();
+
+        // No video backend on Linux: always audio only there
+        #if JUCE_LINUX
+            headless = true;
+        #else
+            headless = commandLine.contains(IPCConfig::HeadlessFlag) || IPCConfig::useHeadlessEngine();
+        #endif
+        warm = commandLine.contains(IPCConfig::WarmFlag) || IPCConfig::useWarmEngine();
+
+        juce::String mode = "Multi Deck Mode";
+        if (headless) mode << ", headless";
+        if (warm) mode << ", warm";
+        LOG_INFO("=== Engine Process Started (" + mode + ") ===");
+
+        if (!control.open())
+        {
+            LOG_ERROR("FATAL: IPC control segment initialization failed!");
+            quit(); 
+            return;
+        }
+
+        control.setEngineRunning(true);
+        idleSinceMs = juce::Time::getMillisecondCounter();
+        const double controlMs = juce::Time::getMillisecondCounterHiRes();
+
+        const int staleRemoved = control.removeStaleSegments();
+        const double sweepMs = juce::Time::getMillisecondCounterHiRes();
+
+        LOG_INFO(rtProfile.lockProcessMemory());
+
+        // Pump first: decks opened by syncDecks() are served right away. run() applies the RT profile.
+        startThread(juce::Thread::Priority::highest);
+
+        // Handshake: plugins map their segment once the slot is Active, see openDeck()
+        const auto startupMs = (uint32_t)(juce::Time::getMillisecondCounterHiRes() - processStartMs);
+        control.setEngineReady(startupMs, warm);
+
+        LOG_INFO("Engine ready in " + juce::String((int)startupMs) + " ms (process start -> app "
+                 + juce::String(initialiseMs - processStartMs, 1) + " ms, control segment "
+                 + juce::String(controlMs - initialiseMs, 1) + " ms, removed "
+                 + juce::String(staleRemoved) + " stale segment(s) in "
+                 + juce::String(sweepMs - controlMs, 1) + " ms)");
+
+        // Decks are created from plugin requests on the message thread
+        syncDecks();
+        startTimer(registryIntervalMs);
+    }
+
+    void shutdown() override
+    {
+        LOG_INFO("Engine shutting down...");
+        stopTimer();
+        signalThreadShouldExit();
+        control.getDoorbell().ring();
+        stopThread(2000);
+
+        for (int i = 0; i < IPCConfig::MaxDecks; ++i)
+            if (decks[(size_t)i]) closeDeck(i);
+
+        spareDeck = nullptr;
+        control.setEngineRunning(false);
+        LOG_INFO("Engine shutdown complete");
+        logSession.reset();   // Joins the writer after the last batch
+    }
+
+    void run() override
+    {
+        const juce::uint32 statsIntervalMs = 10000;
+
+        // Playing decks need a pass every maxPlayingTimeoutMs; a pass takes well under a millisecond
+        LOG_INFO(rtProfile.applyToCurrentThread((double)EngineDeck::maxPlayingTimeoutMs, 2.0));
+
+        // Diagnostics: wakeups/sec and per-deck underruns, logged every statsIntervalMs
+        juce::uint32 lastStatsMs = juce::Time::getMillisecondCounter();
+        juce::uint32 lastWakeups = control.getEngineWakeups();
+
+        while (!threadShouldExit())
+        {
+            control.countEngineWakeup();
+            const auto now = juce::Time::getMillisecondCounter();
+            const double passStartMs = juce::Time::getMillisecondCounterHiRes();
+            int timeoutMs = EngineDeck::idleTimeoutMs;
+
+            {
+                const juce::ScopedLock sl(decksLock);
+
+                for (auto& deck : decks)
+                    if (deck && !deck->shouldClose())
+                        timeoutMs = juce::jmin(timeoutMs, deck->pump(now, commandBuffer, sizeof(commandBuffer)));
+
+                // Numbers only: timerCallback() writes them out once the message thread has the last report
+                if (now - lastStatsMs >= statsIntervalMs && !statsReportReady.load(std::memory_order_acquire))
+                {
+                    const auto wakeups = control.getEngineWakeups();
+                    statsReport.wakeupsPerSecond = (wakeups - lastWakeups) / ((now - lastStatsMs) / 1000.0);
+                    statsReport.deadlines = deadlineStats.takeSummary();
+                    statsReport.numDecks = 0;
+                    for (auto& deck : decks)
+                        if (deck) statsReport.decks[(size_t)statsReport.numDecks++] = deck->takeStats();
+                    statsReportReady.store(true, std::memory_order_release);
+
+                    lastStatsMs = now;
+                    lastWakeups = wakeups;
+                }
+            }
+
+            // Sleep until a plugin rings (audio consumed / command posted) or the earliest deck deadline
+            const auto seq = control.prepareWait();
+            bool moreWork = false;
+            {
+                const juce::ScopedLock sl(decksLock);
+                for (auto& deck : decks)
+                    if (deck && !deck->shouldClose() && deck->hasWork()) { moreWork = true; break; }
+            }
+            const double sleepStartMs = juce::Time::getMillisecondCounterHiRes();
+            deadlineStats.addWork(sleepStartMs - passStartMs);
+
+            const int sleepMs = moreWork ? 0 : timeoutMs;
+            const bool rung = control.waitForWork(seq, sleepMs);
+
+            // Only timed-out sleeps have a deadline to be late for
+            if (!rung && sleepMs > 0)
+                deadlineStats.addWakeup(juce::Time::getMillisecondCounterHiRes() - (sleepStartMs + sleepMs));
+        }
+    }
+
+private:
+    static constexpr int registryIntervalMs = 50;
+    static constexpr juce::uint32 lastDeckGraceMs = 1000;     // Quit this long after the last deck closed
+    static constexpr juce::uint32 startupGraceMs = 10 * 1000; // ...or if no plugin registers at all
+
+    void timerCallback() override
+    {
+        control.touchEngine();
+        syncDecks();
+
+        for (auto& deck : decks)
+        {
+            if (deck == nullptr) continue;
+            deck->applyAvCorrections();
+            deck->logEvents();
+        }
+        logPumpStats();
+
+        bool anyDeck = false;
+        for (auto& deck : decks) anyDeck = anyDeck || deck != nullptr;
+
+        const auto now = juce::Time::getMillisecondCounter();
+        if (anyDeck || control.getNumClaimedDecks() > 0)
+        {
+            idleSinceMs = now;
+            hadDeck = hadDeck || anyDeck;
+        }
+        else if (getIdleGraceMs() > 0 && now - idleSinceMs > getIdleGraceMs())
+        {
+            LOG_INFO("No decks left - quitting engine");
+            stopTimer();
+            quit();
+            return;
+        }
+
+        // Warm: rebuild the spare between requests, never while one is waiting
+        if (warm && spareDeck == nullptr && control.getNumRequestedDecks() == 0)
+            prepareSpareDeck();
+    }
+
+    // 0 = stay up (warm engine without an idle limit)
+    juce::uint32 getIdleGraceMs() const
+    {
+        if (warm) return (juce::uint32)juce::jmax(0, IPCConfig::getWarmIdleSeconds()) * 1000;
+        return hadDeck ? lastDeckGraceMs : startupGraceMs;
+    }
+
+    // Message thread: players initialised ahead of the next deck request
+    void prepareSpareDeck()
+    {
+        const double startMs = juce::Time::getMillisecondCounterHiRes();
+        spareDeck = std::make_unique<EngineDeck>(control.getDoorbell(), headless);
+        LOG_INFO("Warm: spare deck ready in " + juce::String(juce::Time::getMillisecondCounterHiRes() - startMs, 1) + " ms");
+    }
+
+    // Message thread: follow the registry
+    // Message thread: the pump's latest stats interval, if it posted one
+    void logPumpStats()
+    {
+        if (!statsReportReady.load(std::memory_order_acquire)) return;
+
+        juce::String text = "Pump stats: " + juce::String(statsReport.wakeupsPerSecond, 1) + " wakeups/s, "
+                          + statsReport.deadlines.toString();
+        for (int i = 0; i < statsReport.numDecks; ++i)
+            text << "; " << statsReport.decks[(size_t)i].toString();
+
+        statsReportReady.store(false, std::memory_order_release);
+        LOG_INFO(text);
+    }
+
+    void syncDecks()
+    {
+        for (int i = 0; i < IPCConfig::MaxDecks; ++i)
+        {
+            const auto state = control.getDeckState(i);
+            auto& deck = decks[(size_t)i];
+
+            if (deck != nullptr)
+            {
+                if (deck->shouldClose() || state == DeckState::Released || state == DeckState::Free)
+                    closeDeck(i);
+            }
+            else if (state == DeckState::Requested)
+            {
+                openDeck(i);
+            }
+            else if (state == DeckState::Released)
+            {
+                control.freeDeck(i);
+            }
+        }
+    }
+
+    void openDeck(int index)
+    {
+        juce::String segmentName;
+        IPCConfig::AudioFormat format;
+
+        if (!control.readDeckRequest(index, segmentName, format))
+        {
+            LOG_INFO("Deck " + juce::String(index) + ": invalid request, slot freed");
+            control.freeDeck(index);
+            return;
+        }
+
+        const double startMs = juce::Time::getMillisecondCounterHiRes();
+
+        // Warm: the players are already initialised
+        const bool fromSpare = spareDeck != nullptr;
+        auto deck = fromSpare ? std::move(spareDeck) : std::make_unique<EngineDeck>(control.getDoorbell(), headless);
+        const double playersMs = juce::Time::getMillisecondCounterHiRes();
+
+        if (!deck->open(index, segmentName, format))
+        {
+            LOG_ERROR("Deck " + juce::String(index) + ": IPC initialization failed for " + segmentName);
+            control.freeDeck(index);
+            return;
+        }
+
+        const double openMs = juce::Time::getMillisecondCounterHiRes() - startMs;
+        LOG_INFO("Deck " + juce::String(index) + " open in " + juce::String(openMs, 1) + " ms (players "
+                 + (fromSpare ? juce::String("from spare") : juce::String(playersMs - startMs, 1) + " ms")
+                 + ", segment + window " + juce::String(openMs - (playersMs - startMs), 1) + " ms)");
+
+        if (!control.activateDeck(index, (uint32_t)std::ceil(openMs)))
+        {
+            // Plugin went away while we were setting up (the deck removes its segment)
+            deck = nullptr;
+            control.freeDeck(index);
+            return;
+        }
+
+        const juce::ScopedLock sl(decksLock);
+        decks[(size_t)index] = std::move(deck);
+    }
+
+    void closeDeck(int index)
+    {
+        std::unique_ptr<EngineDeck> deck;
+        {
+            const juce::ScopedLock sl(decksLock);
+            deck = std::move(decks[(size_t)index]);
+        }
+        if (deck == nullptr) return;
+
+        deck->logEvents();
+        deck = nullptr;   // Window, player and segment
+        control.freeDeck(index);
+        LOG_INFO("Deck " + juce::String(index) + " closed");
+    }
+
+    EngineControl control { EngineControl::Mode::Engine_Server };
+
+    // Owned and (de)allocated by the message thread; the pump holds decksLock while it uses them
+    std::array<std::unique_ptr<EngineDeck>, IPCConfig::MaxDecks> decks;
+    juce::CriticalSection decksLock;
+
+    juce::uint32 idleSinceMs = 0;
+    bool hadDeck = false;
+    bool headless = false;   // Audio only: no video windows, no video decoding
+    bool warm = false;       // Stay up without decks, keep spareDeck ready
+    std::unique_ptr<EngineDeck> spareDeck;   // Warm only: constructed, not yet open()ed
+    std::unique_ptr<AppLogger::Session> logSession;
+
+    const RealtimeProfile rtProfile = RealtimeProfile::fromEnvironment();
+    PumpDeadlineStats deadlineStats;   // Pump thread only
+
+    // Pump -> message thread, one report at a time: the pump fills it while statsReportReady is
+    // false, logPumpStats() writes it out and clears the flag
+    struct PumpStatsReport
+    {
+        double wakeupsPerSecond = 0.0;
+        PumpDeadlineStats::Summary deadlines;
+        std::array<EngineDeck::Stats, IPCConfig::MaxDecks> decks;
+        int numDecks = 0;
+    };
+    PumpStatsReport statsReport;
+    std::atomic<bool> statsReportReady { false };
+
+    // Pump-thread scratch space, preallocated so reading a command never allocates
+    char commandBuffer[IPCConfig::CommandBufferSize];
 };
 START_JUCE_APPLICATION(PlaylistedEngineApplication)
@@ -0,0 +1,254 @@
+/*
+  ==============================================================================
+
+    CommandProtocol.h
+    Playlisted2
+
+    Compact binary plugin -> engine command format.
+    Every message is a fixed 24-byte header followed by a typed payload:
+
+        [magic u16][version u8][flags u8][opcode u16][payloadSize u16]
+        [sequence u32][reserved u32][timestampUs u64]  payload...
+
+    Load and Preload carry the UTF-8 path as a length-prefixed blob. Encoding writes
+    into a caller-provided buffer and decoding returns a view into the
+    received bytes, so neither side allocates. Both processes run on the
+    same machine, so fields are in host byte order.
+
+    Any message that does not start with Magic is treated as legacy JSON text
+    (debug fallback, see IPCConfig::useJsonCommands).
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+
+namespace IPCProtocol
+{
+    static const uint16_t Magic = 0x4350;   // 'PC'
+    static const uint8_t Version = 3;   // v2: LoadPayload carries the crossfade, v3: and the wait
+
+    enum class Opcode : uint16_t
+    {
+        Invalid = 0,
+        Load,
+        Play,
+        Pause,
+        Stop,
+        Seek,         // FloatPayload: normalised position
+        Volume,       // FloatPayload: linear gain
+        Rate,         // FloatPayload: playback speed
+        ShowWindow,
+        Quit,
+        Heartbeat,    // Legacy: liveness is SharedMemoryManager's heartbeat counter now
+        Preload       // LoadPayload: next track, spliced in / crossfaded / started after a wait (empty path cancels)
+    };
+
+    // Gain curves for crossfading into a preloaded track
+    enum class FadeCurve : uint16_t
+    {
+        EqualPower = 0,   // cos / sin - constant power, for unrelated material
+        Linear,           // Constant gain, dips ~3 dB mid-fade on unrelated material
+        SCurve,           // Raised cosine, constant gain with soft start and end
+        NumCurves
+    };
+
+    struct MessageHeader
+    {
+        uint16_t magic;
+        uint8_t version;
+        uint8_t flags;
+        uint16_t opcode;
+        uint16_t payloadSize;
+        uint32_t sequence;
+        uint32_t reserved;
+        uint64_t timestampUs;
+    };
+    static_assert(sizeof(MessageHeader) == 24, "MessageHeader must stay packed");
+
+    struct LoadPayload
+    {
+        float volume;
+        float rate;
+        float fadeSeconds;     // Preload: crossfade length, 0 = gapless splice
+        uint16_t fadeCurve;    // Preload: FadeCurve
+        uint16_t reserved;
+        float gapSeconds;      // Preload: silence between the tracks, counted on the engine's sample clock
+        uint32_t pathLength;   // Bytes of UTF-8 path that follow, no terminator
+    };
+
+    struct FloatPayload
+    {
+        float value;
+    };
+
+    // Decoded view. path points into the received buffer and is NOT null-terminated.
+    struct Message
+    {
+        Opcode opcode = Opcode::Invalid;
+        uint32_t sequence = 0;
+        uint64_t timestampUs = 0;
+        float value = 0.0f;              // Seek / Volume / Rate
+        float volume = 1.0f;             // Load / Preload
+        float rate = 1.0f;               // Load / Preload
+        const char* path = nullptr;      // Load / Preload
+        uint32_t pathLength = 0;         // Load / Preload
+        float fadeSeconds = 0.0f;        // Preload
+        FadeCurve fadeCurve = FadeCurve::EqualPower;   // Preload
+        float gapSeconds = 0.0f;         // Preload
+    };
+
+    // Monotonic clock shared by both processes on the same machine
+    inline uint64_t nowMicros()
+    {
+        using namespace std::chrono;
+        return (uint64_t)duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+    }
+
+    inline const char* getOpcodeName(Opcode op)
+    {
+        switch (op)
+        {
+            case Opcode::Load:       return "load";
+            case Opcode::Play:       return "play";
+            case Opcode::Pause:      return "pause";
+            case Opcode::Stop:       return "stop";
+            case Opcode::Seek:       return "seek";
+            case Opcode::Volume:     return "volume";
+            case Opcode::Rate:       return "rate";
+            case Opcode::ShowWindow: return "show_window";
+            case Opcode::Quit:       return "quit";
+            case Opcode::Heartbeat:  return "heartbeat";
+            case Opcode::Preload:    return "preload";
+            case Opcode::Invalid:
+            default:                 return "invalid";
+        }
+    }
+
+    // ==============================================================================
+    // ENCODING (return bytes written, 0 if the buffer is too small)
+    // ==============================================================================
+
+    inline size_t writeHeader(char* dst, size_t capacity, Opcode op, size_t payloadSize, uint32_t sequence)
+    {
+        if (payloadSize > 0xFFFF || capacity < sizeof(MessageHeader) + payloadSize) return 0;
+
+        MessageHeader h {};
+        h.magic = Magic;
+        h.version = Version;
+        h.opcode = (uint16_t)op;
+        h.payloadSize = (uint16_t)payloadSize;
+        h.sequence = sequence;
+        h.timestampUs = nowMicros();
+        std::memcpy(dst, &h, sizeof(h));
+        return sizeof(h);
+    }
+
+    inline size_t encode(char* dst, size_t capacity, Opcode op, uint32_t sequence)
+    {
+        return writeHeader(dst, capacity, op, 0, sequence);
+    }
+
+    inline size_t encodeFloat(char* dst, size_t capacity, Opcode op, uint32_t sequence, float value)
+    {
+        const size_t headerSize = writeHeader(dst, capacity, op, sizeof(FloatPayload), sequence);
+        if (headerSize == 0) return 0;
+
+        FloatPayload p { value };
+        std::memcpy(dst + headerSize, &p, sizeof(p));
+        return headerSize + sizeof(p);
+    }
+
+    // Load / Preload
+    inline size_t encodeLoad(char* dst, size_t capacity, uint32_t sequence,
+                             const char* utf8Path, size_t pathLength, float volume, float rate,
+                             Opcode op = Opcode::Load,
+                             float fadeSeconds = 0.0f, FadeCurve fadeCurve = FadeCurve::EqualPower,
+                             float gapSeconds = 0.0f)
+    {
+        const size_t payloadSize = sizeof(LoadPayload) + pathLength;
+        const size_t headerSize = writeHeader(dst, capacity, op, payloadSize, sequence);
+        if (headerSize == 0) return 0;
+
+        LoadPayload p { volume, rate, fadeSeconds, (uint16_t)fadeCurve, 0, gapSeconds, (uint32_t)pathLength };
+        std::memcpy(dst + headerSize, &p, sizeof(p));
+        if (pathLength > 0)
+            std::memcpy(dst + headerSize + sizeof(p), utf8Path, pathLength);
+        return headerSize + payloadSize;
+    }
+
+    // ==============================================================================
+    // DECODING
+    // ==============================================================================
+
+    inline bool isBinary(const void* data, size_t size)
+    {
+        if (size < sizeof(uint16_t)) return false;
+        uint16_t magic;
+        std::memcpy(&magic, data, sizeof(magic));
+        return magic == Magic;
+    }
+
+    inline bool decode(const void* data, size_t size, Message& out)
+    {
+        if (size < sizeof(MessageHeader)) return false;
+
+        MessageHeader h;
+        std::memcpy(&h, data, sizeof(h));
+        if (h.magic != Magic || h.version != Version) return false;
+        if (sizeof(MessageHeader) + h.payloadSize > size) return false;
+
+        const char* payload = static_cast<const char*>(data) + sizeof(MessageHeader);
+
+        out = Message();
+        out.opcode = (Opcode)h.opcode;
+        out.sequence = h.sequence;
+        out.timestampUs = h.timestampUs;
+
+        switch (out.opcode)
+        {
+            case Opcode::Load:
+            case Opcode::Preload:
+            {
+                if (h.payloadSize < sizeof(LoadPayload)) return false;
+                LoadPayload p;
+                std::memcpy(&p, payload, sizeof(p));
+                if (sizeof(LoadPayload) + (size_t)p.pathLength > h.payloadSize) return false;
+                out.volume = p.volume;
+                out.rate = p.rate;
+                out.fadeSeconds = p.fadeSeconds > 0.0f ? p.fadeSeconds : 0.0f;
+                out.fadeCurve = p.fadeCurve < (uint16_t)FadeCurve::NumCurves ? (FadeCurve)p.fadeCurve : FadeCurve::EqualPower;
+                out.gapSeconds = p.gapSeconds > 0.0f ? p.gapSeconds : 0.0f;
+                out.path = payload + sizeof(LoadPayload);
+                out.pathLength = p.pathLength;
+                return true;
+            }
+
+            case Opcode::Seek:
+            case Opcode::Volume:
+            case Opcode::Rate:
+            {
+                if (h.payloadSize < sizeof(FloatPayload)) return false;
+                FloatPayload p;
+                std::memcpy(&p, payload, sizeof(p));
+                out.value = p.value;
+                return true;
+            }
+
+            case Opcode::Play:
+            case Opcode::Pause:
+            case Opcode::Stop:
+            case Opcode::ShowWindow:
+            case Opcode::Quit:
+            case Opcode::Heartbeat:
+                return true;
+
+            case Opcode::Invalid:
+            default:
+                return false;
+        }
+    }
+}
@@ -0,0 +1,271 @@
+/*
+  ==============================================================================
+
+    DriftCompensator.h
+    Playlisted2
+
+    Plugin-side clock-drift compensation for the IPC audio ring.
+
+    The engine produces at VLC's / the system clock, the plugin consumes at
+    the audio device clock. The two never agree exactly, so over a long set
+    the ring slowly fills up (latency grows) or runs dry (dropouts).
+
+    Instead of reading exactly one DAW block per callback, the plugin reads
+    through a small fractional resampler whose ratio is steered by a PI
+    loop on the buffered amount:
+
+        error = smoothed fill - target fill          (seconds)
+        ratio = 1 + Kp * error + Ki * integral(error) (clamped to +/- MaxRatioDeviation)
+
+    ratio > 1 consumes slightly faster than real time, < 1 slightly slower.
+    The integral term settles on the actual clock ratio, so in steady state
+    the fill sits at the target and the ratio only moves very slowly.
+
+    - Start / after an underrun: silence until the ring holds the target fill
+      (priming), then play. The loop state survives, so it re-locks instantly.
+    - Fill far above target (plugin stalled, engine burst): skip the excess in
+      one go (resync) instead of creeping back at a fraction of a percent.
+    - 4-point Hermite interpolation; ratio and fill error are published as
+      atomics for the UI / diagnostics.
+
+    Deliberately free of JUCE. The source only needs
+        int getAudioFramesReady()
+        int readAudio(float* const* dest, int numChannels, int numFrames)
+        int discardAudio(int numFrames)
+    which SharedMemoryManager provides.
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+
+class DriftCompensator
+{
+public:
+    static constexpr int MaxChannels = 8;
+
+    // Largest speed correction; real clock pairs differ by well under 200 ppm
+    static constexpr double MaxRatioDeviation = 0.001;
+
+    // Loop bandwidth - slow enough that engine block jitter never reaches the pitch
+    static constexpr double LoopBandwidthHz = 0.005;
+    static constexpr double LoopDamping = 0.7;
+
+    // Fill measurement low-pass (engine pushes in blocks, the DAW pulls in blocks)
+    static constexpr double FillSmoothingSeconds = 1.0;
+
+    // Skip ahead once the smoothed fill exceeds the target by this much (and at least by the target itself)
+    static constexpr double ResyncThresholdSeconds = 0.25;
+
+    struct Result
+    {
+        int framesProduced = 0;   // Frames of real audio written to out (the rest is silence)
+        bool priming = false;     // Waiting for the target fill, nothing consumed
+        bool underrun = false;    // Ran dry mid-block
+        bool resynced = false;    // Excess fill was skipped
+    };
+
+    DriftCompensator() = default;
+
+    // Not real-time safe (allocates). Call from prepareToPlay.
+    void prepare(int numChannelsToUse, int maxBlockSize, double newSampleRate, int targetFillFrames)
+    {
+        numChannels = std::clamp(numChannelsToUse, 1, MaxChannels);
+        maxBlock = std::max(1, maxBlockSize);
+        sampleRate = newSampleRate > 0.0 ? newSampleRate : 44100.0;
+        targetFill = std::max(1, targetFillFrames);
+
+        // One output block at the fastest ratio plus the interpolator's neighbours
+        inputCapacity = (int)std::ceil(maxBlock * (1.0 + MaxRatioDeviation)) + 8;
+        for (int ch = 0; ch < numChannels; ++ch)
+            input[ch].assign((size_t)inputCapacity, 0.0f);
+
+        const double omega = 2.0 * 3.14159265358979323846 * LoopBandwidthHz;
+        kp = 2.0 * LoopDamping * omega;
+        ki = omega * omega;
+
+        reset();
+    }
+
+    // Forgets buffered audio and the loop state (new device, sample rate or flushed ring)
+    void reset()
+    {
+        for (int ch = 0; ch < numChannels; ++ch)
+            std::fill(input[ch].begin(), input[ch].end(), 0.0f);
+
+        inputCount = 1;   // One frame of silence as the interpolator's left neighbour
+        readPos = 1.0;
+        integral = 0.0;
+        currentRatio = 1.0;
+        smoothedFill = (double)targetFill;
+        priming = true;
+
+        ratio.store(1.0, std::memory_order_relaxed);
+        fillErrorFrames.store(0.0f, std::memory_order_relaxed);
+    }
+
+    // Renders numOut frames into out[0..numOutChannels). Real-time safe.
+    template <typename Source>
+    Result process(Source& source, float* const* out, int numOutChannels, int numOut)
+    {
+        Result result;
+        if (numOut <= 0) return result;
+
+        const int ringFill = source.getAudioFramesReady();
+        double buffered = (double)ringFill + ((double)inputCount - readPos);
+
+        if (priming)
+        {
+            if (ringFill < targetFill)
+            {
+                clear(out, numOutChannels, 0, numOut);
+                result.priming = true;
+                return result;
+            }
+            priming = false;
+            smoothedFill = buffered;
+        }
+
+        const double blockSeconds = numOut / sampleRate;
+        smoothedFill += (buffered - smoothedFill) * (1.0 - std::exp(-blockSeconds / FillSmoothingSeconds));
+
+        const double resyncFrames = std::max((double)targetFill, ResyncThresholdSeconds * sampleRate);
+        if (smoothedFill - targetFill > resyncFrames)
+        {
+            const int skipped = source.discardAudio((int)(buffered - targetFill));
+            buffered -= skipped;
+            smoothedFill = buffered;
+            resyncs.fetch_add(1, std::memory_order_relaxed);
+            result.resynced = true;
+        }
+
+        updateRatio((smoothedFill - targetFill) / sampleRate, blockSeconds);
+
+        // Hosts may exceed the prepared block size - render in chunks the input buffer can hold
+        while (result.framesProduced < numOut)
+        {
+            const int chunk = std::min(numOut - result.framesProduced, maxBlock);
+            const int produced = renderChunk(source, out, numOutChannels, result.framesProduced, chunk);
+            result.framesProduced += produced;
+            if (produced < chunk) break;
+        }
+
+        if (result.framesProduced < numOut)
+        {
+            clear(out, numOutChannels, result.framesProduced, numOut - result.framesProduced);
+            underruns.fetch_add(1, std::memory_order_relaxed);
+            result.underrun = true;
+            priming = true;
+        }
+
+        return result;
+    }
+
+    // Thread-safe getters for UI / diagnostics
+    double getRatio() const              { return ratio.load(std::memory_order_relaxed); }
+    float getFillErrorFrames() const     { return fillErrorFrames.load(std::memory_order_relaxed); }
+    int getTargetFillFrames() const      { return targetFill; }
+    uint32_t getUnderrunCount() const    { return underruns.load(std::memory_order_relaxed); }
+    uint32_t getResyncCount() const      { return resyncs.load(std::memory_order_relaxed); }
+
+private:
+    void updateRatio(double errorSeconds, double blockSeconds)
+    {
+        integral = std::clamp(integral + ki * errorSeconds * blockSeconds, -MaxRatioDeviation, MaxRatioDeviation);
+        const double correction = std::clamp(kp * errorSeconds + integral, -MaxRatioDeviation, MaxRatioDeviation);
+
+        currentRatio = 1.0 + correction;
+        ratio.store(currentRatio, std::memory_order_relaxed);
+        fillErrorFrames.store((float)(errorSeconds * sampleRate), std::memory_order_relaxed);
+    }
+
+    template <typename Source>
+    int renderChunk(Source& source, float* const* out, int numOutChannels, int outOffset, int numFrames)
+    {
+        // Hermite at position p reads frames floor(p)-1 .. floor(p)+2
+        const int needed = std::min((int)(readPos + (numFrames - 1) * currentRatio) + 3, inputCapacity);
+        if (needed > inputCount)
+        {
+            float* dest[MaxChannels];
+            for (int ch = 0; ch < numChannels; ++ch)
+                dest[ch] = input[ch].data() + inputCount;
+
+            inputCount += source.readAudio(dest, numChannels, needed - inputCount);
+        }
+
+        int produced = 0;
+        double pos = readPos;
+        while (produced < numFrames)
+        {
+            const int index = (int)pos;
+            if (index + 2 >= inputCount) break;
+
+            const float frac = (float)(pos - index);
+            for (int ch = 0; ch < numOutChannels; ++ch)
+            {
+                if (out[ch] == nullptr) continue;
+                const float* x = input[std::min(ch, numChannels - 1)].data() + index;
+                out[ch][outOffset + produced] = hermite(x[-1], x[0], x[1], x[2], frac);
+            }
+
+            pos += currentRatio;
+            ++produced;
+        }
+        readPos = pos;
+
+        // Keep the left neighbour of the next read position, drop everything before it
+        const int keepFrom = std::max(0, (int)readPos - 1);
+        if (keepFrom > 0)
+        {
+            const int remaining = inputCount - keepFrom;
+            for (int ch = 0; ch < numChannels; ++ch)
+                std::memmove(input[ch].data(), input[ch].data() + keepFrom, (size_t)remaining * sizeof(float));
+            inputCount = remaining;
+            readPos -= keepFrom;
+        }
+
+        return produced;
+    }
+
+    static float hermite(float xm1, float x0, float x1, float x2, float t) noexcept
+    {
+        const float c1 = 0.5f * (x1 - xm1);
+        const float c2 = xm1 - 2.5f * x0 + 2.0f * x1 - 0.5f * x2;
+        const float c3 = 0.5f * (x2 - xm1) + 1.5f * (x0 - x1);
+        return ((c3 * t + c2) * t + c1) * t + x0;
+    }
+
+    static void clear(float* const* dest, int numDestChannels, int offset, int numFrames) noexcept
+    {
+        for (int ch = 0; ch < numDestChannels; ++ch)
+            if (dest[ch] != nullptr)
+                std::memset(dest[ch] + offset, 0, (size_t)numFrames * sizeof(float));
+    }
+
+    int numChannels = 2;
+    int maxBlock = 512;
+    double sampleRate = 44100.0;
+    int targetFill = 4096;
+
+    std::vector<float> input[MaxChannels];
+    int inputCapacity = 0;
+    int inputCount = 1;
+    double readPos = 1.0;
+
+    double kp = 0.0, ki = 0.0;
+    double integral = 0.0;
+    double smoothedFill = 0.0;
+    double currentRatio = 1.0;
+    bool priming = true;
+
+    std::atomic<double> ratio { 1.0 };
+    std::atomic<float> fillErrorFrames { 0.0f };
+    std::atomic<uint32_t> underruns { 0 };
+    std::atomic<uint32_t> resyncs { 0 };
+};
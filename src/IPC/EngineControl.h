@@ -0,0 +1,385 @@
+/*
+  ==============================================================================
+
+    EngineControl.h
+    Playlisted2
+
+    Small control segment shared by the engine and every plugin instance.
+    - Deck registry: each plugin instance claims a slot and names its own
+      SharedMemoryManager segment there. The engine picks the request up,
+      creates the segment and a deck for it, and marks the slot Active.
+    - The engine-wide doorbell, so one pump thread sleeps for all decks.
+    - Engine liveness (flag + heartbeat timestamp), so a new plugin instance
+      attaches to a running engine instead of launching another one.
+    - Readiness handshake: the engine raises engineReady once it serves
+      deck requests, and a slot only turns Active after its deck (segment,
+      players) is fully open, so the plugin maps its segment exactly once
+      instead of retrying. Both sides publish how long they took.
+    - Warm engine (--warm / PLAYLISTED_ENGINE_WARM=1): stays up without
+      decks and keeps a spare deck with initialised players, so the next
+      instance attaches without waiting for the media backend.
+
+    Slot lifecycle:
+        Free -> Claiming -> Requested   (plugin)
+        Requested -> Active             (engine, deck created)
+        Requested/Active -> Released    (plugin, instance going away)
+        Released/Active -> Free         (engine, deck destroyed)
+
+    A zero-filled segment is a valid empty registry, so whichever side comes
+    first creates it. The engine sweeps orphaned deck segments (and legacy
+    temp-dir files) when it starts, see removeStaleSegments().
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <juce_core/juce_core.h>
+#include "SharedMemoryManager.h"
+
+namespace IPCConfig
+{
+    static const char* ControlSegmentName = "Playlisted2_Control_v10";
+    static const uint32_t ControlMagic = 0x504C3243;   // 'PL2C'
+    static const int MaxDecks = 16;
+    static const int SegmentNameLength = 64;
+
+    // Engine counts as alive if it stamped its heartbeat within this window
+    static const int EngineAliveTimeoutMs = 3000;
+
+    // Warm engine: pre-spawned / kept alive with a pre-initialised spare deck.
+    // The engine takes the launch flag; PLAYLISTED_ENGINE_WARM=1 makes the plugin pass it.
+    static constexpr const char* WarmFlag = "--warm";
+
+    inline bool useWarmEngine()
+    {
+        return juce::SystemStats::getEnvironmentVariable("PLAYLISTED_ENGINE_WARM", {}).getIntValue() != 0;
+    }
+
+    // How long a warm engine waits without decks before quitting (0 = until the session ends)
+    inline int getWarmIdleSeconds()
+    {
+        return juce::SystemStats::getEnvironmentVariable("PLAYLISTED_ENGINE_WARM_IDLE_SECONDS", "600").getIntValue();
+    }
+
+    inline juce::String makeDeckSegmentName(const juce::String& instanceId)
+    {
+        return juce::String(DeckSegmentPrefix) + instanceId;
+    }
+}
+
+enum class DeckState : uint32_t
+{
+    Free = 0,
+    Claiming,
+    Requested,
+    Active,
+    Released
+};
+
+struct DeckSlot
+{
+    alignas(IPCConfig::CacheLineSize) std::atomic<uint32_t> state { 0 };
+    uint32_t ringFrames = 0;
+    uint32_t numChannels = 0;
+    uint32_t openMs = 0;   // Engine: time it took to open the deck, written before Active (release)
+    char segmentName[IPCConfig::SegmentNameLength] = {};
+};
+
+struct EngineControlLayout
+{
+    alignas(IPCConfig::CacheLineSize) std::atomic<uint32_t> magic { 0 };
+    uint32_t layoutVersion = 0;
+    uint32_t layoutSize = 0;
+
+    // --- ENGINE (engine writes) ---
+    alignas(IPCConfig::CacheLineSize) std::atomic<uint32_t> engineRunning { 0 };
+    std::atomic<uint32_t> engineGeneration { 0 };   // Bumped by every engine start
+    std::atomic<uint64_t> engineHeartbeatUs { 0 };  // IPCProtocol::nowMicros()
+    std::atomic<uint32_t> engineReady { 0 };        // Initialised and serving deck requests
+    uint32_t engineStartupMs = 0;                   // Process start -> ready, written before engineReady (release)
+    uint32_t engineWarm = 0;                        // Started with --warm
+
+    // --- DOORBELL (plugins ring, engine sleeps on it) ---
+    alignas(IPCConfig::CacheLineSize) std::atomic<uint32_t> doorbellSequence { 0 };
+    std::atomic<uint32_t> engineWaiting { 0 };
+    std::atomic<uint32_t> engineWakeups { 0 };      // Pump loop iterations, for diagnostics
+
+    DeckSlot decks[IPCConfig::MaxDecks];
+};
+
+class EngineControl
+{
+public:
+    using Mode = SharedMemoryManager::Mode;
+
+    explicit EngineControl(Mode mode) : currentMode(mode) {}
+
+    ~EngineControl()
+    {
+        doorbell.close();
+        layout = nullptr;
+        segment.close();
+    }
+
+    bool open()
+    {
+        if (layout != nullptr) return true;
+
+        const auto size = sizeof(EngineControlLayout);
+
+        // Never recreated: plugins and the engine may attach in any order
+        if (!segment.openOrCreate(IPCConfig::ControlSegmentName, size)) return false;
+
+        auto* mapped = static_cast<EngineControlLayout*>(segment.getData());
+
+        if (mapped->magic.load(std::memory_order_acquire) == 0)
+        {
+            // Fresh segment. Both sides write identical values, so a race here is harmless.
+            mapped->layoutVersion = IPCConfig::LayoutVersion;
+            mapped->layoutSize = (uint32_t)sizeof(EngineControlLayout);
+            mapped->magic.store(IPCConfig::ControlMagic, std::memory_order_release);
+        }
+        else if (mapped->magic.load(std::memory_order_acquire) != IPCConfig::ControlMagic
+                 || mapped->layoutVersion != IPCConfig::LayoutVersion
+                 || mapped->layoutSize != (uint32_t)sizeof(EngineControlLayout))
+        {
+            segment.close();
+            return false;
+        }
+
+        layout = mapped;
+
+        if (currentMode == Mode::Engine_Server)
+            recoverSlots();
+
+        // Without the OS object we still work, the engine just falls back to its deadlines
+        doorbell.open(IPCConfig::DoorbellName, &layout->doorbellSequence, &layout->engineWaiting,
+                      currentMode == Mode::Engine_Server);
+        return true;
+    }
+
+    bool isOpen() const { return layout != nullptr; }
+    IPCDoorbell& getDoorbell() { return doorbell; }
+
+    // ==============================================================================
+    // PLUGIN SIDE
+    // ==============================================================================
+
+    // Returns the slot index, or -1 if every slot is taken
+    int claimDeck(const juce::String& segmentName, const IPCConfig::AudioFormat& format)
+    {
+        if (!layout) return -1;
+
+        for (int i = 0; i < IPCConfig::MaxDecks; ++i)
+        {
+            auto& slot = layout->decks[i];
+            uint32_t expected = (uint32_t)DeckState::Free;
+            if (!slot.state.compare_exchange_strong(expected, (uint32_t)DeckState::Claiming, std::memory_order_acq_rel))
+                continue;
+
+            slot.ringFrames = (uint32_t)format.ringFrames;
+            slot.numChannels = (uint32_t)format.numChannels;
+            std::memset(slot.segmentName, 0, sizeof(slot.segmentName));
+            segmentName.copyToUTF8(slot.segmentName, sizeof(slot.segmentName));
+
+            slot.state.store((uint32_t)DeckState::Requested, std::memory_order_release);
+            doorbell.ring();
+            return i;
+        }
+        return -1;
+    }
+
+    void releaseDeck(int index)
+    {
+        if (!layout || !isValidIndex(index)) return;
+        layout->decks[index].state.store((uint32_t)DeckState::Released, std::memory_order_release);
+        doorbell.ring();
+    }
+
+    // False once the engine freed the slot (or someone else claimed it) - the instance must claim again
+    bool isDeckOwnedBy(int index, const juce::String& segmentName) const
+    {
+        if (!layout || !isValidIndex(index)) return false;
+        const auto state = getDeckState(index);
+        if (state != DeckState::Requested && state != DeckState::Active) return false;
+        return std::strncmp(segmentName.toRawUTF8(), layout->decks[index].segmentName, sizeof(DeckSlot::segmentName)) == 0;
+    }
+
+    bool isEngineAlive() const
+    {
+        if (!layout || layout->engineRunning.load(std::memory_order_acquire) == 0) return false;
+        const auto ageUs = IPCProtocol::nowMicros() - layout->engineHeartbeatUs.load(std::memory_order_relaxed);
+        return ageUs < (uint64_t)IPCConfig::EngineAliveTimeoutMs * 1000;
+    }
+
+    // Alive and done initialising: deck requests are being served
+    bool isEngineReady() const
+    {
+        return isEngineAlive() && layout->engineReady.load(std::memory_order_acquire) != 0;
+    }
+
+    // Valid once isEngineReady()
+    uint32_t getEngineStartupMs() const { return layout ? layout->engineStartupMs : 0; }
+    bool isEngineWarm() const           { return layout && layout->engineWarm != 0; }
+
+    // Our deck is open in the engine: its segment can be mapped now
+    bool isDeckActive(int index, const juce::String& segmentName) const
+    {
+        return isDeckOwnedBy(index, segmentName) && getDeckState(index) == DeckState::Active;
+    }
+
+    // Valid once the deck is Active
+    uint32_t getDeckOpenMs(int index) const
+    {
+        return (layout && isValidIndex(index)) ? layout->decks[index].openMs : 0;
+    }
+
+    int getNumClaimedDecks() const
+    {
+        int n = 0;
+        for (int i = 0; i < IPCConfig::MaxDecks && layout; ++i)
+        {
+            const auto state = getDeckState(i);
+            if (state == DeckState::Requested || state == DeckState::Active) ++n;
+        }
+        return n;
+    }
+
+    // ==============================================================================
+    // ENGINE SIDE
+    // ==============================================================================
+
+    void setEngineRunning(bool running)
+    {
+        if (!layout) return;
+        // Not ready until setEngineReady(), whether starting or stopping
+        layout->engineReady.store(0, std::memory_order_release);
+        if (running)
+        {
+            layout->engineGeneration.fetch_add(1, std::memory_order_relaxed);
+            touchEngine();
+        }
+        layout->engineRunning.store(running ? 1u : 0u, std::memory_order_release);
+    }
+
+    // End of the engine's startup: plugins waiting on the handshake go ahead
+    void setEngineReady(uint32_t startupMs, bool warm)
+    {
+        if (!layout) return;
+        layout->engineStartupMs = startupMs;
+        layout->engineWarm = warm ? 1u : 0u;
+        layout->engineReady.store(1, std::memory_order_release);
+    }
+
+    void touchEngine()
+    {
+        if (layout) layout->engineHeartbeatUs.store(IPCProtocol::nowMicros(), std::memory_order_relaxed);
+    }
+
+    // Requests not picked up yet
+    int getNumRequestedDecks() const
+    {
+        int n = 0;
+        for (int i = 0; i < IPCConfig::MaxDecks && layout; ++i)
+            if (getDeckState(i) == DeckState::Requested) ++n;
+        return n;
+    }
+
+    DeckState getDeckState(int index) const
+    {
+        if (!layout || !isValidIndex(index)) return DeckState::Free;
+        return (DeckState)layout->decks[index].state.load(std::memory_order_acquire);
+    }
+
+    // Reads a Requested slot. Returns false if it is not (or no longer) a valid request.
+    bool readDeckRequest(int index, juce::String& segmentName, IPCConfig::AudioFormat& format) const
+    {
+        if (getDeckState(index) != DeckState::Requested) return false;
+
+        const auto& slot = layout->decks[index];
+        char name[IPCConfig::SegmentNameLength];
+        std::memcpy(name, slot.segmentName, sizeof(name));
+        name[sizeof(name) - 1] = 0;
+
+        segmentName = juce::String::fromUTF8(name);
+        format.ringFrames = (int)slot.ringFrames;
+        format.numChannels = (int)slot.numChannels;
+        format = format.sanitised();
+
+        // Only plain file names inside the temp directory
+        return segmentName.startsWith(IPCConfig::DeckSegmentPrefix)
+            && !segmentName.containsAnyOf("/\\:") && !segmentName.contains("..");
+    }
+
+    // Requested -> Active. Fails if the plugin released the slot in the meantime.
+    bool activateDeck(int index, uint32_t openMs = 0)
+    {
+        if (!layout || !isValidIndex(index)) return false;
+        layout->decks[index].openMs = openMs;
+        uint32_t expected = (uint32_t)DeckState::Requested;
+        return layout->decks[index].state.compare_exchange_strong(expected, (uint32_t)DeckState::Active,
+                                                                  std::memory_order_acq_rel);
+    }
+
+    void freeDeck(int index)
+    {
+        if (layout && isValidIndex(index))
+            layout->decks[index].state.store((uint32_t)DeckState::Free, std::memory_order_release);
+    }
+
+    // Engine start: remove deck segments no slot refers to (crashed runs) and files left
+    // in the temp directory by builds that still used file-backed segments. Returns the count.
+    int removeStaleSegments()
+    {
+        int removed = 0;
+
+        for (auto& name : SharedMemorySegment::findSegments(IPCConfig::DeckSegmentPrefix))
+        {
+            bool inUse = false;
+            for (int i = 0; i < IPCConfig::MaxDecks && !inUse; ++i)
+                inUse = isDeckOwnedBy(i, name);
+
+            if (!inUse && SharedMemorySegment::remove(name)) ++removed;
+        }
+
+        auto tempDir = juce::File::getSpecialLocation(juce::File::tempDirectory);
+        for (const auto& entry : juce::RangedDirectoryIterator(tempDir, false, "Playlisted2_*.dat", juce::File::findFiles))
+            if (entry.getFile().deleteFile()) ++removed;
+
+        return removed;
+    }
+
+    // Announce that we are about to sleep; re-check for work afterwards, then waitForWork()
+    uint32_t prepareWait() { return doorbell.prepareWait(); }
+
+    // Sleep until a plugin rings or timeoutMs passes. Returns true if rung.
+    bool waitForWork(uint32_t observedSequence, int timeoutMs) { return doorbell.wait(observedSequence, timeoutMs); }
+
+    void countEngineWakeup()          { if (layout) layout->engineWakeups.fetch_add(1, std::memory_order_relaxed); }
+    uint32_t getEngineWakeups() const { return layout ? layout->engineWakeups.load(std::memory_order_relaxed) : 0; }
+
+private:
+    static bool isValidIndex(int index) { return index >= 0 && index < IPCConfig::MaxDecks; }
+
+    // Engine start: nothing from a previous engine is alive any more.
+    // Active decks are requested again (their plugin may still be there), released slots are freed.
+    // A dead plugin's request is reaped by the deck heartbeat watchdog.
+    void recoverSlots()
+    {
+        for (auto& slot : layout->decks)
+        {
+            const auto state = (DeckState)slot.state.load(std::memory_order_acquire);
+            if (state == DeckState::Active)
+                slot.state.store((uint32_t)DeckState::Requested, std::memory_order_release);
+            else if (state == DeckState::Released)
+                slot.state.store((uint32_t)DeckState::Free, std::memory_order_release);
+        }
+    }
+
+    Mode currentMode;
+    SharedMemorySegment segment;
+    EngineControlLayout* layout = nullptr;
+    IPCDoorbell doorbell;
+
+    JUCE_DECLARE_NON_COPYABLE(EngineControl)
+};
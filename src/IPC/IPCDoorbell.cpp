@@ -0,0 +1,155 @@
+/*
+  ==============================================================================
+
+    IPCDoorbell.cpp
+    Playlisted2
+
+  ==============================================================================
+*/
+
+#include "IPCDoorbell.h"
+
+#if JUCE_WINDOWS
+    #include <windows.h>
+#elif JUCE_LINUX
+    #include <linux/futex.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+    #include <ctime>
+    #include <climits>
+#else
+    #include <fcntl.h>
+    #include <poll.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+bool IPCDoorbell::open(const juce::String& name, std::atomic<uint32_t>* sequenceWord,
+                       std::atomic<uint32_t>* waitingFlag, bool isServer)
+{
+    close();
+    if (sequenceWord == nullptr || waitingFlag == nullptr) return false;
+
+   #if JUCE_WINDOWS
+    juce::ignoreUnused(isServer);
+    auto eventName = "Local\\" + name;
+    eventHandle = CreateEventW(nullptr, FALSE, FALSE, eventName.toWideCharPointer());
+    if (eventHandle == nullptr) return false;
+   #elif JUCE_LINUX
+    juce::ignoreUnused(name, isServer);
+   #else
+    fifoPath = juce::File::getSpecialLocation(juce::File::tempDirectory)
+                   .getChildFile(name + ".fifo").getFullPathName();
+
+    if (isServer)
+    {
+        ::unlink(fifoPath.toRawUTF8());
+        if (::mkfifo(fifoPath.toRawUTF8(), 0600) != 0) return false;
+        ownsFifo = true;
+    }
+
+    // O_RDWR keeps open() from blocking on a FIFO with no peer yet
+    fifoFd = ::open(fifoPath.toRawUTF8(), O_RDWR | O_NONBLOCK);
+    if (fifoFd < 0)
+    {
+        if (ownsFifo) ::unlink(fifoPath.toRawUTF8());
+        ownsFifo = false;
+        return false;
+    }
+   #endif
+
+    sequence = sequenceWord;
+    waiting = waitingFlag;
+    return true;
+}
+
+void IPCDoorbell::close()
+{
+   #if JUCE_WINDOWS
+    if (eventHandle != nullptr) CloseHandle(eventHandle);
+    eventHandle = nullptr;
+   #elif ! JUCE_LINUX
+    if (fifoFd >= 0) ::close(fifoFd);
+    fifoFd = -1;
+    if (ownsFifo) ::unlink(fifoPath.toRawUTF8());
+    ownsFifo = false;
+   #endif
+
+    sequence = nullptr;
+    waiting = nullptr;
+}
+
+void IPCDoorbell::ring()
+{
+    if (sequence == nullptr) return;
+
+    // seq_cst pairs with the waiter's store to 'waiting' followed by its load of 'sequence'
+    sequence->fetch_add(1);
+    if (waiting->load() == 0) return;
+
+   #if JUCE_WINDOWS
+    SetEvent(eventHandle);
+   #elif JUCE_LINUX
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(sequence), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+   #else
+    const char token = 1;
+    ssize_t written = ::write(fifoFd, &token, 1);   // EAGAIN means a wakeup is already pending
+    juce::ignoreUnused(written);
+   #endif
+}
+
+uint32_t IPCDoorbell::prepareWait() const
+{
+    if (sequence == nullptr) return 0;
+    waiting->store(1);
+    return sequence->load();
+}
+
+bool IPCDoorbell::wait(uint32_t observedSequence, int timeoutMs)
+{
+    if (sequence == nullptr)
+    {
+        juce::Thread::sleep(timeoutMs);
+        return false;
+    }
+
+    bool rung = sequence->load() != observedSequence;
+
+    if (!rung && timeoutMs > 0)
+    {
+       #if JUCE_WINDOWS
+        rung = WaitForSingleObject(eventHandle, (DWORD)timeoutMs) == WAIT_OBJECT_0;
+       #elif JUCE_LINUX
+        timespec ts;
+        ts.tv_sec = timeoutMs / 1000;
+        ts.tv_nsec = (long)(timeoutMs % 1000) * 1000000L;
+        // Returns immediately (EAGAIN) if the sequence already moved on
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(sequence), FUTEX_WAIT, observedSequence, &ts, nullptr, 0);
+        rung = sequence->load() != observedSequence;
+       #else
+        pollfd pfd { fifoFd, POLLIN, 0 };
+        if (::poll(&pfd, 1, timeoutMs) > 0)
+        {
+            char drain[64];
+            while (::read(fifoFd, drain, sizeof(drain)) > 0) {}
+            rung = true;
+        }
+       #endif
+    }
+
+    // A ring that saw 'waiting' leaves the event (or a fifo token) behind even when this call
+    // never blocked on it; take it now, or the next blocking wait returns at once for nothing
+    if (sequence->load() != observedSequence)
+    {
+        rung = true;
+       #if JUCE_WINDOWS
+        WaitForSingleObject(eventHandle, 0);
+       #elif ! JUCE_LINUX
+        char drain[64];
+        while (::read(fifoFd, drain, sizeof(drain)) > 0) {}
+       #endif
+    }
+
+    waiting->store(0);
+    return rung;
+}
@@ -0,0 +1,66 @@
+/*
+  ==============================================================================
+
+    IPCDoorbell.h
+    Playlisted2
+
+    Cross-process wakeup for the engine pump.
+    The plugin rings it after consuming audio or posting a command, the engine
+    sleeps on it until there is work or a deadline passes.
+
+    - Linux:   futex on a sequence word inside the shared segment
+    - Windows: named auto-reset event
+    - macOS:   named FIFO + poll() (no process-shared futex/condvar there)
+
+    The sequence word and the "engine is waiting" flag always live in the
+    segment, so a ring() while the engine is busy costs one atomic increment
+    and no syscall.
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <juce_core/juce_core.h>
+#include <atomic>
+#include <cstdint>
+
+class IPCDoorbell
+{
+public:
+    IPCDoorbell() = default;
+    ~IPCDoorbell() { close(); }
+
+    // name must be unique per engine; the server creates the OS object, the client opens it.
+    bool open(const juce::String& name, std::atomic<uint32_t>* sequenceWord,
+              std::atomic<uint32_t>* waitingFlag, bool isServer);
+    void close();
+
+    bool isOpen() const { return sequence != nullptr; }
+
+    // Any thread, any process. Cheap when nobody is waiting.
+    void ring();
+
+    // True while the server is (about to be) asleep - lets callers skip work that only matters then
+    bool hasWaiter() const { return waiting != nullptr && waiting->load(std::memory_order_relaxed) != 0; }
+
+    // Server side. Returns the current sequence; pass it to wait() after re-checking for work,
+    // so a ring() that lands between the check and the sleep is never lost.
+    uint32_t prepareWait() const;
+
+    // Sleeps until ring() or timeoutMs. Returns true if woken by a ring.
+    bool wait(uint32_t observedSequence, int timeoutMs);
+
+private:
+    std::atomic<uint32_t>* sequence = nullptr;
+    std::atomic<uint32_t>* waiting = nullptr;
+
+   #if JUCE_WINDOWS
+    void* eventHandle = nullptr;
+   #elif ! JUCE_LINUX
+    int fifoFd = -1;
+    juce::String fifoPath;
+    bool ownsFifo = false;
+   #endif
+
+    JUCE_DECLARE_NON_COPYABLE(IPCDoorbell)
+};
@@ -0,0 +1,268 @@
+/*
+  ==============================================================================
+
+    MpscMessageQueue.h
+    Playlisted2
+
+    Multi-producer / single-consumer queue of variable-length messages, laid
+    out in shared memory. Used for plugin -> engine commands, which are sent
+    from the message thread, the timer thread and the audio thread at once.
+
+    - Producers reserve space with a CAS on reserveHead, write their record,
+      then publish it by storing its size with release ordering. Concurrent
+      producers never touch the same bytes.
+    - Records are [size|flags u32][sequence u32][payload], 8-byte aligned.
+      A record that would straddle the end is preceded by a padding record.
+    - The consumer stops at the first unpublished record (so ordering is
+      preserved), zeroes what it consumed and advances readTail.
+    - Every caller class has its own share of the ring, so background traffic
+      (heartbeats) can never crowd out transport commands, and per-class
+      drop counters record what could not be queued.
+
+    Deliberately free of JUCE so it can be tested standalone.
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+
+// Who is sending - decides how much of the ring may be used and whether we may wait
+enum class IPCCaller : uint32_t
+{
+    RealTime = 0,   // Audio thread: never waits, may use the whole ring
+    Message,        // UI / message thread: bounded wait, leaves headroom for RealTime
+    Background,     // Timers / heartbeats: never waits, limited to half the ring
+    NumClasses
+};
+
+// Shared control block; lives in the segment, zero-initialised by the creator
+struct MpscQueueControl
+{
+    alignas(64) std::atomic<uint64_t> reserveHead { 0 };   // Producers
+    alignas(64) std::atomic<uint64_t> readTail { 0 };      // Consumer
+    alignas(64) std::atomic<uint32_t> nextSequence { 0 };
+    std::atomic<uint32_t> sent[(size_t)IPCCaller::NumClasses];
+    std::atomic<uint32_t> dropped[(size_t)IPCCaller::NumClasses];
+};
+
+class MpscMessageQueue
+{
+public:
+    static const uint32_t CommittedFlag = 0x80000000u;
+    static const uint32_t PaddingFlag   = 0x40000000u;
+    static const uint32_t SizeMask      = 0x3FFFFFFFu;
+
+    struct RecordHeader
+    {
+        uint32_t sizeAndFlags;   // Accessed atomically; 0 = not yet published
+        uint32_t sequence;
+    };
+    static_assert(sizeof(RecordHeader) == 8, "RecordHeader must be 8 bytes");
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "Shared queue requires lock-free 64-bit atomics");
+
+    MpscMessageQueue() = default;
+
+    // capacityBytes must be a power of two, data must be 8-byte aligned and zeroed by the creator
+    void attach(MpscQueueControl* controlBlock, uint8_t* data, uint32_t capacityBytes) noexcept
+    {
+        if (controlBlock == nullptr || data == nullptr || capacityBytes < 64
+            || (capacityBytes & (capacityBytes - 1)) != 0)
+        {
+            detach();
+            return;
+        }
+
+        control = controlBlock;
+        buffer = data;
+        capacity = capacityBytes;
+        mask = capacityBytes - 1;
+    }
+
+    void detach() noexcept { control = nullptr; buffer = nullptr; capacity = mask = 0; }
+    bool isValid() const noexcept { return control != nullptr; }
+
+    // Largest payload that can ever be queued
+    uint32_t getMaxMessageSize() const noexcept { return capacity / 4 - (uint32_t)sizeof(RecordHeader); }
+
+    uint32_t allocateSequence() noexcept
+    {
+        return isValid() ? control->nextSequence.fetch_add(1, std::memory_order_relaxed) + 1 : 0;
+    }
+
+    // ==============================================================================
+    // PRODUCERS (any thread, any process)
+    // ==============================================================================
+
+    // Non-blocking. Returns false (and counts a drop) if the caller's share of the ring is full.
+    bool tryPush(const void* data, uint32_t size, uint32_t sequence, IPCCaller caller) noexcept
+    {
+        if (!isValid()) return false;
+
+        if (size == 0 || size > getMaxMessageSize() || !tryReserveAndWrite(data, size, sequence, caller))
+        {
+            countDrop(caller);
+            return false;
+        }
+
+        control->sent[(size_t)caller].fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Retries until maxWaitMs has passed. Only meant for callers that are allowed to block briefly.
+    bool push(const void* data, uint32_t size, uint32_t sequence, IPCCaller caller, int maxWaitMs) noexcept
+    {
+        if (!isValid()) return false;
+        if (size == 0 || size > getMaxMessageSize()) { countDrop(caller); return false; }
+
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(maxWaitMs);
+
+        for (int attempt = 0;; ++attempt)
+        {
+            if (tryReserveAndWrite(data, size, sequence, caller))
+            {
+                control->sent[(size_t)caller].fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+
+            if (std::chrono::steady_clock::now() >= deadline) break;
+
+            if (attempt < 16) std::this_thread::yield();
+            else std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        countDrop(caller);
+        return false;
+    }
+
+    // ==============================================================================
+    // CONSUMER (engine pump thread only)
+    // ==============================================================================
+
+    bool hasPending() const noexcept
+    {
+        return isValid()
+            && control->readTail.load(std::memory_order_acquire) != control->reserveHead.load(std::memory_order_acquire);
+    }
+
+    // Copies the next published message into dest. Returns its size, 0 if there is none yet.
+    // A message larger than destCapacity is skipped (and reported as size 0).
+    uint32_t pop(void* dest, uint32_t destCapacity, uint32_t* sequenceOut = nullptr) noexcept
+    {
+        if (!isValid()) return 0;
+
+        for (;;)
+        {
+            const uint64_t tail = control->readTail.load(std::memory_order_relaxed);
+            if (tail == control->reserveHead.load(std::memory_order_acquire)) return 0;
+
+            const uint32_t offset = (uint32_t)(tail & mask);
+            auto* word = headerWord(offset);
+            const uint32_t value = word->load(std::memory_order_acquire);
+            if ((value & CommittedFlag) == 0) return 0;   // Producer still writing
+
+            const uint32_t recordSize = value & SizeMask;
+            uint32_t result = 0;
+
+            if ((value & PaddingFlag) == 0)
+            {
+                RecordHeader h;
+                std::memcpy(&h, buffer + offset, sizeof(h));
+                const uint32_t payloadSize = recordSize - (uint32_t)sizeof(RecordHeader);
+
+                if (payloadSize <= destCapacity)
+                {
+                    std::memcpy(dest, buffer + offset + sizeof(RecordHeader), payloadSize);
+                    result = payloadSize;
+                }
+                if (sequenceOut != nullptr) *sequenceOut = h.sequence;
+            }
+
+            // Zero the whole record so stale bytes never look like a published header
+            const uint32_t span = alignUp(recordSize);
+            std::memset(buffer + offset, 0, span);
+            control->readTail.store(tail + span, std::memory_order_release);
+
+            if ((value & PaddingFlag) == 0) return result;
+        }
+    }
+
+    uint32_t getSentCount(IPCCaller c) const noexcept    { return isValid() ? control->sent[(size_t)c].load(std::memory_order_relaxed) : 0; }
+    uint32_t getDroppedCount(IPCCaller c) const noexcept { return isValid() ? control->dropped[(size_t)c].load(std::memory_order_relaxed) : 0; }
+
+    // For wrappers that reject a message before it reaches the queue, so it still shows up as a drop
+    void recordDrop(IPCCaller caller) noexcept { if (isValid()) countDrop(caller); }
+
+private:
+    static uint32_t alignUp(uint32_t n) noexcept { return (n + 7u) & ~7u; }
+
+    std::atomic<uint32_t>* headerWord(uint32_t offset) const noexcept
+    {
+        return reinterpret_cast<std::atomic<uint32_t>*>(buffer + offset);
+    }
+
+    // How many bytes of the ring a caller class may occupy (including what is already queued)
+    uint32_t getLimitFor(IPCCaller caller) const noexcept
+    {
+        switch (caller)
+        {
+            case IPCCaller::RealTime:   return capacity;
+            case IPCCaller::Message:    return capacity - capacity / 8;
+            case IPCCaller::Background: return capacity / 2;
+            case IPCCaller::NumClasses:
+            default:                    return 0;
+        }
+    }
+
+    void countDrop(IPCCaller caller) noexcept
+    {
+        control->dropped[(size_t)caller].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    bool tryReserveAndWrite(const void* data, uint32_t size, uint32_t sequence, IPCCaller caller) noexcept
+    {
+        const uint32_t recordSize = (uint32_t)sizeof(RecordHeader) + size;
+        const uint32_t span = alignUp(recordSize);
+        const uint32_t limit = getLimitFor(caller);
+
+        uint64_t head = control->reserveHead.load(std::memory_order_relaxed);
+        uint32_t padding = 0;
+
+        for (;;)
+        {
+            const uint64_t tail = control->readTail.load(std::memory_order_acquire);
+            const uint32_t offset = (uint32_t)(head & mask);
+            const uint32_t untilEnd = capacity - offset;
+            padding = (untilEnd < span) ? untilEnd : 0;
+
+            if (head - tail + padding + span > limit) return false;
+
+            if (control->reserveHead.compare_exchange_weak(head, head + padding + span,
+                                                           std::memory_order_acq_rel, std::memory_order_relaxed))
+                break;
+        }
+
+        uint32_t offset = (uint32_t)(head & mask);
+
+        if (padding > 0)
+        {
+            headerWord(offset)->store(CommittedFlag | PaddingFlag | padding, std::memory_order_release);
+            offset = 0;
+        }
+
+        RecordHeader h { 0, sequence };
+        std::memcpy(buffer + offset, &h, sizeof(h));
+        std::memcpy(buffer + offset + sizeof(RecordHeader), data, size);
+        headerWord(offset)->store(CommittedFlag | recordSize, std::memory_order_release);
+        return true;
+    }
+
+    MpscQueueControl* control = nullptr;
+    uint8_t* buffer = nullptr;
+    uint32_t capacity = 0;
+    uint32_t mask = 0;
+};
@@ -0,0 +1,86 @@
+/*
+  ==============================================================================
+
+    SeqlockSnapshot.h
+    Playlisted2
+
+    Single-writer / many-reader consistent snapshot of a small POD struct,
+    placed inside a shared memory segment.
+
+    Writer: sequence becomes odd, payload is stored, sequence becomes even.
+    Reader: copies the payload between two reads of the sequence and retries
+    if the writer was active (odd) or finished a write in between.
+
+    - Never blocks the writer; readers retry a bounded number of times and
+      report failure instead of spinning forever (a writer process that
+      crashed mid-write leaves the sequence odd).
+    - The payload is kept in relaxed 64-bit atomic words, so concurrent
+      access is well defined without locks in shared memory.
+
+    Deliberately free of JUCE.
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+template <typename T>
+class SeqlockSnapshot
+{
+public:
+    static_assert(std::is_trivially_copyable<T>::value, "Snapshot payload must be trivially copyable");
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "Shared memory seqlock requires lock-free 64-bit atomics");
+
+    static constexpr int maxReadAttempts = 64;
+
+    // Writer side (one thread only)
+    void write(const T& value) noexcept
+    {
+        uint64_t words[numWords] = {};
+        std::memcpy(words, &value, sizeof(T));
+
+        const uint32_t s = sequence.load(std::memory_order_relaxed);
+        sequence.store(s + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        for (int i = 0; i < numWords; ++i)
+            payload[i].store(words[i], std::memory_order_relaxed);
+
+        sequence.store(s + 2, std::memory_order_release);
+    }
+
+    // Reader side. Returns false (dest untouched) if no consistent copy could be taken.
+    bool read(T& dest) const noexcept
+    {
+        uint64_t words[numWords];
+
+        for (int attempt = 0; attempt < maxReadAttempts; ++attempt)
+        {
+            const uint32_t before = sequence.load(std::memory_order_acquire);
+            if ((before & 1u) != 0) continue;
+
+            for (int i = 0; i < numWords; ++i)
+                words[i] = payload[i].load(std::memory_order_relaxed);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence.load(std::memory_order_relaxed) != before) continue;
+
+            std::memcpy(&dest, words, sizeof(T));
+            return true;
+        }
+        return false;
+    }
+
+    // Number of completed writes (0 = nothing published yet)
+    uint32_t getVersion() const noexcept { return sequence.load(std::memory_order_acquire) / 2; }
+
+private:
+    static constexpr int numWords = (int)((sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+
+    std::atomic<uint32_t> sequence { 0 };
+    std::atomic<uint64_t> payload[numWords] = {};
+};
@@ -8,6 +8,39 @@
     FIXED: Added flushAudioBuffer to prevent "ghost audio" bursts on startup.
     FIX: Added DAW sample rate field to SharedMemoryLayout for rate sync.
     FIX: popAudio now does partial reads instead of all-or-nothing silence.
+    PERF: Audio ring is now a lock-free SPSC ring (SpscAudioRing) with
+          acquire/release indices, power-of-two masking and block copies.
+          A full ring no longer overwrites unread audio.
+    v5: Segment starts with a header (magic, version, struct size, channels,
+        ring capacity). Ring size and channel count are negotiated at runtime,
+        indices are partitioned onto their own cache lines.
+    ADDED: Doorbell (IPCDoorbell) so the engine pump sleeps until the plugin
+           consumes audio or posts a command instead of polling every 1 ms.
+    PERF: Command slots carry a byte length so they can hold binary
+          IPCProtocol messages; no more 4 KB memset per command.
+    v6: Command slots replaced by an MPSC variable-length message queue
+        (MpscMessageQueue) - safe with the message, timer and audio threads
+        all sending, with per-caller-class quotas and drop counters.
+    ADDED: One segment per plugin instance (deck). The segment name is set
+           by the owner; the doorbell now belongs to EngineControl and is
+           shared by every deck of the engine.
+    PERF: Segments are RAM-backed (SharedMemorySegment: shm_open / named
+          mapping) instead of temp-dir files - no disk writeback, no
+          zero-fill via appendData. The engine removes its segment on close.
+    ADDED: readAudio / discardAudio for the plugin's DriftCompensator, which
+           pulls exactly the frames its resampler needs.
+    v7: Engine status is one seqlock-protected snapshot (SeqlockSnapshot):
+        track id, int64 sample position/length, state, buffered frames and
+        a monotonic timestamp - no more torn reads across five atomics.
+    v8: Liveness is a pair of heartbeat counters in the segment (one per
+        side) instead of heartbeat commands through the queue. Status also
+        carries the wait between tracks.
+    v9: Readiness handshake in EngineControl (engine ready flag, startup
+        and deck open timings, warm engine flag).
+    PERF: Both sides prefault the segment when they map it, so neither the
+          pump nor the DAW's audio thread takes first-touch page faults.
+    v10: The plugin publishes the ring fill it wants (audioTargetFillFrames);
+         the engine's delivery stage tops the ring up to it.
   ==============================================================================
 */
 
@@ -15,54 +48,225 @@
 #include <juce_core/juce_core.h>
 #include <juce_audio_basics/juce_audio_basics.h>
 #include <algorithm>
+#include "SpscAudioRing.h"
+#include "IPCDoorbell.h"
+#include "SharedMemorySegment.h"
+#include "SeqlockSnapshot.h"
+#include "CommandProtocol.h"
+#include "MpscMessageQueue.h"
 
 namespace IPCConfig
 {
-    // BUMPED VERSION TO v4 to support sample rate sync
-    static const char* SharedMemoryName = "Playlisted2_SharedMem_v4.dat";
+    // v10: plugin's target ring fill for the engine's delivery stage
+    //     (v9: readiness handshake in the control segment)
+    //     (v8: heartbeat counters, wait in the status snapshot)
+    //     (v7: seqlock status snapshot)
+    //     (v6: MPSC command queue, one segment per deck)
+    //     (v5: self-describing header, partitioned indices, runtime ring size)
+    static const char* SharedMemoryName = "Playlisted2_SharedMem_v10";   // Default / single-deck name
+    static const char* DeckSegmentPrefix = "Playlisted2_Deck_v10_";
+    static const char* DoorbellName = "Playlisted2_Doorbell_v10";
+    static const uint32_t LayoutMagic = 0x504C3253;   // 'PL2S'
+    static const uint32_t LayoutVersion = 10;
+    static constexpr size_t CacheLineSize = 64;
+
     // Audio Settings (defaults - actual rate comes from DAW)
     static const int SampleRate = 44100;
     static const int BlockSize  = 512;
     static const int NumChannels = 2;
     
-    // Size of the Ring Buffer (Power of 2 is best for wrapping logic)
+    // Ring size in frames (must be a power of 2, the ring masks indices).
+    // The actual size is negotiated at runtime and stored in the segment header.
     static const int AudioBufferSize = 65536;
-    static const int CommandQueueSize = 16;
+    static const int MinAudioBufferSize = 1024;
+    static const int MaxAudioBufferSize = 1 << 20;
+    static const int MaxChannels = 8;
+
+    // Command queue in bytes (power of 2). Largest single message is a quarter of it.
+    static const int CommandQueueBytes = 65536;
     static const int CommandBufferSize = 4096;
+    // How long a Message-class sender may wait for queue space before dropping
+    static const int CommandSendTimeoutMs = 20;
+
+    static_assert((AudioBufferSize & (AudioBufferSize - 1)) == 0, "AudioBufferSize must be a power of 2");
+    static_assert((CommandQueueBytes & (CommandQueueBytes - 1)) == 0, "CommandQueueBytes must be a power of 2");
+    static_assert(CommandBufferSize + 8 <= CommandQueueBytes / 4, "CommandBufferSize must fit the queue's message limit");
+
+    // Engine never pushes more than fits; a block that would overrun is dropped, not overwritten
+    static const SpscAudioRing::OverrunPolicy AudioOverrunPolicy = SpscAudioRing::OverrunPolicy::RejectBlock;
+
+    // Ring geometry requested by the plugin and honoured by the engine
+    struct AudioFormat
+    {
+        int ringFrames = AudioBufferSize;
+        int numChannels = NumChannels;
+
+        // Rounds the ring up to a power of 2 and clamps both values to sane limits
+        AudioFormat sanitised() const
+        {
+            AudioFormat f;
+            f.numChannels = juce::jlimit(1, MaxChannels, numChannels);
+            f.ringFrames = (int)juce::nextPowerOfTwo(juce::jlimit(MinAudioBufferSize, MaxAudioBufferSize, ringFrames));
+            return f;
+        }
+    };
+
+    // Pin segments in RAM (mlock / VirtualLock): PLAYLISTED_IPC_MLOCK=1, or the engine's
+    // real-time profile asking for locked memory (PLAYLISTED_RT_MLOCK=1)
+    inline bool shouldLockSegments()
+    {
+        return juce::SystemStats::getEnvironmentVariable("PLAYLISTED_IPC_MLOCK", {}).getIntValue() != 0
+            || juce::SystemStats::getEnvironmentVariable("PLAYLISTED_RT_MLOCK", {}).getIntValue() != 0;
+    }
+
+    // Plugin-side clock drift compensation (DriftCompensator). PLAYLISTED_DRIFT_COMP=0 disables it.
+    inline bool useDriftCompensation()
+    {
+        return juce::SystemStats::getEnvironmentVariable("PLAYLISTED_DRIFT_COMP", "1").getIntValue() != 0;
+    }
+
+    // Ring fill the compensator steers towards: enough to ride out the engine's block
+    // jitter and wake-up latency, not more. Overridable with PLAYLISTED_DRIFT_TARGET_FRAMES.
+    static const int DriftTargetFillFrames = 4096;
+
+    inline int getDriftTargetFillFrames(int dawBlockSize)
+    {
+        const int requested = juce::SystemStats::getEnvironmentVariable("PLAYLISTED_DRIFT_TARGET_FRAMES", {}).getIntValue();
+        const int target = requested > 0 ? requested : DriftTargetFillFrames;
+        return juce::jmax(target, 2 * dawBlockSize);
+    }
+
+    // Engine decode stage: decoded audio kept per deck ahead of the IPC ring, to absorb
+    // decoder bursts and stalls. PLAYLISTED_ENGINE_PREBUFFER_MS, 10..500.
+    static const int EnginePrebufferMs = 100;
+
+    inline int getEnginePrebufferMs()
+    {
+        const int requested = juce::SystemStats::getEnvironmentVariable("PLAYLISTED_ENGINE_PREBUFFER_MS", {}).getIntValue();
+        return juce::jlimit(10, 500, requested > 0 ? requested : EnginePrebufferMs);
+    }
+
+    // Audio-only engine: no video windows, no video decoding. The engine takes the launch
+    // flag; PLAYLISTED_HEADLESS=1 makes the plugin pass it (and is honoured by the engine too).
+    static constexpr const char* HeadlessFlag = "--headless";
+
+    inline bool useHeadlessEngine()
+    {
+        return juce::SystemStats::getEnvironmentVariable("PLAYLISTED_HEADLESS", {}).getIntValue() != 0;
+    }
+
+    // Debug fallback: send human-readable JSON commands instead of the binary protocol
+    inline bool useJsonCommands()
+    {
+        return juce::SystemStats::getEnvironmentVariable("PLAYLISTED_IPC_JSON", {}).getIntValue() != 0;
+    }
+
+    // Per-deployment tuning without a rebuild:
+    //   PLAYLISTED_IPC_RING_FRAMES, PLAYLISTED_IPC_CHANNELS
+    inline AudioFormat getDeploymentAudioFormat()
+    {
+        AudioFormat f;
+        auto frames = juce::SystemStats::getEnvironmentVariable("PLAYLISTED_IPC_RING_FRAMES", {});
+        auto chans  = juce::SystemStats::getEnvironmentVariable("PLAYLISTED_IPC_CHANNELS", {});
+        if (frames.getIntValue() > 0) f.ringFrames = frames.getIntValue();
+        if (chans.getIntValue() > 0)  f.numChannels = chans.getIntValue();
+        return f.sanitised();
+    }
 }
 
-// Command Queue Structure
-struct CommandSlot
+// Written once by the engine before anything else is used.
+// magic is stored last (release) so a client never sees a half-written header.
+struct SharedMemoryHeader
 {
-    std::atomic<bool> ready { false };
-    char data[IPCConfig::CommandBufferSize];
+    std::atomic<uint32_t> magic { 0 };
+    uint32_t layoutVersion = 0;
+    uint32_t layoutSize = 0;          // sizeof(SharedMemoryLayout), catches struct drift between builds
+    uint32_t numChannels = 0;
+    uint32_t ringCapacityFrames = 0;
+    uint32_t audioOffset = 0;         // Byte offset of the audio ring from the start of the segment
+    uint64_t totalSize = 0;           // Layout + audio ring
 };
 
+enum class EnginePlayState : uint32_t
+{
+    Empty = 0,   // Nothing loaded
+    Stopped,
+    Paused,
+    Playing,
+    Finished,
+    Waiting      // Track ended, the preloaded one starts after its wait (waitRemainingSamples)
+};
+
+// One consistent view of a deck, published by the engine pump (see SeqlockSnapshot)
+struct EngineStatusSnapshot
+{
+    enum Flags : uint32_t { WindowOpen = 1u << 0 };
+
+    uint32_t trackId = 0;            // Sequence number of the load command that started this track
+    uint32_t state = 0;              // EnginePlayState
+    int64_t positionSamples = 0;     // Decoder position, in media samples at sampleRate
+    int64_t lengthSamples = 0;       // 0 = unknown
+    uint32_t sampleRate = 0;         // Timeline rate (the DAW rate the deck renders at)
+    uint32_t bufferedFrames = 0;     // In the ring, not yet pulled by the plugin
+    uint64_t timestampUs = 0;        // IPCProtocol::nowMicros() when published
+    float playbackRate = 1.0f;
+    uint32_t flags = 0;
+    int64_t waitRemainingSamples = 0;   // Waiting: silence left before the next track, at sampleRate
+
+    EnginePlayState getState() const { return (EnginePlayState)state; }
+    bool isWindowOpen() const        { return (flags & WindowOpen) != 0; }
+};
+
+// Every index lives on its own cache line, grouped with the counters written by the same side,
+// so the engine and the plugin never write to the same line on the audio path.
 struct SharedMemoryLayout
 {
-    // --- STATUS ---
-    std::atomic<bool> isEngineRunning { false };
-    std::atomic<bool> isPlaying { false };
-    std::atomic<bool> hasFinished { false };
-    // Window Visibility Flag
-    std::atomic<bool> isWindowOpen { true };
-    
-    std::atomic<float> currentPosition { 0.0f };
-    std::atomic<int64_t> currentLengthMs { 0 };
-    std::atomic<double> currentCallbackTime { 0.0 };
+    alignas(IPCConfig::CacheLineSize) SharedMemoryHeader header;
+
+    // --- STATUS (engine writes) ---
+    alignas(IPCConfig::CacheLineSize) std::atomic<bool> isEngineRunning { false };
+    alignas(IPCConfig::CacheLineSize) SeqlockSnapshot<EngineStatusSnapshot> status;
 
+    // --- PLUGIN CONTROL (plugin writes) ---
     // FIX: DAW sample rate - plugin writes, engine reads
-    std::atomic<int> dawSampleRate { 44100 };
+    alignas(IPCConfig::CacheLineSize) std::atomic<int> dawSampleRate { 44100 };
+    std::atomic<uint32_t> audioTargetFillFrames { 0 };   // Ring fill the plugin reads at (0 = not set yet)
+
+    // --- LIVENESS (each side bumps its own counter on its own line, the other watches it move) ---
+    alignas(IPCConfig::CacheLineSize) std::atomic<uint32_t> pluginHeartbeat { 0 };
+    alignas(IPCConfig::CacheLineSize) std::atomic<uint32_t> engineHeartbeat { 0 };
+
+    // --- AUDIO INDICES ---
+    // Free-running frame counters (engine owns write, plugin owns read)
+    alignas(IPCConfig::CacheLineSize) std::atomic<uint32_t> audioWritePos { 0 };
+    std::atomic<uint32_t> audioDroppedFrames { 0 };   // Frames the engine could not fit (overrun)
 
-    // --- AUDIO ---
-    std::atomic<int> audioWritePos { 0 };
-    std::atomic<int> audioReadPos { 0 };
-    float audioBuffer[IPCConfig::AudioBufferSize * IPCConfig::NumChannels];
+    alignas(IPCConfig::CacheLineSize) std::atomic<uint32_t> audioReadPos { 0 };
+    std::atomic<uint32_t> audioUnderrunBlocks { 0 };  // DAW blocks padded with silence
 
-    // --- COMMANDS (QUEUE) ---
-    std::atomic<int> commandWriteIndex { 0 };
-    std::atomic<int> commandReadIndex { 0 };
-    CommandSlot commands[IPCConfig::CommandQueueSize];
+    // --- PUMP PACING (engine writes, plugin reads; the doorbell itself lives in EngineControl) ---
+    alignas(IPCConfig::CacheLineSize) std::atomic<uint32_t> audioWakeThresholdFrames { 0 };  // Ring once fill drops below this
+
+    // --- COMMANDS (MPSC QUEUE, any plugin thread writes, engine reads) ---
+    alignas(IPCConfig::CacheLineSize) MpscQueueControl commandQueue;
+    alignas(IPCConfig::CacheLineSize) uint8_t commandData[IPCConfig::CommandQueueBytes];
+
+    // The audio ring (ringCapacityFrames * numChannels floats) follows at header.audioOffset
+
+    static size_t getAudioOffset()
+    {
+        return (sizeof(SharedMemoryLayout) + IPCConfig::CacheLineSize - 1) & ~(IPCConfig::CacheLineSize - 1);
+    }
+
+    static size_t getTotalSize(const IPCConfig::AudioFormat& f)
+    {
+        return getAudioOffset() + (size_t)f.ringFrames * (size_t)f.numChannels * sizeof(float);
+    }
+
+    float* getAudioBuffer()
+    {
+        return reinterpret_cast<float*>(reinterpret_cast<char*>(this) + header.audioOffset);
+    }
 };
 
 class SharedMemoryManager
@@ -70,69 +274,98 @@ class SharedMemoryManager
 public:
     enum class Mode { Plugin_Client, Engine_Server };
 
-    SharedMemoryManager(Mode mode) : currentMode(mode) {}
+    SharedMemoryManager(Mode mode, const juce::String& name = IPCConfig::SharedMemoryName)
+        : currentMode(mode), segmentName(name) {}
 
     ~SharedMemoryManager()
     {
-        mappedFile.reset();
+        // A plugin still mapping a closed deck must see it as disconnected
+        if (layout && currentMode == Mode::Engine_Server)
+            layout->isEngineRunning.store(false);
+
+        commandQueue.detach();
+        audioRing.detach();
+        layout = nullptr;
+        segment.close();   // The engine (creator) also removes the name
     }
 
+    // Name of this deck's shared memory segment (call before initialize)
+    void setSegmentName(const juce::String& name) { segmentName = name; }
+    const juce::String& getSegmentName() const    { return segmentName; }
+
+    // Engine-wide doorbell (owned by EngineControl). Without one the engine just runs on its deadlines.
+    void setDoorbell(IPCDoorbell* engineDoorbell) { doorbell = engineDoorbell; }
+
+    // Engine only: ring geometry to create the segment with (call before initialize)
+    void setRequestedAudioFormat(const IPCConfig::AudioFormat& f) { requestedFormat = f.sanitised(); }
+
+    // Geometry actually in use (valid once initialize() succeeded)
+    int getRingCapacityFrames() const { return layout ? (int)layout->header.ringCapacityFrames : 0; }
+    int getNumChannels() const        { return layout ? (int)layout->header.numChannels : 0; }
+
     bool initialize()
     {
-        auto tempDir = juce::File::getSpecialLocation(juce::File::tempDirectory);
-        auto sharedFile = tempDir.getChildFile(IPCConfig::SharedMemoryName);
+        audioRing.detach();
+        commandQueue.detach();
+        layout = nullptr;
+
+        const auto totalSize = SharedMemoryLayout::getTotalSize(requestedFormat);
 
         if (currentMode == Mode::Engine_Server)
         {
-            // SERVER: Create file
-            if (sharedFile.exists())
-            {
-                if (!sharedFile.deleteFile()) { }
-            }
-
-            // Ensure file exists with correct size
-            if (sharedFile.create())
-            {
-                // Only fill if empty
-                if (sharedFile.getSize() != sizeof(SharedMemoryLayout))
-                {
-                    sharedFile.deleteFile();
-                    sharedFile.create();
-                    juce::MemoryBlock zeros(sizeof(SharedMemoryLayout), true);
-                    bool success = sharedFile.appendData(zeros.getData(), zeros.getSize());
-                    if (!success) return false;
-                }
-            }
-            else return false;
+            // SERVER: Always start from a fresh segment of the negotiated size (the OS zero-fills it)
+            if (!segment.create(segmentName, totalSize)) return false;
+
+            segment.prefault(true);   // Before the header: the plugin cannot have mapped it yet
+            if (IPCConfig::shouldLockSegments())
+                segment.lockInMemory();
         }
         else
         {
-            // CLIENT: Wait for file to exist
-            if (!sharedFile.existsAsFile()) return false;
-            // Wait for size to settle
-            if (sharedFile.getSize() < (int64_t)sizeof(SharedMemoryLayout)) return false;
+            // CLIENT: Wait for the segment to exist and hold at least the fixed part
+            if (!segment.open(segmentName)) return false;
+            if (segment.getSize() < sizeof(SharedMemoryLayout)) { segment.close(); return false; }
         }
 
-        try
+        auto* mapped = static_cast<SharedMemoryLayout*>(segment.getData());
+
+        if (currentMode == Mode::Engine_Server)
         {
-            mappedFile = std::make_unique<juce::MemoryMappedFile>(
-                sharedFile, 
-                juce::MemoryMappedFile::AccessMode::readWrite
-            );
-            layout = static_cast<SharedMemoryLayout*>(mappedFile->getData());
+            auto& h = mapped->header;
+            h.layoutVersion = IPCConfig::LayoutVersion;
+            h.layoutSize = (uint32_t)sizeof(SharedMemoryLayout);
+            h.numChannels = (uint32_t)requestedFormat.numChannels;
+            h.ringCapacityFrames = (uint32_t)requestedFormat.ringFrames;
+            h.audioOffset = (uint32_t)SharedMemoryLayout::getAudioOffset();
+            h.totalSize = (uint64_t)totalSize;
+            h.magic.store(IPCConfig::LayoutMagic, std::memory_order_release);
         }
-        catch (...)
+        else if (!validateHeader(mapped->header, segment.getSize()))
         {
+            // Engine from another build, or still writing the header - retry later
+            segment.close();
             return false;
         }
+        else
+        {
+            segment.prefault(false);
+            if (IPCConfig::shouldLockSegments())
+                segment.lockInMemory();
+        }
+
+        layout = mapped;
+        audioRing.attach(&layout->audioWritePos, &layout->audioReadPos, layout->getAudioBuffer(),
+                         layout->header.ringCapacityFrames, (int)layout->header.numChannels,
+                         &layout->audioDroppedFrames);
+        commandQueue.attach(&layout->commandQueue, layout->commandData, (uint32_t)IPCConfig::CommandQueueBytes);
 
         // Initialize (Server only sets flag)
-        if (currentMode == Mode::Engine_Server && layout)
+        if (currentMode == Mode::Engine_Server)
         {
             layout->isEngineRunning.store(true);
         }
 
-        return (layout != nullptr);
+        return true;
     }
 
     bool isConnected() const 
@@ -158,162 +391,225 @@ public:
         return (rate > 1000) ? rate : 44100;
     }
 
+    // Plugin: the ring fill it steers towards (DriftCompensator target); the engine delivers up to it
+    void setAudioTargetFill(int frames)
+    {
+        if (layout) layout->audioTargetFillFrames.store((uint32_t)juce::jmax(0, frames), std::memory_order_relaxed);
+    }
+
+    // Engine: 0 until the plugin has prepared
+    int getAudioTargetFill() const
+    {
+        return layout ? (int)layout->audioTargetFillFrames.load(std::memory_order_relaxed) : 0;
+    }
+
     // ==============================================================================
     // AUDIO METHODS
     // ==============================================================================
     
     // FIX: New method to wipe the buffer clean on startup
+    // Consumer-side flush: skips everything unread so old audio never bursts out.
+    // Only moves the read index, so it is safe while the engine keeps pushing.
     void flushAudioBuffer()
     {
-        if (!layout) return;
-        
-        // Reset pointers
-        layout->audioReadPos.store(0);
-        layout->audioWritePos.store(0);
-        
-        // Zero out the entire buffer memory to prevent old audio bursts
-        std::fill(std::begin(layout->audioBuffer), std::end(layout->audioBuffer), 0.0f);
+        audioRing.discardReady();
     }
 
-    void pushAudio(const float* const* channelData, int numChannels, int numSamples)
-    {
-        if (!layout) return;
-        int writePos = layout->audioWritePos.load();
-        int totalSize = IPCConfig::AudioBufferSize * IPCConfig::NumChannels;
+    // Engine: free space in frames, used to throttle the pump instead of overrunning
+    int getAudioFramesFree() const { return (int)audioRing.getNumFree(); }
 
-        for (int i = 0; i < numSamples; ++i)
-        {
-            for (int ch = 0; ch < IPCConfig::NumChannels; ++ch)
-            {
-                float sample = (ch < numChannels) ? channelData[ch][i] : 0.0f;
-                layout->audioBuffer[writePos] = sample;
-                writePos = (writePos + 1) % totalSize;
-            }
-        }
-        
-        layout->audioWritePos.store(writePos);
+    // Plugin: frames currently buffered in the ring
+    int getAudioFramesReady() const { return (int)audioRing.getNumReady(); }
+
+    // Returns the number of frames written (see IPCConfig::AudioOverrunPolicy)
+    int pushAudio(const float* const* channelData, int numChannels, int numSamples)
+    {
+        return audioRing.push(channelData, numChannels, numSamples, IPCConfig::AudioOverrunPolicy);
     }
 
-    void popAudio(juce::AudioBuffer<float>& buffer)
+    // FIX: Partial read instead of all-or-nothing
+    // Read whatever is available, fill remainder with silence.
+    // numSamples < 0 means the whole buffer; pass the DAW block size when the buffer is larger.
+    void popAudio(juce::AudioBuffer<float>& buffer, int numSamples = -1)
     {
         if (!layout) { buffer.clear(); return; }
 
-        int numSamples = buffer.getNumSamples();
-        int readPos = layout->audioReadPos.load();
-        int writePos = layout->audioWritePos.load();
+        if (numSamples < 0 || numSamples > buffer.getNumSamples())
+            numSamples = buffer.getNumSamples();
 
-        int totalSize = IPCConfig::AudioBufferSize * IPCConfig::NumChannels;
-        int availableFloats = (writePos - readPos + totalSize) % totalSize;
-        int availableFrames = availableFloats / IPCConfig::NumChannels;
+        const int read = audioRing.pop(buffer.getArrayOfWritePointers(), buffer.getNumChannels(), numSamples);
 
-        // FIX: Partial read instead of all-or-nothing
-        // Read whatever is available, fill remainder with silence
-        int toRead = juce::jmin(availableFrames, numSamples);
+        if (read < numSamples)
+            countUnderrun();
 
-        auto* l = buffer.getWritePointer(0);
-        auto* r = buffer.getNumChannels() > 1 ? buffer.getWritePointer(1) : nullptr;
+        wakePumpIfLow();
+    }
 
-        for (int i = 0; i < toRead; ++i)
-        {
-            float left = layout->audioBuffer[readPos];
-            readPos = (readPos + 1) % totalSize;
-            
-            float right = layout->audioBuffer[readPos];
-            readPos = (readPos + 1) % totalSize;
-
-            l[i] = left;
-            if (r) r[i] = right;
-        }
+    // Plugin: reads up to numFrames without padding. Returns the number of frames read.
+    int readAudio(float* const* dest, int numChannels, int numFrames)
+    {
+        if (!layout) return 0;
+        const int read = audioRing.read(dest, numChannels, numFrames);
+        wakePumpIfLow();
+        return read;
+    }
 
-        // Fill remaining with silence (if underrun)
-        if (toRead < numSamples)
-        {
-            for (int i = toRead; i < numSamples; ++i)
-            {
-                l[i] = 0.0f;
-                if (r) r[i] = 0.0f;
-            }
-        }
+    // Plugin: skips up to numFrames of buffered audio. Returns the number of frames skipped.
+    int discardAudio(int numFrames)
+    {
+        const int skipped = audioRing.discard(numFrames);
+        wakePumpIfLow();
+        return skipped;
+    }
 
-        layout->audioReadPos.store(readPos);
+    // Plugin: a DAW block had to be padded with silence
+    void countUnderrun()
+    {
+        if (layout) layout->audioUnderrunBlocks.fetch_add(1, std::memory_order_relaxed);
     }
 
+    uint32_t getAudioDroppedFrames() const   { return layout ? layout->audioDroppedFrames.load(std::memory_order_relaxed) : 0; }
+    uint32_t getAudioUnderrunBlocks() const  { return layout ? layout->audioUnderrunBlocks.load(std::memory_order_relaxed) : 0; }
+
+    // ==============================================================================
+    // DOORBELL / PUMP PACING
+    // ==============================================================================
+
+    void ringDoorbell() { if (doorbell != nullptr) doorbell->ring(); }
+
+    // Wake the pump early if it sleeps and we are eating into its safety margin
+    void wakePumpIfLow()
+    {
+        if (layout != nullptr && doorbell != nullptr && doorbell->hasWaiter()
+            && audioRing.getNumReady() < layout->audioWakeThresholdFrames.load(std::memory_order_relaxed))
+            doorbell->ring();
+    }
+
+    // Engine: the plugin rings once the ring fill drops below this many frames
+    void setAudioWakeThreshold(int frames)
+    {
+        if (layout) layout->audioWakeThresholdFrames.store((uint32_t)juce::jmax(0, frames), std::memory_order_relaxed);
+    }
+
+    bool hasPendingCommand() const { return commandQueue.hasPending(); }
+
     // ==============================================================================
     // COMMAND METHODS - FIX FOR HEBREW/UNICODE
     // ==============================================================================
 
-    void sendCommand(const juce::String& jsonCommand)
+    // Message sequence number, shared by every producer in every process
+    uint32_t nextSequence() { return commandQueue.allocateSequence(); }
+
+    // Raw message (binary protocol or UTF-8 JSON). RealTime and Background callers never block;
+    // Message callers wait up to CommandSendTimeoutMs for space. Returns false if it was dropped.
+    bool sendCommand(const void* data, size_t size, IPCCaller caller = IPCCaller::Message)
     {
-        if (!layout) return;
-        int writeIdx = layout->commandWriteIndex.load();
-        int nextWriteIdx = (writeIdx + 1) % IPCConfig::CommandQueueSize;
+        if (!layout) return false;
 
-        // Check if queue is full
-        if (nextWriteIdx == layout->commandReadIndex.load()) return;
+        if (size > (size_t)IPCConfig::CommandBufferSize)
+        {
+            jassertfalse;   // The engine could never read it back; count it against the caller
+            commandQueue.recordDrop(caller);
+            return false;
+        }
+
+        const auto sequence = messageSequence(data, size);
+        const bool sent = (caller == IPCCaller::Message)
+            ? commandQueue.push(data, (uint32_t)size, sequence, caller, IPCConfig::CommandSendTimeoutMs)
+            : commandQueue.tryPush(data, (uint32_t)size, sequence, caller);
+
+        ringDoorbell();   // Even on failure: the engine should drain what is queued
+        return sent;
+    }
 
-        auto& slot = layout->commands[writeIdx];
-        
+    // JSON text (debug fallback)
+    bool sendCommand(const juce::String& jsonCommand, IPCCaller caller = IPCCaller::Message)
+    {
         // FIX: Use strlen to get actual UTF-8 byte count, not character count
         const char* utf8Data = jsonCommand.toRawUTF8();
         size_t utf8ByteLength = strlen(utf8Data);
-        size_t bytesToCopy = juce::jmin(utf8ByteLength, (size_t)(IPCConfig::CommandBufferSize - 1));
-        
-        memset(slot.data, 0, IPCConfig::CommandBufferSize);
-        memcpy(slot.data, utf8Data, bytesToCopy);
-        
-        slot.ready.store(true);
-        layout->commandWriteIndex.store(nextWriteIdx);
-    }
-
-    juce::String getNextCommand()
-    {
-        if (!layout) return {};
-        int readIdx = layout->commandReadIndex.load();
-        int writeIdx = layout->commandWriteIndex.load();
-        
-        if (readIdx == writeIdx) return {};
-        auto& slot = layout->commands[readIdx];
-        if (!slot.ready.load()) return {};
-        
-        // FIX: Explicitly construct UTF-8 string
-        juce::String cmd = juce::String::fromUTF8(slot.data);
-        
-        slot.ready.store(false);
-        layout->commandReadIndex.store((readIdx + 1) % IPCConfig::CommandQueueSize);
-        
-        return cmd;
+        return sendCommand(utf8Data, utf8ByteLength, caller);
+    }
+
+    // Copies the next message into dest (no allocation). Returns the number of bytes, 0 if none.
+    size_t getNextCommand(char* dest, size_t capacity, uint32_t* sequenceOut = nullptr)
+    {
+        return commandQueue.pop(dest, (uint32_t)juce::jmin(capacity, (size_t)0xFFFFFFFFu), sequenceOut);
     }
 
+    uint32_t getCommandsSent(IPCCaller c) const    { return commandQueue.getSentCount(c); }
+    uint32_t getCommandsDropped(IPCCaller c) const { return commandQueue.getDroppedCount(c); }
+
     // ==============================================================================
     // STATUS SYNC
     // ==============================================================================
     
-    // Updated setEngineStatus to include Window Visibility
-    void setEngineStatus(bool playing, bool finished, bool winOpen, float pos, int64_t len)
+    // Engine pump thread (single writer)
+    void setEngineStatus(const EngineStatusSnapshot& snapshot)
+    {
+        if (layout) layout->status.write(snapshot);
+    }
+
+    // Any plugin thread. Returns false if nothing consistent was available - keep the previous snapshot.
+    bool getEngineStatus(EngineStatusSnapshot& snapshot) const
+    {
+        return layout != nullptr && layout->status.read(snapshot);
+    }
+
+    // ==============================================================================
+    // LIVENESS
+    // ==============================================================================
+
+    // Bumps this side's counter - no command, no parsing, one relaxed add
+    void beatHeartbeat()
     {
         if (!layout) return;
-        layout->isPlaying.store(playing);
-        layout->hasFinished.store(finished);
-        layout->isWindowOpen.store(winOpen);
-        layout->currentPosition.store(pos);
-        layout->currentLengthMs.store(len);
+        auto& own = currentMode == Mode::Engine_Server ? layout->engineHeartbeat : layout->pluginHeartbeat;
+        own.fetch_add(1, std::memory_order_relaxed);
     }
 
-    struct EngineStatus { bool playing; bool finished; bool winOpen; float pos; int64_t len; };
-    EngineStatus getEngineStatus()
+    // The other side's counter. Only whether it moved matters; time it on your own clock.
+    uint32_t getPeerHeartbeat() const
     {
-        if (!layout) return { false, false, false, 0.0f, 0 };
-        return { 
-            layout->isPlaying.load(), 
-            layout->hasFinished.load(), 
-            layout->isWindowOpen.load(),
-            layout->currentPosition.load(), 
-            layout->currentLengthMs.load() 
-        };
+        if (!layout) return 0;
+        const auto& peer = currentMode == Mode::Engine_Server ? layout->pluginHeartbeat : layout->engineHeartbeat;
+        return peer.load(std::memory_order_relaxed);
     }
 
 private:
+    // Binary messages already carry a sequence number; reuse it so both ends log the same one
+    uint32_t messageSequence(const void* data, size_t size)
+    {
+        if (IPCProtocol::isBinary(data, size) && size >= sizeof(IPCProtocol::MessageHeader))
+        {
+            IPCProtocol::MessageHeader h;
+            std::memcpy(&h, data, sizeof(h));
+            return h.sequence;
+        }
+        return nextSequence();
+    }
+
+    static bool validateHeader(const SharedMemoryHeader& h, size_t mappedSize)
+    {
+        if (h.magic.load(std::memory_order_acquire) != IPCConfig::LayoutMagic) return false;
+        if (h.layoutVersion != IPCConfig::LayoutVersion) return false;
+        if (h.layoutSize != (uint32_t)sizeof(SharedMemoryLayout)) return false;
+        if (h.audioOffset != (uint32_t)SharedMemoryLayout::getAudioOffset()) return false;
+        if (h.numChannels < 1 || h.numChannels > (uint32_t)IPCConfig::MaxChannels) return false;
+
+        const auto frames = h.ringCapacityFrames;
+        if (frames == 0 || (frames & (frames - 1)) != 0) return false;
+
+        const auto expected = (uint64_t)h.audioOffset + (uint64_t)frames * h.numChannels * sizeof(float);
+        return h.totalSize == expected && (uint64_t)mappedSize >= expected;
+    }
+
     Mode currentMode;
-    std::unique_ptr<juce::MemoryMappedFile> mappedFile;
+    juce::String segmentName;
+    IPCConfig::AudioFormat requestedFormat = IPCConfig::getDeploymentAudioFormat();
+    SharedMemorySegment segment;
     SharedMemoryLayout* layout = nullptr;
+    SpscAudioRing audioRing;
+    MpscMessageQueue commandQueue;
+    IPCDoorbell* doorbell = nullptr;
 };
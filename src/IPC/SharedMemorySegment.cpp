@@ -0,0 +1,252 @@
+/*
+  ==============================================================================
+
+    SharedMemorySegment.cpp
+    Playlisted2
+
+  ==============================================================================
+*/
+
+#include "SharedMemorySegment.h"
+
+#if JUCE_WINDOWS
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace
+{
+   #if JUCE_WINDOWS
+    juce::String getSystemName(const juce::String& name)
+    {
+        return "Local\\" + name;
+    }
+   #elif JUCE_MAC
+    // macOS limits shm names to 31 characters (PSHMNAMLEN) - use a stable hash of the logical name
+    juce::String getSystemName(const juce::String& name)
+    {
+        uint64_t hash = 1469598103934665603ULL;   // FNV-1a
+        for (auto* p = name.toRawUTF8(); *p != 0; ++p)
+        {
+            hash ^= (uint8_t)*p;
+            hash *= 1099511628211ULL;
+        }
+        return "/PL2_" + juce::String::toHexString((juce::int64)hash);
+    }
+   #else
+    juce::String getSystemName(const juce::String& name)
+    {
+        return "/" + name;
+    }
+   #endif
+}
+
+bool SharedMemorySegment::create(const juce::String& name, size_t newSize)
+{
+    close();
+    if (newSize == 0) return false;
+
+   #if JUCE_WINDOWS
+    const auto systemName = getSystemName(name);
+    mappingHandle = CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                                       (DWORD)((uint64_t)newSize >> 32), (DWORD)((uint64_t)newSize & 0xFFFFFFFFu),
+                                       systemName.toWideCharPointer());
+    if (mappingHandle == nullptr) return false;
+
+    // A stale mapping someone still holds open: it may be smaller, and it is not zeroed
+    if (GetLastError() == ERROR_ALREADY_EXISTS)
+    {
+        if (!mapHandle(0) || size < newSize) { close(); return false; }
+        std::memset(data, 0, newSize);
+    }
+    else if (!mapHandle(newSize))
+    {
+        close();
+        return false;
+    }
+   #else
+    const auto systemName = getSystemName(name);
+    ::shm_unlink(systemName.toRawUTF8());   // Drop a stale object from a crashed run
+
+    fd = ::shm_open(systemName.toRawUTF8(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) return false;
+
+    if (::ftruncate(fd, (off_t)newSize) != 0 || !mapHandle(newSize))
+    {
+        ::shm_unlink(systemName.toRawUTF8());
+        close();
+        return false;
+    }
+   #endif
+
+    segmentName = name;
+    ownsName = true;
+    return true;
+}
+
+bool SharedMemorySegment::open(const juce::String& name)
+{
+    close();
+
+   #if JUCE_WINDOWS
+    mappingHandle = OpenFileMappingW(FILE_MAP_ALL_ACCESS, FALSE, getSystemName(name).toWideCharPointer());
+    if (mappingHandle == nullptr) return false;
+    if (!mapHandle(0)) { close(); return false; }
+   #else
+    fd = ::shm_open(getSystemName(name).toRawUTF8(), O_RDWR, 0600);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size <= 0 || !mapHandle((size_t)st.st_size))
+    {
+        close();
+        return false;
+    }
+   #endif
+
+    segmentName = name;
+    return true;
+}
+
+bool SharedMemorySegment::openOrCreate(const juce::String& name, size_t minSize)
+{
+    close();
+    if (minSize == 0) return false;
+
+   #if JUCE_WINDOWS
+    mappingHandle = CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                                       (DWORD)((uint64_t)minSize >> 32), (DWORD)((uint64_t)minSize & 0xFFFFFFFFu),
+                                       getSystemName(name).toWideCharPointer());
+    if (mappingHandle == nullptr) return false;
+    if (!mapHandle(0) || size < minSize) { close(); return false; }
+   #else
+    fd = ::shm_open(getSystemName(name).toRawUTF8(), O_CREAT | O_RDWR, 0600);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0) { close(); return false; }
+
+    // Growing to the same size concurrently is harmless; never shrink what someone else maps
+    size_t mapSize = (size_t)st.st_size;
+    if (mapSize < minSize)
+    {
+        if (::ftruncate(fd, (off_t)minSize) != 0) { close(); return false; }
+        mapSize = minSize;
+    }
+
+    if (!mapHandle(mapSize)) { close(); return false; }
+   #endif
+
+    segmentName = name;
+    return true;
+}
+
+bool SharedMemorySegment::mapHandle(size_t mapSize)
+{
+   #if JUCE_WINDOWS
+    data = MapViewOfFile(mappingHandle, FILE_MAP_ALL_ACCESS, 0, 0, mapSize);
+    if (data == nullptr) return false;
+
+    MEMORY_BASIC_INFORMATION info;
+    if (VirtualQuery(data, &info, sizeof(info)) == 0) return false;
+    size = (mapSize != 0) ? mapSize : (size_t)info.RegionSize;
+    return true;
+   #else
+    void* mapped = ::mmap(nullptr, mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapped == MAP_FAILED) return false;
+
+    data = mapped;
+    size = mapSize;
+    return true;
+   #endif
+}
+
+void SharedMemorySegment::close()
+{
+   #if JUCE_WINDOWS
+    if (data != nullptr)
+    {
+        if (locked) VirtualUnlock(data, size);
+        UnmapViewOfFile(data);
+    }
+    if (mappingHandle != nullptr) CloseHandle(mappingHandle);
+    mappingHandle = nullptr;
+   #else
+    if (data != nullptr)
+    {
+        if (locked) ::munlock(data, size);
+        ::munmap(data, size);
+    }
+    if (fd >= 0) ::close(fd);
+    fd = -1;
+
+    if (ownsName) ::shm_unlink(getSystemName(segmentName).toRawUTF8());
+   #endif
+
+    data = nullptr;
+    size = 0;
+    locked = false;
+    ownsName = false;
+    segmentName = {};
+}
+
+bool SharedMemorySegment::lockInMemory()
+{
+    if (data == nullptr) return false;
+    if (locked) return true;
+
+   #if JUCE_WINDOWS
+    // The default minimum working set is small; grow it by the segment size first
+    SIZE_T minWs = 0, maxWs = 0;
+    auto process = GetCurrentProcess();
+    if (GetProcessWorkingSetSize(process, &minWs, &maxWs))
+        SetProcessWorkingSetSize(process, minWs + size, juce::jmax(maxWs, minWs + size));
+    locked = VirtualLock(data, size) != 0;
+   #else
+    locked = ::mlock(data, size) == 0;
+   #endif
+    return locked;
+}
+
+void SharedMemorySegment::prefault(bool write)
+{
+    if (data == nullptr) return;
+
+    constexpr size_t pageSize = 4096;   // Smallest page size we run on; larger pages are just touched more than once
+    auto* bytes = static_cast<volatile uint8_t*>(data);
+
+    for (size_t offset = 0; offset < size; offset += pageSize)
+    {
+        if (write) bytes[offset] = bytes[offset];   // Fresh segment: nobody else uses it yet
+        else       (void)bytes[offset];
+    }
+}
+
+bool SharedMemorySegment::remove(const juce::String& name)
+{
+   #if JUCE_WINDOWS
+    juce::ignoreUnused(name);
+    return true;   // Named mappings disappear with their last handle
+   #else
+    return ::shm_unlink(getSystemName(name).toRawUTF8()) == 0;
+   #endif
+}
+
+juce::StringArray SharedMemorySegment::findSegments(const juce::String& prefix)
+{
+    juce::StringArray names;
+
+   #if JUCE_LINUX
+    for (const auto& entry : juce::RangedDirectoryIterator(juce::File("/dev/shm"), false, prefix + "*",
+                                                           juce::File::findFiles))
+        names.add(entry.getFile().getFileName());
+   #else
+    juce::ignoreUnused(prefix);
+   #endif
+
+    return names;
+}
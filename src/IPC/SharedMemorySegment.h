@@ -0,0 +1,77 @@
+/*
+  ==============================================================================
+
+    SharedMemorySegment.h
+    Playlisted2
+
+    Named, RAM-backed shared memory - no file on disk, so the kernel never
+    writes dirty pages back during a show and creating a segment costs no
+    disk I/O (new pages are zero-filled by the OS).
+
+    - Linux / macOS: POSIX shm_open + mmap (tmpfs on Linux)
+    - Windows:       pagefile-backed named file mapping (Local\ namespace)
+
+    The creator owns the name and removes it on close. Windows mappings die
+    with their last handle; POSIX objects outlive a crash, so creators also
+    remove any leftover object of the same name first, and
+    findSegments()/remove() let the engine sweep orphans on startup.
+    Both sides prefault() their mapping once, outside the audio path.
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <juce_core/juce_core.h>
+
+class SharedMemorySegment
+{
+public:
+    SharedMemorySegment() = default;
+    ~SharedMemorySegment() { close(); }
+
+    // Creates a fresh, zeroed segment (replacing any stale one with that name). Owner side.
+    bool create(const juce::String& name, size_t size);
+
+    // Maps an existing segment. Fails if it does not exist (yet).
+    bool open(const juce::String& name);
+
+    // Maps the segment, creating it if needed and growing it to at least size (never shrinks)
+    bool openOrCreate(const juce::String& name, size_t size);
+
+    // Unmaps; the creator also removes the name
+    void close();
+
+    bool isOpen() const       { return data != nullptr; }
+    void* getData() const     { return data; }
+    size_t getSize() const    { return size; }
+
+    // Pins the mapping in RAM (mlock / VirtualLock). Optional - may fail without privileges.
+    bool lockInMemory();
+
+    // Touches every page so the real-time paths never take the first-use page fault.
+    // The creator writes (fresh segment, allocates the pages); others only read.
+    void prefault(bool write);
+
+    // Removes a segment by name. Processes that still map it keep their mapping.
+    static bool remove(const juce::String& name);
+
+    // Names of existing segments starting with prefix, where the OS can list them (Linux only).
+    static juce::StringArray findSegments(const juce::String& prefix);
+
+private:
+    bool mapHandle(size_t mapSize);
+
+    void* data = nullptr;
+    size_t size = 0;
+    bool locked = false;
+    bool ownsName = false;
+    juce::String segmentName;
+
+   #if JUCE_WINDOWS
+    void* mappingHandle = nullptr;
+   #else
+    int fd = -1;
+   #endif
+
+    JUCE_DECLARE_NON_COPYABLE(SharedMemorySegment)
+};
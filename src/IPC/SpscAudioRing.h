@@ -0,0 +1,285 @@
+/*
+  ==============================================================================
+
+    SpscAudioRing.h
+    Playlisted2
+
+    Single-producer / single-consumer interleaved float ring for the IPC audio
+    path. The ring is a non-owning view: indices and storage live inside the
+    shared memory segment, so the same code runs in the engine (producer) and
+    in the plugin (consumer).
+
+    - Indices are free-running frame counters (wrap at 2^32), masked by a
+      power-of-two capacity. No modulo per sample, no wasted slot.
+    - Each side owns one index: relaxed load of its own, acquire load of the
+      other, release store when publishing.
+    - Copies are done in at most two contiguous segments.
+    - Overrun never overwrites unread audio; the producer either drops the
+      part that does not fit or rejects the whole block (see OverrunPolicy).
+
+    Deliberately free of JUCE so it can be used by the standalone benchmarks.
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+class SpscAudioRing
+{
+public:
+    // What the producer does when a block does not fit in the free space
+    enum class OverrunPolicy
+    {
+        DropIncoming,   // Write what fits, drop the tail of the block
+        RejectBlock     // Write nothing unless the whole block fits
+    };
+
+    static_assert(std::atomic<uint32_t>::is_always_lock_free,
+                  "Shared memory ring requires lock-free 32-bit atomics");
+
+    SpscAudioRing() = default;
+
+    // capacityFrames must be a power of two. storage must hold capacityFrames * numChannels floats.
+    void attach(std::atomic<uint32_t>* writeIndex, std::atomic<uint32_t>* readIndex,
+                float* storage, uint32_t capacityFrames, int numChannels,
+                std::atomic<uint32_t>* overrunCounter = nullptr) noexcept
+    {
+        if (capacityFrames == 0 || (capacityFrames & (capacityFrames - 1)) != 0 || numChannels <= 0)
+        {
+            detach();
+            return;
+        }
+
+        writePos = writeIndex;
+        readPos = readIndex;
+        data = storage;
+        capacity = capacityFrames;
+        mask = capacityFrames - 1;
+        channels = numChannels;
+        droppedFrames = overrunCounter;
+    }
+
+    void detach() noexcept
+    {
+        writePos = readPos = nullptr;
+        data = nullptr;
+        capacity = mask = 0;
+        channels = 0;
+        droppedFrames = nullptr;
+    }
+
+    bool isValid() const noexcept { return data != nullptr; }
+    uint32_t getCapacity() const noexcept { return capacity; }
+    int getNumChannels() const noexcept { return channels; }
+
+    uint32_t getNumReady() const noexcept
+    {
+        if (!isValid()) return 0;
+        const uint32_t w = writePos->load(std::memory_order_acquire);
+        const uint32_t r = readPos->load(std::memory_order_acquire);
+        return std::min(w - r, capacity);
+    }
+
+    uint32_t getNumFree() const noexcept { return isValid() ? capacity - getNumReady() : 0; }
+
+    // ==============================================================================
+    // PRODUCER SIDE
+    // ==============================================================================
+
+    // Returns the number of frames actually written.
+    int push(const float* const* channelData, int numSrcChannels, int numFrames,
+             OverrunPolicy policy = OverrunPolicy::DropIncoming) noexcept
+    {
+        if (!isValid() || numFrames <= 0) return 0;
+
+        const uint32_t w = writePos->load(std::memory_order_relaxed);
+        const uint32_t r = readPos->load(std::memory_order_acquire);
+        const uint32_t space = capacity - (w - r);
+
+        uint32_t toWrite = std::min((uint32_t)numFrames, space);
+        if (policy == OverrunPolicy::RejectBlock && toWrite < (uint32_t)numFrames)
+            toWrite = 0;
+
+        if (toWrite < (uint32_t)numFrames && droppedFrames != nullptr)
+            droppedFrames->fetch_add((uint32_t)numFrames - toWrite, std::memory_order_relaxed);
+
+        if (toWrite == 0) return 0;
+
+        const uint32_t start = w & mask;
+        const uint32_t size1 = std::min(toWrite, capacity - start);
+        const uint32_t size2 = toWrite - size1;
+
+        interleave(channelData, numSrcChannels, 0, data + (size_t)start * channels, size1);
+        if (size2 > 0)
+            interleave(channelData, numSrcChannels, size1, data, size2);
+
+        writePos->store(w + toWrite, std::memory_order_release);
+        return (int)toWrite;
+    }
+
+    // ==============================================================================
+    // CONSUMER SIDE
+    // ==============================================================================
+
+    // Reads up to numFrames into dest, pads the remainder with silence.
+    // Returns the number of frames actually read.
+    int pop(float* const* dest, int numDestChannels, int numFrames) noexcept
+    {
+        if (numFrames <= 0) return 0;
+
+        const int got = read(dest, numDestChannels, numFrames);
+
+        if (got < numFrames)
+            clear(dest, numDestChannels, got, numFrames - got);
+
+        return got;
+    }
+
+    // Reads up to numFrames into dest and leaves the rest of dest untouched.
+    // Returns the number of frames actually read.
+    int read(float* const* dest, int numDestChannels, int numFrames) noexcept
+    {
+        if (!isValid() || numFrames <= 0) return 0;
+
+        const uint32_t r = readPos->load(std::memory_order_relaxed);
+        const uint32_t w = writePos->load(std::memory_order_acquire);
+        const uint32_t available = std::min(w - r, capacity);
+        const uint32_t toRead = std::min((uint32_t)numFrames, available);
+
+        if (toRead > 0)
+        {
+            const uint32_t start = r & mask;
+            const uint32_t size1 = std::min(toRead, capacity - start);
+            const uint32_t size2 = toRead - size1;
+
+            deinterleave(data + (size_t)start * channels, dest, numDestChannels, 0, size1);
+            if (size2 > 0)
+                deinterleave(data, dest, numDestChannels, size1, size2);
+
+            readPos->store(r + toRead, std::memory_order_release);
+        }
+
+        return (int)toRead;
+    }
+
+    // Skips up to numFrames of unread audio. Returns the number of frames skipped.
+    int discard(int numFrames) noexcept
+    {
+        if (!isValid() || numFrames <= 0) return 0;
+
+        const uint32_t r = readPos->load(std::memory_order_relaxed);
+        const uint32_t w = writePos->load(std::memory_order_acquire);
+        const uint32_t toSkip = std::min((uint32_t)numFrames, std::min(w - r, capacity));
+
+        readPos->store(r + toSkip, std::memory_order_release);
+        return (int)toSkip;
+    }
+
+    // Consumer-side flush: drops everything currently readable.
+    // Safe while the producer keeps running (only touches the read index).
+    void discardReady() noexcept
+    {
+        if (!isValid()) return;
+        readPos->store(writePos->load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+private:
+    void interleave(const float* const* src, int numSrcChannels, uint32_t srcOffset,
+                    float* dst, uint32_t numFrames) const noexcept
+    {
+        if (channels == 1)
+        {
+            if (numSrcChannels > 0 && src[0] != nullptr)
+                std::memcpy(dst, src[0] + srcOffset, numFrames * sizeof(float));
+            else
+                std::memset(dst, 0, numFrames * sizeof(float));
+            return;
+        }
+
+        if (channels == 2 && numSrcChannels >= 2)
+        {
+            const float* l = src[0] + srcOffset;
+            const float* rr = src[1] + srcOffset;
+            for (uint32_t i = 0; i < numFrames; ++i)
+            {
+                dst[2 * i]     = l[i];
+                dst[2 * i + 1] = rr[i];
+            }
+            return;
+        }
+
+        for (int ch = 0; ch < channels; ++ch)
+        {
+            if (ch < numSrcChannels && src[ch] != nullptr)
+            {
+                const float* s = src[ch] + srcOffset;
+                for (uint32_t i = 0; i < numFrames; ++i)
+                    dst[(size_t)i * channels + ch] = s[i];
+            }
+            else
+            {
+                for (uint32_t i = 0; i < numFrames; ++i)
+                    dst[(size_t)i * channels + ch] = 0.0f;
+            }
+        }
+    }
+
+    void deinterleave(const float* src, float* const* dst, int numDestChannels,
+                      uint32_t dstOffset, uint32_t numFrames) const noexcept
+    {
+        if (channels == 1)
+        {
+            for (int ch = 0; ch < numDestChannels; ++ch)
+                if (dst[ch] != nullptr)
+                    std::memcpy(dst[ch] + dstOffset, src, numFrames * sizeof(float));
+            return;
+        }
+
+        if (channels == 2 && numDestChannels >= 2 && dst[0] != nullptr && dst[1] != nullptr)
+        {
+            float* l = dst[0] + dstOffset;
+            float* rr = dst[1] + dstOffset;
+            for (uint32_t i = 0; i < numFrames; ++i)
+            {
+                l[i]  = src[2 * i];
+                rr[i] = src[2 * i + 1];
+            }
+            return;
+        }
+
+        for (int ch = 0; ch < numDestChannels; ++ch)
+        {
+            if (dst[ch] == nullptr) continue;
+            float* d = dst[ch] + dstOffset;
+
+            if (ch < channels)
+            {
+                for (uint32_t i = 0; i < numFrames; ++i)
+                    d[i] = src[(size_t)i * channels + ch];
+            }
+            else
+            {
+                std::memset(d, 0, numFrames * sizeof(float));
+            }
+        }
+    }
+
+    static void clear(float* const* dest, int numDestChannels, int offset, int numFrames) noexcept
+    {
+        for (int ch = 0; ch < numDestChannels; ++ch)
+            if (dest[ch] != nullptr)
+                std::memset(dest[ch] + offset, 0, (size_t)numFrames * sizeof(float));
+    }
+
+    std::atomic<uint32_t>* writePos = nullptr;
+    std::atomic<uint32_t>* readPos = nullptr;
+    std::atomic<uint32_t>* droppedFrames = nullptr;
+    float* data = nullptr;
+    uint32_t capacity = 0;
+    uint32_t mask = 0;
+    int channels = 0;
+};
@@ -41,7 +41,10 @@ public:
             "   - Pitch: Shift the key up or down by 12 semitones.\n"
             "   - Speed: Change playback rate.\n"
             "   - Wait: Set a delay (in seconds). When the track ends, Playlisted will count down this duration before automatically "
-            "starting the next track.\n\n"
+            "starting the next track. With Wait at 0 the next track follows without any gap. Waits are timed to the sample "
+            "and Auto-Play keeps advancing while the plugin window is closed.\n"
+            "   - F (Crossfade): When lit, this track fades into the next one instead of waiting. Set the fade length and "
+            "its curve (Equal Power, Linear, S-Curve) in the row that replaces Wait.\n\n"
             "3. Playback:\n"
             "   Click the Green Triangle on any track to load and select it. Use the main PLAY/STOP buttons at the bottom to control playback.\n\n"
             "4. Video:\n"
@@ -123,11 +123,9 @@ void MediaPage::timerCallback()
     }
 
     double lenMs = (double)player.getLengthMs();
-    double posRatio = player.getPosition();
-    double currentMs = lenMs * posRatio;
 
     totalTimeLabel.setText(formatTime(lenMs / 1000.0), juce::dontSendNotification);
-    currentTimeLabel.setText(formatTime(currentMs / 1000.0), juce::dontSendNotification);
+    currentTimeLabel.setText(formatTime(player.getPositionSeconds()), juce::dontSendNotification);
 
     int remaining = playlistComponent->getWaitSecondsRemaining();
     if (remaining > 0)
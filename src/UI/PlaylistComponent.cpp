@@ -23,10 +23,10 @@ PlaylistComponent::PlaylistComponent(AudioEngine& engine, IOSettingsManager& set
 
     addAndMakeVisible(autoPlayToggle);
     autoPlayToggle.setButtonText("Auto-Play");
-    autoPlayToggle.setToggleState(true, dontSendNotification);
+    autoPlayToggle.setToggleState(audioEngine.isAutoPlayEnabled(), dontSendNotification);
     autoPlayToggle.setColour(ToggleButton::textColourId, Colours::white);
     autoPlayToggle.setColour(ToggleButton::tickColourId, Colour(0xFFD4AF37));
-    autoPlayToggle.onClick = [this] { autoPlayEnabled = autoPlayToggle.getToggleState(); };
+    autoPlayToggle.onClick = [this] { audioEngine.setAutoPlayEnabled(autoPlayToggle.getToggleState()); };
 
     // --- BUTTON ROW INITIALIZATION (5 Buttons) ---
     
@@ -199,7 +199,6 @@ void PlaylistComponent::clearPlaylist()
     currentTrackIndex = -1;
     audioEngine.setActiveTrackIndex(-1);
     // [FIX] Clear engine state too
-    waitingForTransition = false;
     audioEngine.stopAllPlayback();
     rebuildList();
 }
@@ -214,7 +213,6 @@ void PlaylistComponent::removeTrack(int index)
         {
             currentTrackIndex = -1;
             audioEngine.setActiveTrackIndex(-1);
-            waitingForTransition = false;
             audioEngine.stopAllPlayback();
         }
         else if (currentTrackIndex > index)
@@ -231,24 +229,17 @@ void PlaylistComponent::selectTrack(int index)
     if (index < 0 || index >= (int)playlist.size()) return;
     
     currentTrackIndex = index;
-    audioEngine.setActiveTrackIndex(index);
-    // [FIX] Persist selection to Engine
-    
-    waitingForTransition = false;
-    
-    auto& item = playlist[index];
-    audioEngine.getMediaPlayer().loadFile(item.filePath);
-    audioEngine.getMediaPlayer().setVolume(item.volume);
-    audioEngine.getMediaPlayer().setRate(item.playbackSpeed);
-    audioEngine.setPitchSemitones(item.pitchSemitones);
+    // [FIX] Persist selection to Engine (it loads the track and re-arms the next one)
+    audioEngine.selectTrack(index);
     
     updateBannerVisuals();
 }
 
 void PlaylistComponent::playTrack(int index)
 {
-    selectTrack(index); 
-    audioEngine.getMediaPlayer().play();
+    currentTrackIndex = index;
+    audioEngine.playTrack(index);
+    updateBannerVisuals();
 }
 
 void PlaylistComponent::scrollToBanner(int index)
@@ -330,56 +321,14 @@ void PlaylistComponent::timerCallback()
         }
     }
 
-    if (autoPlayEnabled && currentTrackIndex >= 0 && currentTrackIndex < (int)playlist.size())
+    // Auto-advance runs in AudioEngine (and the engine) - just follow its active track
+    const int active = audioEngine.getActiveTrackIndex();
+    if (active != currentTrackIndex)
     {
-        auto& player = audioEngine.getMediaPlayer();
-        bool hasFinished = player.hasFinished();
-        
-        if (waitingForTransition)
-        {
-            if (transitionCountdown > 0)
-            {
-                transitionCountdown--;
-            }
-            else
-            {
-                waitingForTransition = false;
-                int nextIndex = currentTrackIndex + 1;
-                if (nextIndex < (int)playlist.size())
-                {
-                    playTrack(nextIndex);
-                    if (autoPlayEnabled) scrollToBanner(nextIndex);
-                }
-                else
-                {
-                    audioEngine.stopAllPlayback();
-                }
-            }
-            finishDebounceCounter = 0;
-        }
-        else if (hasFinished) 
-        {
-            finishDebounceCounter++;
-            if (finishDebounceCounter > 6)
-            {
-                auto& currentItem = playlist[currentTrackIndex];
-                int nextIndex = currentTrackIndex + 1;
-                
-                if (nextIndex < (int)playlist.size())
-                {
-                    waitingForTransition = true;
-                    player.pause(); 
-
-                    int sec = currentItem.transitionDelaySec;
-                    transitionCountdown = (sec > 0) ? (sec * 30) : 15;
-                }
-            }
-        }
-        else
-        {
-            finishDebounceCounter = 0;
-        }
+        currentTrackIndex = active;
+        if (audioEngine.isAutoPlayEnabled()) scrollToBanner(currentTrackIndex);
     }
+
     updateBannerVisuals();
 }
 
@@ -409,6 +358,8 @@ void PlaylistComponent::savePlaylist()
                 obj->setProperty("speed", item.playbackSpeed);
                 obj->setProperty("delay", item.transitionDelaySec);
                 obj->setProperty("xfade", item.isCrossfade);
+                obj->setProperty("xfadeSec", item.crossfadeSec);
+                obj->setProperty("xfadeCurve", item.crossfadeCurve);
                 tracks.add(obj.get());
             }
 
@@ -467,6 +418,8 @@ void PlaylistComponent::loadPlaylist()
                                 item.playbackSpeed = (float)obj->getProperty("speed");
                                 item.transitionDelaySec = (int)obj->getProperty("delay");
                                 item.isCrossfade = (bool)obj->getProperty("xfade");
+                                if (obj->hasProperty("xfadeSec")) item.crossfadeSec = (float)obj->getProperty("xfadeSec");
+                                item.crossfadeCurve = (int)obj->getProperty("xfadeCurve");
                                 playlist.push_back(item);
                                 count++;
                             }
@@ -28,10 +28,7 @@ public:
     void selectTrack(int index);
     void clearPlaylist();
     // Returns remaining wait time in seconds (or 0 if not waiting)
-    int getWaitSecondsRemaining() const {
-        if (!waitingForTransition) return 0;
-        return (int)std::ceil(transitionCountdown / 30.0f);
-    }
+    int getWaitSecondsRemaining() const { return audioEngine.getWaitSecondsRemaining(); }
 
 private:
     void timerCallback() override;
@@ -48,13 +45,8 @@ private:
     
     std::vector<PlaylistItem>& playlist; 
 
+    // Mirrors AudioEngine's active track, which auto-advance moves on its own
     int currentTrackIndex = -1;
-    bool autoPlayEnabled = true;
-    bool waitingForTransition = false;
-    int transitionCountdown = 0;
-    
-    // Debounce counter for detecting track finish to prevent "Skip on Speed Change"
-    int finishDebounceCounter = 0;
 
     juce::Label headerLabel;
     juce::ToggleButton autoPlayToggle;
@@ -12,7 +12,9 @@ struct PlaylistItem
     
     float playbackSpeed = 1.0f;
     int transitionDelaySec = 0;
-    bool isCrossfade = false;
+    bool isCrossfade = false;      // Crossfade into the next track instead of waiting
+    float crossfadeSec = 4.0f;
+    int crossfadeCurve = 0;        // IPCProtocol::FadeCurve
     bool isExpanded = false;
 
     // Helper to extract name from path if title empty
@@ -14,7 +14,6 @@ TrackBannerComponent::TrackBannerComponent(int index, PlaylistItem& item,
       onPitchChangeCallback(onPitchChange),
       onSpeedChangeCallback(onSpeedChange)
 {
-    itemData.isCrossfade = false;
     addAndMakeVisible(indexLabel);
     indexLabel.setText(juce::String(index + 1), juce::dontSendNotification);
     indexLabel.setJustificationType(juce::Justification::centred);
@@ -32,10 +31,19 @@ TrackBannerComponent::TrackBannerComponent(int index, PlaylistItem& item,
     removeButton.setColour(juce::TextButton::textColourOffId, juce::Colours::red);
     removeButton.onClick = onRemoveCallback;
 
-    addChildComponent(crossfadeButton);
-    crossfadeButton.setVisible(false);
+    addAndMakeVisible(crossfadeButton);
     crossfadeButton.setButtonText("F");
-    crossfadeButton.setToggleState(false, juce::dontSendNotification);
+    crossfadeButton.setMidiInfo("Crossfade into the next track (instead of Wait)");
+    crossfadeButton.setClickingTogglesState(true);
+    crossfadeButton.setToggleState(itemData.isCrossfade, juce::dontSendNotification);
+    crossfadeButton.setColour(juce::TextButton::buttonColourId, juce::Colours::transparentBlack);
+    crossfadeButton.setColour(juce::TextButton::buttonOnColourId, juce::Colour(0xFF335533));
+    crossfadeButton.setColour(juce::TextButton::textColourOffId, juce::Colours::grey);
+    crossfadeButton.setColour(juce::TextButton::textColourOnId, juce::Colour(0xFF00FF00));
+    crossfadeButton.onClick = [this] {
+        itemData.isCrossfade = crossfadeButton.getToggleState();
+        updateTransitionRow();
+    };
     
     addAndMakeVisible(expandButton);
     expandButton.setButtonText(itemData.isExpanded ? "^" : "v");
@@ -106,13 +114,51 @@ TrackBannerComponent::TrackBannerComponent(int index, PlaylistItem& item,
         };
         addAndMakeVisible(delaySlider.get());
 
+        // --- 4b. CROSSFADE (replaces Wait while F is on) ---
+        fadeSlider = std::make_unique<StyledSlider>(juce::Slider::LinearHorizontal, juce::Slider::TextBoxRight);
+        fadeSlider->setMidiInfo("Crossfade Length into the next track");
+        fadeSlider->setRange(0.5, 20.0, 0.5);
+        fadeSlider->setValue(itemData.crossfadeSec, juce::dontSendNotification);
+        fadeSlider->textFromValueFunction = [](double value) {
+            return juce::String(value, 1) + " s";
+        };
+        fadeSlider->onValueChange = [this] {
+            itemData.crossfadeSec = (float)fadeSlider->getValue();
+        };
+        addChildComponent(fadeSlider.get());
+
+        fadeCurveBox.addItem("Equal Power", 1);
+        fadeCurveBox.addItem("Linear", 2);
+        fadeCurveBox.addItem("S-Curve", 3);
+        fadeCurveBox.setSelectedId(itemData.crossfadeCurve + 1, juce::dontSendNotification);
+        fadeCurveBox.onChange = [this] {
+            itemData.crossfadeCurve = fadeCurveBox.getSelectedId() - 1;
+        };
+        addChildComponent(fadeCurveBox);
+
         addAndMakeVisible(volLabel); volLabel.setText("Vol", juce::dontSendNotification);
         addAndMakeVisible(pitchLabel); pitchLabel.setText("Pitch", juce::dontSendNotification);
         addAndMakeVisible(speedLabel); speedLabel.setText("Speed", juce::dontSendNotification);
         addAndMakeVisible(delayLabel); delayLabel.setText("Wait", juce::dontSendNotification);
+        addChildComponent(fadeLabel); fadeLabel.setText("Fade", juce::dontSendNotification);
+
+        updateTransitionRow();
     }
 }
 
+// Row 4 is either the Wait slider or, with F on, the crossfade length and curve
+void TrackBannerComponent::updateTransitionRow()
+{
+    if (!itemData.isExpanded) return;
+
+    const bool fade = itemData.isCrossfade;
+    delayLabel.setVisible(!fade);
+    delaySlider->setVisible(!fade);
+    fadeLabel.setVisible(fade);
+    fadeSlider->setVisible(fade);
+    fadeCurveBox.setVisible(fade);
+}
+
 void TrackBannerComponent::onLongPress()
 {
     showMidiTooltip(this, "Track: " + itemData.title + "\nLeft-Click Triangle to Load Only");
@@ -158,6 +204,7 @@ void TrackBannerComponent::resized()
     
     expandButton.setBounds(bounds.getWidth() - 30, 10, 20, 20);
     removeButton.setBounds(bounds.getWidth() - 60, 10, 20, 20);
+    crossfadeButton.setBounds(bounds.getWidth() - 90, 10, 20, 20);
 
     if (itemData.isExpanded)
     {
@@ -179,9 +226,14 @@ void TrackBannerComponent::resized()
         speedLabel.setBounds(10, startY + rowH*2, labelW, rowH);
         speedSlider->setBounds(sliderX, startY + rowH*2, sliderW, rowH);
         
-        // Row 4: Wait
+        // Row 4: Wait, or Fade + curve
         delayLabel.setBounds(10, startY + rowH*3, labelW, rowH);
         delaySlider->setBounds(sliderX, startY + rowH*3, sliderW, rowH);
+
+        const int curveW = 100;
+        fadeLabel.setBounds(10, startY + rowH*3, labelW, rowH);
+        fadeSlider->setBounds(sliderX, startY + rowH*3, sliderW - curveW - 5, rowH);
+        fadeCurveBox.setBounds(sliderX + sliderW - curveW, startY + rowH*3 + 4, curveW, rowH - 8);
     }
 }
 
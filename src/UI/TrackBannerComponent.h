@@ -78,6 +78,8 @@ public:
     bool isExpanded() const { return itemData.isExpanded; }
 
 private:
+    void updateTransitionRow();
+
     int trackIndex;
     PlaylistItem& itemData;
     
@@ -98,12 +100,14 @@ private:
     MidiTooltipTextButton expandButton;
     MidiTooltipTextButton crossfadeButton;
 
-    juce::Label volLabel, pitchLabel, speedLabel, delayLabel;
+    juce::Label volLabel, pitchLabel, speedLabel, delayLabel, fadeLabel;
     
     std::unique_ptr<StyledSlider> volSlider;
     std::unique_ptr<StyledSlider> pitchSlider;
     std::unique_ptr<StyledSlider> speedSlider;
     std::unique_ptr<StyledSlider> delaySlider;
+    std::unique_ptr<StyledSlider> fadeSlider;
+    juce::ComboBox fadeCurveBox;
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TrackBannerComponent)
 };
@@ -0,0 +1,143 @@
+/*
+  ==============================================================================
+
+    IpcRingBench.cpp
+    Playlisted2
+
+    Microbenchmark for the DAW side of the IPC audio ring.
+    Measures the cost of one popAudio() block (deinterleave into two channel
+    buffers) for the legacy per-sample "% totalSize" loop and for SpscAudioRing,
+    across typical DAW block sizes. A producer push is done before every pop so
+    the ring never runs dry and the read index wraps regularly.
+
+    Build with -DPLAYLISTED_BUILD_BENCHMARKS=ON, run PlaylistedIpcRingBench.
+    Output is one CSV line per block size.
+
+  ==============================================================================
+*/
+
+#include "IPC/SpscAudioRing.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace
+{
+    const uint32_t RingFrames = 65536;
+    const int NumChannels = 2;
+
+    // Copy of the pre-SPSC implementation, kept only for comparison
+    struct LegacyRing
+    {
+        std::atomic<int> writePos { 0 };
+        std::atomic<int> readPos { 0 };
+        std::vector<float> buffer = std::vector<float>(RingFrames * NumChannels, 0.0f);
+
+        void push(const float* const* channelData, int numSamples)
+        {
+            int w = writePos.load();
+            const int totalSize = (int)RingFrames * NumChannels;
+            for (int i = 0; i < numSamples; ++i)
+                for (int ch = 0; ch < NumChannels; ++ch)
+                {
+                    buffer[(size_t)w] = channelData[ch][i];
+                    w = (w + 1) % totalSize;
+                }
+            writePos.store(w);
+        }
+
+        void pop(float* const* dest, int numSamples)
+        {
+            int r = readPos.load();
+            const int w = writePos.load();
+            const int totalSize = (int)RingFrames * NumChannels;
+            const int availableFrames = ((w - r + totalSize) % totalSize) / NumChannels;
+            const int toRead = availableFrames < numSamples ? availableFrames : numSamples;
+
+            for (int i = 0; i < toRead; ++i)
+            {
+                float left = buffer[(size_t)r];   r = (r + 1) % totalSize;
+                float right = buffer[(size_t)r];  r = (r + 1) % totalSize;
+                dest[0][i] = left;
+                dest[1][i] = right;
+            }
+            for (int i = toRead; i < numSamples; ++i)
+                dest[0][i] = dest[1][i] = 0.0f;
+
+            readPos.store(r);
+        }
+    };
+
+    struct Result { double nsPerBlock; double nsPerFrame; };
+
+    template <typename PushFn, typename PopFn>
+    Result measure(int blockSize, long iterations, PushFn&& push, PopFn&& pop)
+    {
+        using Clock = std::chrono::steady_clock;
+        double popNs = 0.0;
+
+        for (long i = 0; i < iterations; ++i)
+        {
+            push();
+            auto t0 = Clock::now();
+            pop();
+            auto t1 = Clock::now();
+            popNs += (double)std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+        }
+
+        return { popNs / (double)iterations, popNs / ((double)iterations * blockSize) };
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const long totalFrames = (argc > 1) ? std::atol(argv[1]) : 50000000L;
+    const int blockSizes[] = { 32, 64, 128, 256, 512, 1024, 2048, 4096 };
+
+    std::printf("impl,block_size,ns_per_block,ns_per_frame\n");
+
+    for (int blockSize : blockSizes)
+    {
+        const long iterations = totalFrames / blockSize;
+
+        std::vector<float> srcL((size_t)blockSize), srcR((size_t)blockSize);
+        std::vector<float> dstL((size_t)blockSize), dstR((size_t)blockSize);
+        for (int i = 0; i < blockSize; ++i)
+        {
+            srcL[(size_t)i] = (float)i / (float)blockSize;
+            srcR[(size_t)i] = -srcL[(size_t)i];
+        }
+
+        const float* src[] = { srcL.data(), srcR.data() };
+        float* dst[] = { dstL.data(), dstR.data() };
+
+        // --- Legacy ---
+        {
+            LegacyRing legacy;
+            auto r = measure(blockSize, iterations,
+                             [&] { legacy.push(src, blockSize); },
+                             [&] { legacy.pop(dst, blockSize); });
+            std::printf("legacy,%d,%.1f,%.3f\n", blockSize, r.nsPerBlock, r.nsPerFrame);
+        }
+
+        // --- SPSC ---
+        {
+            std::atomic<uint32_t> w { 0 }, rd { 0 }, dropped { 0 };
+            std::vector<float> storage(RingFrames * NumChannels, 0.0f);
+            SpscAudioRing ring;
+            ring.attach(&w, &rd, storage.data(), RingFrames, NumChannels, &dropped);
+
+            auto r = measure(blockSize, iterations,
+                             [&] { ring.push(src, NumChannels, blockSize, SpscAudioRing::OverrunPolicy::RejectBlock); },
+                             [&] { ring.pop(dst, NumChannels, blockSize); });
+            std::printf("spsc,%d,%.1f,%.3f\n", blockSize, r.nsPerBlock, r.nsPerFrame);
+
+            if (dropped.load() != 0)
+                std::fprintf(stderr, "unexpected overrun: %u frames\n", dropped.load());
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,598 @@
+/*
+  ==============================================================================
+
+    IpcStressHarness.cpp
+    Playlisted2
+
+    Cross-process benchmark / stress test for the IPC audio path (Linux).
+    For every configuration the harness forks
+      - a producer that plays the engine: SharedMemoryManager server, pushes
+        512-frame blocks from a decoder running at the sample rate and sleeps
+        on the doorbell with the same deadlines as EngineDeck::pump()
+      - a consumer that plays the DAW: SharedMemoryManager client, wakes on
+        absolute block deadlines (clock_nanosleep), primes to the drift
+        compensator's target fill and reads one block per period
+      - optionally N CPU/memory hogs (contention mode)
+    over real shm segments and the futex doorbell.
+
+    Modes:
+      paced    real-time producer and consumer (latency, jitter, underruns)
+      flatout  both sides as fast as possible (throughput ceiling)
+
+    Per configuration: throughput, end-to-end block latency percentiles
+    (age of the oldest frame in a block), wakeup jitter percentiles, read
+    call cost, underruns and data-integrity errors. Output is CSV (default)
+    or JSON lines; the --max-* options turn it into a regression gate
+    (exit code 1 on violation, 2 on setup failure).
+
+    Build with -DPLAYLISTED_BUILD_BENCHMARKS=ON, run PlaylistedIpcStress --help.
+
+  ==============================================================================
+*/
+
+#include "IPC/SharedMemoryManager.h"
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <new>
+#include <string>
+#include <vector>
+#include <sched.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace
+{
+    const int EngineBlock = 512;                 // EngineDeck::blockSize
+    const int EngineWakeThreshold = EngineBlock * 4;
+    const int EngineMaxTimeoutMs = 10;           // EngineDeck::maxPlayingTimeoutMs
+    const int StampSlots = 4096;                 // > largest ring / EngineBlock
+    const size_t MaxSamples = 1u << 20;          // Per-metric sample buffer (most recent kept)
+    const uint32_t FrameIndexMask = 0xFFFFFF;    // Exactly representable in a float
+
+    enum class Mode { Paced, FlatOut };
+    enum Phase : uint32_t { Setup = 0, Run, Stop };
+
+    struct Config
+    {
+        Mode mode = Mode::Paced;
+        int blockSize = 512;
+        int sampleRate = 48000;
+        int ringFrames = 65536;
+        int contention = 0;
+        double seconds = 2.0;
+    };
+
+    struct Percentiles
+    {
+        double p50 = 0, p90 = 0, p99 = 0, p999 = 0, max = 0;
+    };
+
+    struct ConsumerResult
+    {
+        uint64_t frames = 0;
+        uint64_t blocks = 0;
+        uint64_t underruns = 0;
+        uint64_t corruptFrames = 0;
+        double elapsedSeconds = 0;
+        double primeMs = 0;
+        Percentiles latencyUs, jitterUs, callNs;
+    };
+
+    struct ProducerResult
+    {
+        uint64_t frames = 0;
+        uint64_t wakeups = 0;
+        uint64_t rejectedBlocks = 0;
+    };
+
+    // Lives in its own shm segment (inherited across fork)
+    struct BenchControl
+    {
+        std::atomic<uint32_t> doorbellSequence { 0 };
+        std::atomic<uint32_t> engineWaiting { 0 };
+        std::atomic<uint32_t> phase { Setup };
+        std::atomic<uint32_t> producerReady { 0 };
+        std::atomic<uint32_t> consumerReady { 0 };
+        std::atomic<uint64_t> startUs { 0 };
+        std::atomic<uint64_t> blockStampUs[StampSlots] = {};
+
+        ConsumerResult consumer;
+        ProducerResult producer;
+    };
+
+    uint64_t nowUs()   { return IPCProtocol::nowMicros(); }
+
+    uint64_t nowNs()
+    {
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+    }
+
+    void sleepUntilNs(uint64_t deadlineNs)
+    {
+        timespec ts;
+        ts.tv_sec = (time_t)(deadlineNs / 1000000000ull);
+        ts.tv_nsec = (long)(deadlineNs % 1000000000ull);
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {}
+    }
+
+    // Fixed-capacity sample buffer; keeps the most recent MaxSamples values
+    struct Samples
+    {
+        std::vector<double> values;
+        size_t next = 0;
+        bool wrapped = false;
+
+        Samples() { values.resize(MaxSamples); }
+
+        void add(double v)
+        {
+            values[next] = v;
+            if (++next == values.size()) { next = 0; wrapped = true; }
+        }
+
+        Percentiles compute()
+        {
+            Percentiles p;
+            const size_t n = wrapped ? values.size() : next;
+            if (n == 0) return p;
+
+            std::vector<double> sorted(values.begin(), values.begin() + (std::ptrdiff_t)n);
+            std::sort(sorted.begin(), sorted.end());
+            auto at = [&](double q) { return sorted[std::min(n - 1, (size_t)(q * (double)(n - 1) + 0.5))]; };
+            p.p50 = at(0.50); p.p90 = at(0.90); p.p99 = at(0.99); p.p999 = at(0.999); p.max = sorted[n - 1];
+            return p;
+        }
+    };
+
+    void waitForPhase(BenchControl& ctl, uint32_t phase)
+    {
+        while (ctl.phase.load(std::memory_order_acquire) < phase)
+            usleep(100);
+    }
+
+    // ==============================================================================
+    // PRODUCER (engine role)
+    // ==============================================================================
+    int runProducer(const Config& cfg, BenchControl& ctl, const juce::String& segmentName)
+    {
+        IPCDoorbell bell;
+        bell.open("bench", &ctl.doorbellSequence, &ctl.engineWaiting, true);
+
+        SharedMemoryManager ipc(SharedMemoryManager::Mode::Engine_Server, segmentName);
+        IPCConfig::AudioFormat format;
+        format.ringFrames = cfg.ringFrames;
+        format.numChannels = 2;
+        ipc.setRequestedAudioFormat(format);
+        ipc.setDoorbell(&bell);
+        if (!ipc.initialize()) return 2;
+
+        ipc.setAudioWakeThreshold(EngineWakeThreshold);
+        ipc.setDawSampleRate(cfg.sampleRate);
+        ctl.producerReady.store(1, std::memory_order_release);
+
+        std::vector<float> left(EngineBlock), right(EngineBlock);
+        const float* block[] = { left.data(), right.data() };
+        uint64_t produced = 0, wakeups = 0, rejected = 0;
+
+        waitForPhase(ctl, Run);
+        const uint64_t start = ctl.startUs.load(std::memory_order_acquire);
+
+        auto decoded = [&]() -> uint64_t
+        {
+            if (cfg.mode == Mode::FlatOut) return produced + EngineBlock;
+            return (nowUs() - start) * (uint64_t)cfg.sampleRate / 1000000ull;
+        };
+
+        auto hasWork = [&]
+        {
+            return decoded() >= produced + EngineBlock && ipc.getAudioFramesFree() >= EngineBlock;
+        };
+
+        while (ctl.phase.load(std::memory_order_acquire) == Run)
+        {
+            ++wakeups;
+
+            while (hasWork() && ctl.phase.load(std::memory_order_relaxed) == Run)
+            {
+                for (int i = 0; i < EngineBlock; ++i)
+                {
+                    left[(size_t)i] = (float)((produced + (uint64_t)i) & FrameIndexMask);
+                    right[(size_t)i] = -left[(size_t)i];
+                }
+
+                ctl.blockStampUs[(produced / EngineBlock) % StampSlots].store(nowUs(), std::memory_order_relaxed);
+                if (ipc.pushAudio(block, 2, EngineBlock) < EngineBlock) { ++rejected; break; }
+                produced += EngineBlock;
+            }
+
+            if (cfg.mode == Mode::FlatOut)
+            {
+                if (ipc.getAudioFramesFree() < EngineBlock) sched_yield();
+                continue;
+            }
+
+            // Same pacing as EngineDeck::pump(): wake before the buffered audio falls to the threshold
+            const int marginFrames = ipc.getAudioFramesReady() - EngineWakeThreshold;
+            const int marginMs = (int)((int64_t)marginFrames * 1000 / cfg.sampleRate);
+            const int timeoutMs = juce::jlimit(1, EngineMaxTimeoutMs, marginMs / 2);
+
+            const auto seq = bell.prepareWait();
+            bell.wait(seq, hasWork() ? 0 : timeoutMs);
+        }
+
+        ctl.producer.frames = produced;
+        ctl.producer.wakeups = wakeups;
+        ctl.producer.rejectedBlocks = rejected;
+        return 0;
+    }
+
+    // ==============================================================================
+    // CONSUMER (DAW role)
+    // ==============================================================================
+    int runConsumer(const Config& cfg, BenchControl& ctl, const juce::String& segmentName)
+    {
+        IPCDoorbell bell;
+        bell.open("bench", &ctl.doorbellSequence, &ctl.engineWaiting, false);
+
+        SharedMemoryManager ipc(SharedMemoryManager::Mode::Plugin_Client, segmentName);
+        ipc.setDoorbell(&bell);
+        while (!ipc.initialize())
+        {
+            if (ctl.phase.load(std::memory_order_acquire) == Stop) return 2;
+            usleep(1000);
+        }
+        ctl.consumerReady.store(1, std::memory_order_release);
+
+        std::vector<float> left((size_t)cfg.blockSize), right((size_t)cfg.blockSize);
+        float* dest[] = { left.data(), right.data() };
+        Samples latency, jitter, callCost;
+        ConsumerResult result;
+
+        waitForPhase(ctl, Run);
+        const uint64_t start = ctl.startUs.load(std::memory_order_acquire);
+
+        // Prime like the plugin's drift compensator before the first block
+        if (cfg.mode == Mode::Paced)
+        {
+            const int target = IPCConfig::getDriftTargetFillFrames(cfg.blockSize);
+            while (ipc.getAudioFramesReady() < target && ctl.phase.load(std::memory_order_acquire) == Run)
+                usleep(200);
+        }
+        result.primeMs = (double)(nowUs() - start) / 1000.0;
+
+        const uint64_t periodNs = (uint64_t)cfg.blockSize * 1000000000ull / (uint64_t)cfg.sampleRate;
+        const uint64_t firstNs = nowNs();
+        uint64_t deadlineNs = firstNs;
+        uint64_t consumed = 0;
+
+        while (ctl.phase.load(std::memory_order_acquire) == Run)
+        {
+            if (cfg.mode == Mode::Paced)
+            {
+                deadlineNs += periodNs;
+                sleepUntilNs(deadlineNs);
+                jitter.add((double)(int64_t)(nowNs() - deadlineNs) / 1000.0);
+            }
+            else if (ipc.getAudioFramesReady() < cfg.blockSize)
+            {
+                sched_yield();
+                continue;
+            }
+
+            const uint64_t wakeUs = nowUs();
+            const uint64_t t0 = nowNs();
+            const int got = ipc.readAudio(dest, 2, cfg.blockSize);
+            callCost.add((double)(nowNs() - t0));
+
+            if (got < cfg.blockSize)
+            {
+                ++result.underruns;
+                ipc.countUnderrun();
+            }
+
+            if (got > 0)
+            {
+                const auto stamp = ctl.blockStampUs[(consumed / EngineBlock) % StampSlots].load(std::memory_order_relaxed);
+                if (stamp != 0 && wakeUs >= stamp) latency.add((double)(wakeUs - stamp));
+
+                for (int i = 0; i < got; ++i)
+                {
+                    const float expected = (float)((consumed + (uint64_t)i) & FrameIndexMask);
+                    if (left[(size_t)i] != expected || right[(size_t)i] != -expected) ++result.corruptFrames;
+                }
+            }
+
+            consumed += (uint64_t)got;
+            ++result.blocks;
+        }
+
+        result.frames = consumed;
+        result.elapsedSeconds = (double)(nowNs() - firstNs) / 1.0e9;
+        result.latencyUs = latency.compute();
+        result.jitterUs = jitter.compute();
+        result.callNs = callCost.compute();
+        ctl.consumer = result;
+        return 0;
+    }
+
+    // ==============================================================================
+    // CONTENTION
+    // ==============================================================================
+    [[noreturn]] void runHog()
+    {
+        // Touch more memory than the last-level cache so the hogs also compete for bandwidth
+        std::vector<char> a(16u << 20, 1), b(16u << 20, 2);
+        for (;;)
+        {
+            std::memcpy(a.data(), b.data(), a.size());
+            std::swap(a, b);
+        }
+    }
+
+    template <typename Fn>
+    pid_t spawn(Fn&& fn)
+    {
+        const pid_t pid = fork();
+        if (pid == 0)
+        {
+            const int code = fn();
+            _exit(code);
+        }
+        return pid;
+    }
+
+    bool waitUntil(const std::atomic<uint32_t>& flag, int timeoutMs)
+    {
+        for (int i = 0; i < timeoutMs * 10; ++i)
+        {
+            if (flag.load(std::memory_order_acquire) != 0) return true;
+            usleep(100);
+        }
+        return false;
+    }
+
+    int exitCodeOf(pid_t pid)
+    {
+        int status = 0;
+        if (pid <= 0 || waitpid(pid, &status, 0) != pid) return 2;
+        return WIFEXITED(status) ? WEXITSTATUS(status) : 2;
+    }
+
+    struct RunResult
+    {
+        Config config;
+        ConsumerResult consumer;
+        ProducerResult producer;
+        bool ok = false;
+    };
+
+    RunResult runConfig(const Config& cfg, int index)
+    {
+        RunResult run;
+        run.config = cfg;
+
+        const juce::String prefix = "Playlisted2_Bench_" + juce::String((int)getpid()) + "_" + juce::String(index);
+        SharedMemorySegment controlSegment;
+        if (!controlSegment.create(prefix + "_ctl", sizeof(BenchControl))) return run;
+
+        auto* ctl = new (controlSegment.getData()) BenchControl();
+        const juce::String segmentName = prefix + "_audio";
+
+        std::vector<pid_t> hogs;
+        for (int i = 0; i < cfg.contention; ++i)
+            hogs.push_back(spawn([] { runHog(); return 0; }));
+
+        const pid_t producer = spawn([&] { return runProducer(cfg, *ctl, segmentName); });
+        const bool producerUp = waitUntil(ctl->producerReady, 5000);
+        const pid_t consumer = producerUp ? spawn([&] { return runConsumer(cfg, *ctl, segmentName); }) : -1;
+        const bool consumerUp = producerUp && waitUntil(ctl->consumerReady, 5000);
+
+        if (consumerUp)
+        {
+            ctl->startUs.store(nowUs(), std::memory_order_release);
+            ctl->phase.store(Run, std::memory_order_release);
+            usleep((useconds_t)(cfg.seconds * 1.0e6));
+        }
+
+        // Wake a sleeping producer so it sees Stop right away
+        ctl->phase.store(Stop, std::memory_order_release);
+        {
+            IPCDoorbell bell;
+            bell.open("bench", &ctl->doorbellSequence, &ctl->engineWaiting, false);
+            bell.ring();
+        }
+
+        const int producerCode = exitCodeOf(producer);
+        const int consumerCode = consumer > 0 ? exitCodeOf(consumer) : 2;
+
+        for (auto pid : hogs) kill(pid, SIGKILL);
+        for (auto pid : hogs) exitCodeOf(pid);
+
+        run.ok = consumerUp && producerCode == 0 && consumerCode == 0;
+        run.consumer = ctl->consumer;
+        run.producer = ctl->producer;
+
+        ctl->~BenchControl();
+        return run;
+    }
+
+    // ==============================================================================
+    // OUTPUT
+    // ==============================================================================
+    const char* modeName(Mode m) { return m == Mode::Paced ? "paced" : "flatout"; }
+
+    void printCsvHeader()
+    {
+        std::printf("mode,block_size,sample_rate,ring_frames,contention,ok,seconds,frames,throughput_fps,realtime_factor,"
+                    "underruns,corrupt_frames,prime_ms,lat_p50_us,lat_p90_us,lat_p99_us,lat_p999_us,lat_max_us,"
+                    "jitter_p50_us,jitter_p99_us,jitter_p999_us,jitter_max_us,read_p50_ns,read_p99_ns,read_max_ns,"
+                    "producer_wakeups,producer_rejected\n");
+    }
+
+    void printRun(const RunResult& r, bool json)
+    {
+        const auto& c = r.config;
+        const auto& x = r.consumer;
+        const double fps = x.elapsedSeconds > 0 ? (double)x.frames / x.elapsedSeconds : 0.0;
+        const double rtf = fps / (double)c.sampleRate;
+
+        if (json)
+        {
+            std::printf("{\"mode\":\"%s\",\"block_size\":%d,\"sample_rate\":%d,\"ring_frames\":%d,\"contention\":%d,\"ok\":%s,"
+                        "\"seconds\":%.3f,\"frames\":%" PRIu64 ",\"throughput_fps\":%.1f,\"realtime_factor\":%.3f,"
+                        "\"underruns\":%" PRIu64 ",\"corrupt_frames\":%" PRIu64 ",\"prime_ms\":%.2f,"
+                        "\"latency_us\":{\"p50\":%.1f,\"p90\":%.1f,\"p99\":%.1f,\"p999\":%.1f,\"max\":%.1f},"
+                        "\"jitter_us\":{\"p50\":%.1f,\"p99\":%.1f,\"p999\":%.1f,\"max\":%.1f},"
+                        "\"read_ns\":{\"p50\":%.0f,\"p99\":%.0f,\"max\":%.0f},"
+                        "\"producer_wakeups\":%" PRIu64 ",\"producer_rejected\":%" PRIu64 "}\n",
+                        modeName(c.mode), c.blockSize, c.sampleRate, c.ringFrames, c.contention, r.ok ? "true" : "false",
+                        x.elapsedSeconds, x.frames, fps, rtf, x.underruns, x.corruptFrames, x.primeMs,
+                        x.latencyUs.p50, x.latencyUs.p90, x.latencyUs.p99, x.latencyUs.p999, x.latencyUs.max,
+                        x.jitterUs.p50, x.jitterUs.p99, x.jitterUs.p999, x.jitterUs.max,
+                        x.callNs.p50, x.callNs.p99, x.callNs.max,
+                        r.producer.wakeups, r.producer.rejectedBlocks);
+        }
+        else
+        {
+            std::printf("%s,%d,%d,%d,%d,%d,%.3f,%" PRIu64 ",%.1f,%.3f,%" PRIu64 ",%" PRIu64 ",%.2f,"
+                        "%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.0f,%.0f,%.0f,%" PRIu64 ",%" PRIu64 "\n",
+                        modeName(c.mode), c.blockSize, c.sampleRate, c.ringFrames, c.contention, r.ok ? 1 : 0,
+                        x.elapsedSeconds, x.frames, fps, rtf, x.underruns, x.corruptFrames, x.primeMs,
+                        x.latencyUs.p50, x.latencyUs.p90, x.latencyUs.p99, x.latencyUs.p999, x.latencyUs.max,
+                        x.jitterUs.p50, x.jitterUs.p99, x.jitterUs.p999, x.jitterUs.max,
+                        x.callNs.p50, x.callNs.p99, x.callNs.max,
+                        r.producer.wakeups, r.producer.rejectedBlocks);
+        }
+        std::fflush(stdout);
+    }
+
+    std::vector<int> parseList(const char* text)
+    {
+        std::vector<int> values;
+        for (const char* p = text; *p != 0;)
+        {
+            char* end = nullptr;
+            const long v = std::strtol(p, &end, 10);
+            if (end == p) break;
+            values.push_back((int)v);
+            p = (*end == ',') ? end + 1 : end;
+        }
+        return values;
+    }
+
+    void printUsage()
+    {
+        std::fprintf(stderr,
+            "PlaylistedIpcStress [options]\n"
+            "  --blocks 32,64,...      DAW block sizes        (default 32,64,128,256,512,1024,2048,4096)\n"
+            "  --rates 44100,48000     sample rates           (default 44100,48000,96000)\n"
+            "  --rings 8192,65536      ring sizes in frames   (default 8192,65536)\n"
+            "  --contention 0,4        CPU/memory hog counts  (default 0; -1 = one per CPU)\n"
+            "  --mode paced|flatout|both                      (default both)\n"
+            "  --seconds S             per paced run          (default 2; flat-out runs use S/4)\n"
+            "  --json                  JSON lines instead of CSV\n"
+            "  --max-underruns N       fail if any paced run exceeds N underruns\n"
+            "  --max-jitter-us U       fail if any paced run's p99 wakeup jitter exceeds U\n"
+            "  --max-read-ns N         fail if any run's p99 read cost exceeds N\n"
+            "  --min-realtime X        fail if a flat-out run is slower than X times real time\n");
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<int> blocks { 32, 64, 128, 256, 512, 1024, 2048, 4096 };
+    std::vector<int> rates { 44100, 48000, 96000 };
+    std::vector<int> rings { 8192, 65536 };
+    std::vector<int> contention { 0 };
+    std::vector<Mode> modes { Mode::Paced, Mode::FlatOut };
+    double seconds = 2.0;
+    bool json = false;
+    long maxUnderruns = -1;
+    double maxJitterUs = -1, maxReadNs = -1, minRealtime = -1;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : "";
+        auto takes = [&] { ++i; return value; };
+
+        if (arg == "--blocks")              blocks = parseList(takes());
+        else if (arg == "--rates")          rates = parseList(takes());
+        else if (arg == "--rings")          rings = parseList(takes());
+        else if (arg == "--contention")     contention = parseList(takes());
+        else if (arg == "--seconds")        seconds = std::atof(takes());
+        else if (arg == "--json")           json = true;
+        else if (arg == "--max-underruns")  maxUnderruns = std::atol(takes());
+        else if (arg == "--max-jitter-us")  maxJitterUs = std::atof(takes());
+        else if (arg == "--max-read-ns")    maxReadNs = std::atof(takes());
+        else if (arg == "--min-realtime")   minRealtime = std::atof(takes());
+        else if (arg == "--mode")
+        {
+            const std::string m = takes();
+            if (m == "paced")        modes = { Mode::Paced };
+            else if (m == "flatout") modes = { Mode::FlatOut };
+            else                     modes = { Mode::Paced, Mode::FlatOut };
+        }
+        else { printUsage(); return arg == "--help" ? 0 : 2; }
+    }
+
+    for (auto& n : contention)
+        if (n < 0) n = (int)sysconf(_SC_NPROCESSORS_ONLN);
+
+    if (!json) printCsvHeader();
+
+    int index = 0, failures = 0;
+    bool setupError = false;
+
+    for (auto mode : modes)
+        for (int hogs : contention)
+            for (int ring : rings)
+                for (int rate : rates)
+                    for (int block : blocks)
+                    {
+                        Config cfg;
+                        cfg.mode = mode;
+                        cfg.blockSize = block;
+                        cfg.sampleRate = rate;
+                        cfg.ringFrames = (int)IPCConfig::AudioFormat { ring, 2 }.sanitised().ringFrames;
+                        cfg.contention = hogs;
+                        cfg.seconds = (mode == Mode::Paced) ? seconds : seconds / 4.0;
+
+                        // A DAW block larger than the ring can never be served
+                        if (block * 2 > cfg.ringFrames) continue;
+
+                        const auto run = runConfig(cfg, index++);
+                        printRun(run, json);
+
+                        const auto& x = run.consumer;
+                        const double fps = x.elapsedSeconds > 0 ? (double)x.frames / x.elapsedSeconds : 0.0;
+
+                        if (!run.ok) { setupError = true; continue; }
+
+                        bool failed = x.corruptFrames != 0;
+                        if (mode == Mode::Paced)
+                        {
+                            failed |= maxUnderruns >= 0 && (long)x.underruns > maxUnderruns;
+                            failed |= maxJitterUs >= 0 && x.jitterUs.p99 > maxJitterUs;
+                        }
+                        else
+                        {
+                            failed |= minRealtime >= 0 && fps < minRealtime * rate;
+                        }
+                        failed |= maxReadNs >= 0 && x.callNs.p99 > maxReadNs;
+
+                        if (failed) ++failures;
+                    }
+
+    if (failures > 0)
+        std::fprintf(stderr, "%d configuration(s) failed the gate\n", failures);
+
+    return setupError ? 2 : (failures > 0 ? 1 : 0);
+}
@@ -0,0 +1,176 @@
+/*
+  ==============================================================================
+
+    PcmConvertBench.cpp
+    Playlisted2
+
+    Microbenchmark for the VLC amem callback (VLCMediaPlayer_Desktop::
+    addAudioSamples): interleaved stereo from libVLC into the planar FIFO
+    buffer, wrapping at its end like the real one does.
+    - legacy:     S16N, one setSample() per sample and channel (as before)
+    - s16_scalar: S16N, PcmDeinterleave scalar reference
+    - s16_simd:   S16N, dispatched kernel
+    - f32_scalar: FL32, scalar reference
+    - f32_simd:   FL32, dispatched kernel
+    The vector kernels are checked against the scalar ones first.
+
+    Build with -DPLAYLISTED_BUILD_BENCHMARKS=ON, run PlaylistedPcmConvertBench.
+    Output is one CSV line per implementation and callback size.
+
+  ==============================================================================
+*/
+
+#include "engine/PcmDeinterleave.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace
+{
+    const int FifoFrames = 16384;   // VLCMediaPlayer_Desktop::InternalBufferSize
+
+    // Stand-in for the planar juce::AudioBuffer the callback writes into
+    struct PlanarBuffer
+    {
+        std::vector<float> left = std::vector<float>(FifoFrames, 0.0f);
+        std::vector<float> right = std::vector<float>(FifoFrames, 0.0f);
+        float* channels[2] = { left.data(), right.data() };
+        bool isClear = true;
+
+        // What AudioBuffer::setSample() does in a release build
+        void setSample(int channel, int index, float value)
+        {
+            channels[channel][index] = value;
+            isClear = false;
+        }
+    };
+
+    // Old addAudioSamples() body
+    void legacyWrite(PlanarBuffer& ring, const int16_t* src, int start1, int size1, int start2, int size2)
+    {
+        const float scale = 1.0f / 32768.0f;
+        for (int i = 0; i < size1; ++i)
+        {
+            ring.setSample(0, start1 + i, src[i * 2] * scale);
+            ring.setSample(1, start1 + i, src[i * 2 + 1] * scale);
+        }
+        for (int i = 0; i < size2; ++i)
+        {
+            ring.setSample(0, start2 + i, src[(size1 + i) * 2] * scale);
+            ring.setSample(1, start2 + i, src[(size1 + i) * 2 + 1] * scale);
+        }
+    }
+
+    template <typename Sample, typename Kernel>
+    void kernelWrite(PlanarBuffer& ring, const Sample* src, int start1, int size1, int start2, int size2, Kernel&& kernel)
+    {
+        kernel(src, ring.channels[0] + start1, ring.channels[1] + start1, size1);
+        kernel(src + size1 * 2, ring.channels[0] + start2, ring.channels[1] + start2, size2);
+        ring.isClear = false;
+    }
+
+    struct Result { double nsPerBlock; double nsPerFrame; };
+
+    // WriteFn(start1, size1, start2, size2), called for consecutive FIFO positions
+    template <typename WriteFn>
+    Result measure(int blockSize, long iterations, WriteFn&& write)
+    {
+        using Clock = std::chrono::steady_clock;
+        int position = 0;
+
+        auto t0 = Clock::now();
+        for (long i = 0; i < iterations; ++i)
+        {
+            const int size1 = blockSize < FifoFrames - position ? blockSize : FifoFrames - position;
+            write(position, size1, 0, blockSize - size1);
+            position = (position + blockSize) % FifoFrames;
+        }
+        auto t1 = Clock::now();
+
+        const double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+        return { ns / (double)iterations, ns / ((double)iterations * blockSize) };
+    }
+
+    // Vector kernel against the scalar reference, odd length so the tail runs too
+    bool verifyKernels()
+    {
+        const int frames = 1027;
+        std::vector<int16_t> s16((size_t)frames * 2);
+        std::vector<float> f32((size_t)frames * 2);
+        for (int i = 0; i < frames * 2; ++i)
+        {
+            s16[(size_t)i] = (int16_t)((i * 7919) % 65536 - 32768);
+            f32[(size_t)i] = std::sin((float)i * 0.01f);
+        }
+
+        std::vector<float> refL((size_t)frames), refR((size_t)frames), vecL((size_t)frames), vecR((size_t)frames);
+        bool ok = true;
+
+        PcmDeinterleave::s16Scalar(s16.data(), refL.data(), refR.data(), frames);
+        PcmDeinterleave::s16(s16.data(), vecL.data(), vecR.data(), frames);
+        for (int i = 0; i < frames; ++i)
+            ok = ok && refL[(size_t)i] == vecL[(size_t)i] && refR[(size_t)i] == vecR[(size_t)i];
+
+        PcmDeinterleave::f32Scalar(f32.data(), refL.data(), refR.data(), frames);
+        PcmDeinterleave::f32(f32.data(), vecL.data(), vecR.data(), frames);
+        for (int i = 0; i < frames; ++i)
+            ok = ok && refL[(size_t)i] == vecL[(size_t)i] && refR[(size_t)i] == vecR[(size_t)i];
+
+        return ok;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const long totalFrames = (argc > 1) ? std::atol(argv[1]) : 50000000L;
+    const int blockSizes[] = { 64, 128, 256, 512, 1024, 2048, 4096 };   // amem typically hands over 1-2k frames
+
+    if (!verifyKernels())
+    {
+        std::fprintf(stderr, "%s kernel does not match the scalar reference\n", PcmDeinterleave::getKernelName());
+        return 1;
+    }
+
+    std::fprintf(stderr, "kernel: %s\n", PcmDeinterleave::getKernelName());
+    std::printf("impl,block_size,ns_per_block,ns_per_frame\n");
+
+    PlanarBuffer ring;
+
+    for (int blockSize : blockSizes)
+    {
+        const long iterations = totalFrames / blockSize;
+
+        std::vector<int16_t> s16((size_t)blockSize * 2);
+        std::vector<float> f32((size_t)blockSize * 2);
+        for (int i = 0; i < blockSize * 2; ++i)
+        {
+            f32[(size_t)i] = std::sin((float)i * 0.01f) * 0.5f;
+            s16[(size_t)i] = (int16_t)(f32[(size_t)i] * 32767.0f);
+        }
+
+        auto report = [blockSize](const char* name, Result r)
+        {
+            std::printf("%s,%d,%.1f,%.3f\n", name, blockSize, r.nsPerBlock, r.nsPerFrame);
+        };
+
+        report("legacy", measure(blockSize, iterations, [&](int s1, int n1, int s2, int n2)
+               { legacyWrite(ring, s16.data(), s1, n1, s2, n2); }));
+
+        report("s16_scalar", measure(blockSize, iterations, [&](int s1, int n1, int s2, int n2)
+               { kernelWrite(ring, s16.data(), s1, n1, s2, n2, PcmDeinterleave::s16Scalar); }));
+
+        report("s16_simd", measure(blockSize, iterations, [&](int s1, int n1, int s2, int n2)
+               { kernelWrite(ring, s16.data(), s1, n1, s2, n2, PcmDeinterleave::s16); }));
+
+        report("f32_scalar", measure(blockSize, iterations, [&](int s1, int n1, int s2, int n2)
+               { kernelWrite(ring, f32.data(), s1, n1, s2, n2, PcmDeinterleave::f32Scalar); }));
+
+        report("f32_simd", measure(blockSize, iterations, [&](int s1, int n1, int s2, int n2)
+               { kernelWrite(ring, f32.data(), s1, n1, s2, n2, PcmDeinterleave::f32); }));
+    }
+
+    // Keep the writes observable
+    return ring.left[0] == 12345.0f ? 2 : 0;
+}
@@ -0,0 +1,232 @@
+/*
+  ==============================================================================
+
+    TimeStretchBench.cpp
+    Playlisted2
+
+    CPU cost of the deck's pitch-preserving speed change (TimeStretcher).
+    - stretch:       one stereo stream through the stretcher the way
+                     SingleDeckPlayer drives it (512-frame pulls, source pushed
+                     as needed), per sample rate and playback rate. cpu_percent
+                     is the share of one core it takes in real time.
+    - search_scalar: one hop's correlation search with the scalar dot product
+    - search_simd:   the same with the dispatched kernel (AVX / SSE2 / NEON)
+
+    Checked first: the vector dot product against the scalar one, 1x output
+    against its input (bit-for-bit up to the window sum), the output length
+    at other rates, and that a 440 Hz tone stays at 440 Hz.
+
+    Build with -DPLAYLISTED_BUILD_BENCHMARKS=ON, run PlaylistedTimeStretchBench.
+    Output is one CSV line per case.
+
+  ==============================================================================
+*/
+
+#include "engine/TimeStretcher.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace
+{
+    const int BlockSize = 512;   // EngineDeck::blockSize
+
+    struct Signal
+    {
+        std::vector<float> left, right;
+    };
+
+    // Two voices and a little noise, different per channel
+    Signal makeMusic(double sampleRate, int frames)
+    {
+        Signal s { std::vector<float>((size_t)frames), std::vector<float>((size_t)frames) };
+        uint32_t seed = 12345;
+        for (int i = 0; i < frames; ++i)
+        {
+            seed = seed * 1664525u + 1013904223u;
+            const float noise = ((float)(seed >> 8) / 16777216.0f - 0.5f) * 0.02f;
+            const double t = i / sampleRate;
+            s.left[(size_t)i]  = (float)(0.4 * std::sin(2.0 * 3.141592653589793 * 220.0 * t) + 0.2 * std::sin(2.0 * 3.141592653589793 * 659.3 * t)) + noise;
+            s.right[(size_t)i] = (float)(0.4 * std::sin(2.0 * 3.141592653589793 * 277.2 * t) + 0.2 * std::sin(2.0 * 3.141592653589793 * 554.4 * t)) - noise;
+        }
+        return s;
+    }
+
+    Signal makeTone(double sampleRate, int frames, double hz)
+    {
+        Signal s { std::vector<float>((size_t)frames), std::vector<float>((size_t)frames) };
+        for (int i = 0; i < frames; ++i)
+            s.left[(size_t)i] = s.right[(size_t)i] = (float)(0.5 * std::sin(2.0 * 3.141592653589793 * hz * i / sampleRate));
+        return s;
+    }
+
+    // SingleDeckPlayer::getNextAudioBlock: hops until a block is ready, source pushed as they need it.
+    // Returns all output, source ended after the last frame.
+    Signal stretchAll(TimeStretcher& stretcher, const Signal& in)
+    {
+        Signal out;
+        std::vector<float> l((size_t)BlockSize), r((size_t)BlockSize);
+        const int total = (int)in.left.size();
+        int pushed = 0;
+
+        for (;;)
+        {
+            while (stretcher.getNumOutputReady() < BlockSize)
+            {
+                if (stretcher.processHop(false)) continue;
+
+                const int n = std::min({ std::max(stretcher.getInputNeeded(), BlockSize), stretcher.getInputRoom(), total - pushed });
+                if (n > 0)
+                {
+                    pushed += stretcher.pushInput(in.left.data() + pushed, in.right.data() + pushed, n);
+                    continue;
+                }
+                if (!stretcher.processHop(true)) break;
+            }
+
+            const int got = stretcher.readOutput(l.data(), r.data(), BlockSize);
+            if (got == 0) break;
+            out.left.insert(out.left.end(), l.begin(), l.begin() + got);
+            out.right.insert(out.right.end(), r.begin(), r.begin() + got);
+        }
+        return out;
+    }
+
+    // Zero crossings (rising) per second over the middle half
+    double estimateFrequency(const std::vector<float>& x, double sampleRate)
+    {
+        const size_t from = x.size() / 4, to = x.size() * 3 / 4;
+        int crossings = 0;
+        for (size_t i = from + 1; i < to; ++i)
+            if (x[i - 1] < 0.0f && x[i] >= 0.0f) ++crossings;
+        return crossings * sampleRate / (double)(to - from);
+    }
+
+    bool verify()
+    {
+        bool ok = true;
+
+        // Dot kernel, odd length so the tail runs too
+        {
+            std::vector<float> a(1031), b(1031);
+            for (size_t i = 0; i < a.size(); ++i) { a[i] = std::sin((float)i * 0.01f); b[i] = std::cos((float)i * 0.013f); }
+            const float ref = TimeStretchKernels::dotScalar(a.data(), b.data(), (int)a.size());
+            const float vec = TimeStretchKernels::dot(a.data(), b.data(), (int)a.size());
+            if (std::abs(ref - vec) > 1.0e-3f * (1.0f + std::abs(ref)))
+            {
+                std::fprintf(stderr, "dot: %s %f vs scalar %f\n", PcmDeinterleave::getKernelName(), vec, ref);
+                ok = false;
+            }
+        }
+
+        const double sampleRate = 48000.0;
+        const Signal music = makeMusic(sampleRate, 48000 * 4);
+        TimeStretcher stretcher;
+        stretcher.prepare(sampleRate);
+
+        // 1x: the input, every frame of it
+        {
+            stretcher.reset();
+            stretcher.setRate(1.0);
+            const Signal out = stretchAll(stretcher, music);
+            float maxError = 0.0f;
+            const size_t n = std::min(out.left.size(), music.left.size());
+            for (size_t i = 0; i < n; ++i)
+                maxError = std::max({ maxError, std::abs(out.left[i] - music.left[i]), std::abs(out.right[i] - music.right[i]) });
+
+            if (out.left.size() != music.left.size() || maxError > 1.0e-5f)
+            {
+                std::fprintf(stderr, "1x: %zu frames out of %zu, max error %g\n", out.left.size(), music.left.size(), maxError);
+                ok = false;
+            }
+        }
+
+        // Length and pitch at other rates
+        const Signal tone = makeTone(sampleRate, 48000 * 4, 440.0);
+        for (double rate : { 0.5, 0.8, 1.25, 2.0 })
+        {
+            stretcher.reset();
+            stretcher.setRate(rate);
+            const Signal out = stretchAll(stretcher, tone);
+
+            const double expected = tone.left.size() / rate;
+            const double hz = estimateFrequency(out.left, sampleRate);
+            if (std::abs((double)out.left.size() - expected) > stretcher.getHopFrames() * 2 || std::abs(hz - 440.0) > 440.0 * 0.01)
+            {
+                std::fprintf(stderr, "%.2fx: %zu frames (expected %.0f), %.1f Hz\n", rate, out.left.size(), expected, hz);
+                ok = false;
+            }
+        }
+
+        return ok;
+    }
+
+    double secondsSince(std::chrono::steady_clock::time_point t0)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const double outputSeconds = (argc > 1) ? std::atof(argv[1]) : 60.0;
+    const double sampleRates[] = { 44100.0, 48000.0, 96000.0 };
+    const double rates[] = { 0.5, 0.75, 1.0, 1.25, 1.5, 2.0 };
+
+    if (!verify()) return 1;
+
+    std::fprintf(stderr, "kernel: %s\n", PcmDeinterleave::getKernelName());
+    std::printf("impl,sample_rate,rate,ns_per_frame,cpu_percent\n");
+
+    float sink = 0.0f;   // Keeps results observable
+
+    for (double sampleRate : sampleRates)
+    {
+        TimeStretcher stretcher;
+        stretcher.prepare(sampleRate);
+
+        for (double rate : rates)
+        {
+            const Signal in = makeMusic(sampleRate, (int)(sampleRate * outputSeconds * rate) + BlockSize);
+            stretcher.reset();
+            stretcher.setRate(rate);
+
+            const auto t0 = std::chrono::steady_clock::now();
+            const Signal out = stretchAll(stretcher, in);
+            const double seconds = secondsSince(t0);
+
+            sink += out.left.empty() ? 0.0f : out.left.back();
+            const double audioSeconds = (double)out.left.size() / sampleRate;
+            std::printf("stretch,%.0f,%.2f,%.2f,%.3f\n", sampleRate, rate,
+                        seconds * 1.0e9 / (double)out.left.size(), 100.0 * seconds / audioSeconds);
+        }
+
+        // One hop's search: 2 * tolerance + 1 candidates of one hop each, the hop's duration is its budget
+        const int hop = stretcher.getHopFrames();
+        const int candidates = hop + 1;
+        const Signal in = makeMusic(sampleRate, hop * 4);
+        const long iterations = (long)(sampleRate * outputSeconds / hop);
+
+        auto search = [&](const char* name, auto dot)
+        {
+            const auto t0 = std::chrono::steady_clock::now();
+            for (long it = 0; it < iterations; ++it)
+            {
+                float best = -1.0e30f;
+                for (int c = 0; c < candidates; ++c)
+                    best = std::max(best, dot(in.left.data(), in.right.data() + c + (int)(it & 7), hop));
+                sink += best;
+            }
+            const double seconds = secondsSince(t0);
+            std::printf("%s,%.0f,-,%.2f,%.3f\n", name, sampleRate,
+                        seconds * 1.0e9 / ((double)iterations * hop), 100.0 * seconds / outputSeconds);
+        };
+
+        search("search_scalar", TimeStretchKernels::dotScalar);
+        search("search_simd", TimeStretchKernels::dot);
+    }
+
+    return sink == 12345.0f ? 2 : 0;
+}
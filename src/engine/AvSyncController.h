@@ -0,0 +1,164 @@
+/*
+  ==============================================================================
+
+    AvSyncController.h
+    Playlisted2 Engine
+
+    Measured A/V sync for the VLC deck. VLC presents video frames at their pts
+    on its own clock (libvlc_clock(), --clock-jitter=0), and amem hands every
+    audio buffer over with the pts it should be heard at. So for the newest
+    frame of each buffer:
+
+        lead    = pts - now                        (libvlc_delay(pts))
+        latency = frames ahead of it until output / rate
+                  (decoder FIFO + delay line + engine queue + IPC ring)
+        skew    = latency - lead + vlcAudioDelay   (> 0: audio late)
+
+    The skew is smoothed per callback. The pump then corrects it:
+
+    - audio early: the engine's delay line delays it;
+    - audio late, once the delay line is down to zero: libVLC's own audio
+      delay goes negative, so VLC hands audio over earlier.
+
+    A correction is applied once the skew stays outside a dead band, and the
+    measurement starts over after each correction, seek or load. The user's
+    trim (setTrimMs, PLAYLISTED_AV_TRIM_MS) covers what cannot be measured:
+    display latency and the DAW's output latency.
+
+    Threads: addMeasurement() on the decoder callback thread, everything
+    else on the pump. Exchanged through atomics; nothing blocks.
+    Plain C++, no JUCE.
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+
+class AvSyncController
+{
+public:
+    static constexpr uint32_t minMeasurements = 16;      // Callbacks (~0.2-0.5 s) before a correction
+    static constexpr double settleMs = 1000.0;           // Between corrections, so VLC's buffers reflect the last one
+    static constexpr double deadBandMs = 15.0;           // About a video frame at 60 fps
+    static constexpr double smoothing = 0.1;             // EMA weight per callback
+    static constexpr int64_t maxVlcAdvanceUs = 2000000;  // Largest negative libVLC audio delay
+
+    struct Correction
+    {
+        int delayFrames = 0;       // Engine delay line
+        int64_t vlcDelayUs = 0;    // libvlc_audio_set_delay(), <= 0
+    };
+
+    // ==============================================================================
+    // Decoder callback thread
+
+    // One amem buffer: leadUs = libvlc_delay() of its last frame, framesAhead = frames queued in
+    // front of that frame excluding the delay line (decoder FIFO, engine queue, IPC ring)
+    void addMeasurement(int64_t leadUs, int64_t framesAhead, double sampleRate)
+    {
+        if (sampleRate <= 0.0) return;
+
+        const uint32_t generation = restartGeneration.load(std::memory_order_acquire);
+        if (generation != producerGeneration)
+        {
+            producerGeneration = generation;
+            producerCount = 0;
+        }
+
+        const double latencyUs = (double)(framesAhead + delayFrames.load(std::memory_order_relaxed)) * 1.0e6 / sampleRate;
+        const double skewUs = latencyUs - (double)leadUs + (double)vlcDelayUs.load(std::memory_order_relaxed);
+
+        skewEmaUs = producerCount == 0 ? skewUs : skewEmaUs + smoothing * (skewUs - skewEmaUs);
+        ++producerCount;
+
+        measuredSkewUs.store((int64_t)skewEmaUs, std::memory_order_relaxed);
+        measuredCount.store(producerCount, std::memory_order_relaxed);
+        measuredGeneration.store(generation, std::memory_order_release);
+    }
+
+    // ==============================================================================
+    // Pump thread
+
+    // Measurements so far no longer describe what comes next (flush, seek, load, correction)
+    void restart(double nowMs)
+    {
+        restartGeneration.fetch_add(1, std::memory_order_acq_rel);
+        lastRestartMs = nowMs;
+    }
+
+    // A new load: libVLC resets its audio delay to zero with the media, the delay line keeps its setting
+    void mediaChanged(double nowMs)
+    {
+        vlcDelayUs.store(0, std::memory_order_relaxed);
+        restart(nowMs);
+    }
+
+    // Positive delays the audio further than measured
+    void setTrimMs(int ms) { trimMs.store(ms, std::memory_order_relaxed); }
+
+    // True when the correction changed; out holds the new one
+    bool update(double nowMs, double sampleRate, int maxDelayFrames, Correction& out)
+    {
+        const uint32_t generation = restartGeneration.load(std::memory_order_acquire);
+        if (measuredGeneration.load(std::memory_order_acquire) != generation) return false;
+        if (measuredCount.load(std::memory_order_relaxed) < minMeasurements) return false;
+        if (nowMs - lastRestartMs < settleMs) return false;
+
+        const double errorMs = (double)measuredSkewUs.load(std::memory_order_relaxed) / 1000.0
+                             - (double)trimMs.load(std::memory_order_relaxed);
+        if (std::abs(errorMs) < deadBandMs) return false;
+
+        // Total audio delay: delay line plus libVLC's; take the error off it
+        const int currentFrames = delayFrames.load(std::memory_order_relaxed);
+        const int64_t currentVlcUs = vlcDelayUs.load(std::memory_order_relaxed);
+        const double totalSeconds = (double)currentFrames / sampleRate + (double)currentVlcUs / 1.0e6 - errorMs / 1000.0;
+
+        Correction next;
+        if (totalSeconds >= 0.0)
+            next.delayFrames = (int)std::lround(std::fmin(totalSeconds * sampleRate, (double)maxDelayFrames));
+        else
+            next.vlcDelayUs = (int64_t)std::llround(std::fmax(totalSeconds * 1.0e6, (double)-maxVlcAdvanceUs));
+
+        restart(nowMs);
+        if (next.delayFrames == currentFrames && next.vlcDelayUs == currentVlcUs) return false;
+
+        delayFrames.store(next.delayFrames, std::memory_order_relaxed);
+        vlcDelayUs.store(next.vlcDelayUs, std::memory_order_relaxed);
+        out = next;
+        return true;
+    }
+
+    // Smoothed skew of the current measurement (> 0: audio late), before the trim
+    double getMeasuredSkewMs() const { return (double)measuredSkewUs.load(std::memory_order_relaxed) / 1000.0; }
+
+    // Correction in effect: delay line plus libVLC's delay (negative: audio advanced)
+    double getCorrectionMs(double sampleRate) const
+    {
+        return (sampleRate > 0.0 ? (double)delayFrames.load(std::memory_order_relaxed) * 1000.0 / sampleRate : 0.0)
+             + (double)vlcDelayUs.load(std::memory_order_relaxed) / 1000.0;
+    }
+
+    int getDelayFrames() const { return delayFrames.load(std::memory_order_relaxed); }
+
+private:
+    // Correction (written by the pump, read by both sides)
+    std::atomic<int> delayFrames { 0 };
+    std::atomic<int64_t> vlcDelayUs { 0 };
+    std::atomic<int> trimMs { 0 };
+
+    // Measurement: published by the callback, tagged with the generation it belongs to
+    std::atomic<uint32_t> restartGeneration { 0 };
+    std::atomic<uint32_t> measuredGeneration { 0 };
+    std::atomic<uint32_t> measuredCount { 0 };
+    std::atomic<int64_t> measuredSkewUs { 0 };
+
+    // Callback-thread state
+    uint32_t producerGeneration = 0, producerCount = 0;
+    double skewEmaUs = 0.0;
+
+    // Pump state
+    double lastRestartMs = 0.0;
+};
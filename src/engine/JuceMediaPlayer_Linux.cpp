@@ -0,0 +1,277 @@
+/*
+  ==============================================================================
+
+    JuceMediaPlayer_Linux.cpp
+    Playlisted2 Engine
+
+    JUCE AudioFormatReader backend with a background read-ahead FIFO.
+
+  ==============================================================================
+*/
+
+#include "JuceMediaPlayer_Linux.h"
+#include <cmath>
+
+JuceMediaPlayer_Linux::JuceMediaPlayer_Linux()
+{
+    formatManager.registerBasicFormats();
+    readAheadThread.addTimeSliceClient(this);
+    readAheadThread.startThread();
+}
+
+JuceMediaPlayer_Linux::~JuceMediaPlayer_Linux()
+{
+    readAheadThread.removeTimeSliceClient(this);
+    readAheadThread.stopThread(2000);
+}
+
+bool JuceMediaPlayer_Linux::prepareToPlay(int samplesPerBlock, double sampleRate)
+{
+    if (sampleRate > 1000.0) currentSampleRate = sampleRate;
+    else currentSampleRate = 44100.0;
+
+    resampler.prepareToPlay(samplesPerBlock, currentSampleRate);
+    updateResamplingRatio();
+
+    smoothedVolume = volume;
+    return true;
+}
+
+void JuceMediaPlayer_Linux::releaseResources()
+{
+    resampler.releaseResources();
+}
+
+bool JuceMediaPlayer_Linux::loadFile(const juce::String& path)
+{
+    playing = false;
+
+    auto* newReader = formatManager.createReaderFor(juce::File(path));
+
+    {
+        const juce::ScopedLock sl(readerLock);
+        reader.reset(newReader);
+        readPosition = 0;
+        fifo.reset();
+        readerAtEnd = (newReader == nullptr);
+    }
+
+    consumedPosition = 0;
+    resampler.flushBuffers();
+
+    if (newReader == nullptr)
+    {
+        lengthInSamples = 0;
+        return false;
+    }
+
+    fileSampleRate = newReader->sampleRate > 0.0 ? newReader->sampleRate : 44100.0;
+    lengthInSamples = newReader->lengthInSamples;
+    updateResamplingRatio();
+    smoothedVolume = volume;
+
+    readAheadThread.moveToFrontOfQueue(this);
+    return true;
+}
+
+void JuceMediaPlayer_Linux::play()
+{
+    if (lengthInSamples.load() <= 0) return;
+
+    // Like VLC, playing an ended track starts it over
+    if (hasFinished()) seekToSample(0);
+    playing = true;
+}
+
+void JuceMediaPlayer_Linux::pause() { playing = false; }
+
+void JuceMediaPlayer_Linux::stop()
+{
+    playing = false;
+    seekToSample(0);
+}
+
+void JuceMediaPlayer_Linux::setVolume(float newVolume) { volume = newVolume; }
+float JuceMediaPlayer_Linux::getVolume() const { return volume; }
+
+void JuceMediaPlayer_Linux::setRate(float newRate)
+{
+    if (newRate <= 0.0f) return;
+    rate = newRate;
+    updateResamplingRatio();
+}
+
+float JuceMediaPlayer_Linux::getRate() const { return rate; }
+
+bool JuceMediaPlayer_Linux::hasFinished() const
+{
+    const int64_t length = lengthInSamples.load();
+    return length > 0 && consumedPosition.load() >= length;
+}
+
+bool JuceMediaPlayer_Linux::isPlaying() const { return playing.load(); }
+
+void JuceMediaPlayer_Linux::getNextAudioBlock(const juce::AudioSourceChannelInfo& info)
+{
+    if (!playing)
+    {
+        info.clearActiveBufferRegion();
+        return;
+    }
+
+    resampler.getNextAudioBlock(info);
+
+    const int numSamples = info.numSamples;
+    const float targetVol = volume;
+    const float startVol = smoothedVolume;
+    const float volStep = (targetVol - startVol) / (float)juce::jmax(1, numSamples);
+
+    for (int ch = 0; ch < juce::jmin(2, info.buffer->getNumChannels()); ++ch) {
+        float* dst = info.buffer->getWritePointer(ch, info.startSample);
+        float vol = startVol;
+        for (int i = 0; i < numSamples; ++i) {
+            dst[i] *= vol;
+            vol += volStep;
+        }
+    }
+    smoothedVolume = targetVol;
+
+    if (hasFinished())
+        playing = false;
+}
+
+int JuceMediaPlayer_Linux::getNumAudioSamplesAvailable() const
+{
+    if (!playing) return 0;
+
+    // End of file: report exactly what is left, so the engine can splice the next track behind it
+    if (readerAtEnd.load())
+        return (int)std::ceil(fifo.getNumReady() / getSourceFramesPerOutputFrame());
+
+    // Keep a few source frames back for the resampler's interpolation
+    const int sourceFrames = fifo.getNumReady() - 4;
+    if (sourceFrames <= 0) return 0;
+    return (int)(sourceFrames / getSourceFramesPerOutputFrame());
+}
+
+bool JuceMediaPlayer_Linux::isAtEndOfStream() const
+{
+    return readerAtEnd.load() && lengthInSamples.load() > 0;
+}
+
+void JuceMediaPlayer_Linux::setWindowHandle(void* handle) { juce::ignoreUnused(handle); }
+void JuceMediaPlayer_Linux::setVideoEnabled(bool enabled) { juce::ignoreUnused(enabled); }
+
+float JuceMediaPlayer_Linux::getPosition() const
+{
+    const int64_t length = lengthInSamples.load();
+    if (length <= 0) return 0.0f;
+    return (float)((double)consumedPosition.load() / (double)length);
+}
+
+void JuceMediaPlayer_Linux::setPosition(float pos)
+{
+    seekToSample((int64_t)(juce::jlimit(0.0f, 1.0f, pos) * (double)lengthInSamples.load()));
+}
+
+int64_t JuceMediaPlayer_Linux::getLengthMs() const
+{
+    return (int64_t)((double)lengthInSamples.load() * 1000.0 / fileSampleRate);
+}
+
+double JuceMediaPlayer_Linux::getPositionSeconds() const
+{
+    return (double)consumedPosition.load() / fileSampleRate;
+}
+
+void JuceMediaPlayer_Linux::flushAudioBuffers()
+{
+    seekToSample(consumedPosition.load());
+}
+
+void JuceMediaPlayer_Linux::setAudioDelay(int64_t delayMs)
+{
+    // Nothing to line up with - no video on Linux
+    juce::ignoreUnused(delayMs);
+}
+
+// ==============================================================================
+// Read-ahead
+// ==============================================================================
+
+int JuceMediaPlayer_Linux::useTimeSlice()
+{
+    const juce::ScopedLock sl(readerLock);
+
+    if (reader == nullptr || readerAtEnd) return 100;
+
+    const int64_t remaining = reader->lengthInSamples - readPosition;
+    const int numToRead = (int)juce::jmin((int64_t)juce::jmin(fifo.getFreeSpace(), ReadChunkFrames), remaining);
+
+    if (numToRead <= 0)
+    {
+        if (remaining <= 0) readerAtEnd = true;
+        return 10;   // FIFO full
+    }
+
+    int start1, size1, start2, size2;
+    fifo.prepareToWrite(numToRead, start1, size1, start2, size2);
+    if (size1 > 0) reader->read(&fifoBuffer, start1, size1, readPosition, true, true);
+    if (size2 > 0) reader->read(&fifoBuffer, start2, size2, readPosition + size1, true, true);
+    fifo.finishedWrite(size1 + size2);
+
+    readPosition += size1 + size2;
+    if (readPosition >= reader->lengthInSamples) readerAtEnd = true;
+
+    // Keep going while there is room, back off once the FIFO is nearly full
+    return fifo.getFreeSpace() >= ReadChunkFrames ? 1 : 10;
+}
+
+void JuceMediaPlayer_Linux::readFromFifo(const juce::AudioSourceChannelInfo& info)
+{
+    const int numRead = juce::jmin(info.numSamples, fifo.getNumReady());
+    const int numChannels = juce::jmin(2, info.buffer->getNumChannels());
+
+    int start1, size1, start2, size2;
+    fifo.prepareToRead(numRead, start1, size1, start2, size2);
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        if (size1 > 0) info.buffer->copyFrom(ch, info.startSample, fifoBuffer, ch, start1, size1);
+        if (size2 > 0) info.buffer->copyFrom(ch, info.startSample + size1, fifoBuffer, ch, start2, size2);
+    }
+    fifo.finishedRead(size1 + size2);
+
+    // Read-ahead fell behind (or end of file): pad with silence
+    if (numRead < info.numSamples)
+        info.buffer->clear(info.startSample + numRead, info.numSamples - numRead);
+
+    consumedPosition += numRead;
+}
+
+void JuceMediaPlayer_Linux::seekToSample(int64_t sample)
+{
+    const int64_t length = lengthInSamples.load();
+    sample = juce::jlimit((int64_t)0, juce::jmax((int64_t)0, length), sample);
+
+    {
+        const juce::ScopedLock sl(readerLock);
+        readPosition = sample;
+        fifo.reset();
+        readerAtEnd = (reader == nullptr || sample >= length);
+    }
+
+    consumedPosition = sample;
+    resampler.flushBuffers();
+    readAheadThread.moveToFrontOfQueue(this);
+}
+
+void JuceMediaPlayer_Linux::updateResamplingRatio()
+{
+    resampler.setResamplingRatio(getSourceFramesPerOutputFrame());
+}
+
+double JuceMediaPlayer_Linux::getSourceFramesPerOutputFrame() const
+{
+    return (fileSampleRate / currentSampleRate) * (double)rate;
+}
@@ -0,0 +1,118 @@
+/*
+  ==============================================================================
+
+    JuceMediaPlayer_Linux.h
+    Playlisted2
+
+    Linux backend for the engine, built on JUCE's AudioFormatReaders
+    (WAV, AIFF, FLAC, Ogg Vorbis, MP3). Audio only - there is no video
+    decoder on Linux, video files fail to load.
+
+    Same interface as VLCMediaPlayer_Desktop so EngineMain treats every
+    platform alike:
+    - A background read-ahead thread decodes into a FIFO at the file's rate,
+      so the pump thread never touches the disk while playing.
+    - The pump pulls through a ResamplingAudioSource (file rate -> DAW rate,
+      times the playback rate) with click-free volume smoothing.
+    - getNumAudioSamplesAvailable() reports what the read-ahead can deliver
+      at the output rate, like VLC's amem FIFO.
+
+    Threading: every public method is called from the engine pump thread;
+    readerLock only guards against the read-ahead thread.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_audio_formats/juce_audio_formats.h>
+#include <atomic>
+
+class JuceMediaPlayer_Linux : private juce::TimeSliceClient
+{
+public:
+    JuceMediaPlayer_Linux();
+    ~JuceMediaPlayer_Linux() override;
+
+    bool prepareToPlay(int samplesPerBlock, double sampleRate);
+    void releaseResources();
+    bool loadFile(const juce::String& path);
+    void play();
+    void pause();
+    void stop();
+    void setVolume(float newVolume);
+    float getVolume() const;
+    void setRate(float newRate);
+    float getRate() const;
+    bool hasFinished() const;
+
+    void getNextAudioBlock(const juce::AudioSourceChannelInfo& info);
+    int getNumAudioSamplesAvailable() const;
+    bool isAtEndOfStream() const;   // File fully decoded: what is available is all that is left
+
+    // No video on Linux - kept for interface parity
+    void setWindowHandle(void* handle);
+    void setVideoEnabled(bool enabled);
+
+    bool isPlaying() const;
+    float getPosition() const;
+    void setPosition(float pos);
+    int64_t getLengthMs() const;
+    double getPositionSeconds() const;   // Full resolution, for the status timeline
+
+    void flushAudioBuffers();
+    void setAudioDelay(int64_t delayMs);
+
+private:
+    // Feeds the resampler from the read-ahead FIFO, counting what it consumed
+    class FifoSource : public juce::AudioSource
+    {
+    public:
+        explicit FifoSource(JuceMediaPlayer_Linux& o) : owner(o) {}
+        void prepareToPlay(int, double) override {}
+        void releaseResources() override {}
+        void getNextAudioBlock(const juce::AudioSourceChannelInfo& info) override { owner.readFromFifo(info); }
+    private:
+        JuceMediaPlayer_Linux& owner;
+    };
+
+    int useTimeSlice() override;
+    void readFromFifo(const juce::AudioSourceChannelInfo& info);
+    void seekToSample(int64_t sample);
+    void updateResamplingRatio();
+    double getSourceFramesPerOutputFrame() const;
+
+    static constexpr int ReadAheadFrames = 65536;
+    static constexpr int ReadChunkFrames = 4096;
+
+    juce::AudioFormatManager formatManager;
+    juce::TimeSliceThread readAheadThread { "Playlisted Read-Ahead" };
+
+    // Guarded by readerLock (read-ahead thread vs. load / seek)
+    juce::CriticalSection readerLock;
+    std::unique_ptr<juce::AudioFormatReader> reader;
+    int64_t readPosition = 0;                 // Next file frame the read-ahead decodes
+
+    juce::AudioBuffer<float> fifoBuffer { 2, ReadAheadFrames };
+    juce::AbstractFifo fifo { ReadAheadFrames };
+
+    FifoSource fifoSource { *this };
+    juce::ResamplingAudioSource resampler { &fifoSource, false, 2 };
+
+    std::atomic<int64_t> consumedPosition { 0 };   // Next file frame handed to the resampler
+    std::atomic<int64_t> lengthInSamples { 0 };
+    std::atomic<bool> readerAtEnd { false };
+    std::atomic<bool> playing { false };
+
+    double currentSampleRate = 44100.0;
+    double fileSampleRate = 44100.0;
+    float rate = 1.0f;
+
+    // Volume with smoothing
+    float volume = 1.0f;
+    float smoothedVolume = 1.0f;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(JuceMediaPlayer_Linux)
+};
@@ -49,6 +49,7 @@ public:
     float getPosition() const;
     void setPosition(float pos);
     int64_t getLengthMs() const;
+    double getPositionSeconds() const;   // Full resolution, for the status timeline
 
     // Callbacks
     void getNextAudioBlock(const juce::AudioSourceChannelInfo& info);
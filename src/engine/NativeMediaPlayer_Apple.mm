@@ -489,6 +489,16 @@ void NativeMediaPlayer_Apple::setPosition(float pos)
     }
 }
 
+double NativeMediaPlayer_Apple::getPositionSeconds() const
+{
+    if (isUsingAVAudio)
+    {
+        const double rate = avAudioExtractor->getSampleRate();
+        return rate > 0 ? avAudioExtractor->getCurrentPosition() / rate : 0.0;
+    }
+    return transportSource.getCurrentPosition();
+}
+
 int64_t NativeMediaPlayer_Apple::getLengthMs() const
 {
     if (isUsingAVAudio)
@@ -0,0 +1,179 @@
+/*
+  ==============================================================================
+
+    PcmDeinterleave.h
+    Playlisted2 Engine
+
+    Interleaved stereo (as libVLC's amem delivers it) to two planar float
+    channels, for the VLC audio callback.
+    - FL32: deinterleave only.
+    - S16N: deinterleave and scale by 1/32768.
+
+    Each kernel has a scalar reference; the dispatched versions use AVX when
+    the build enables it (/arch:AVX, -mavx), otherwise SSE2 on x86-64 and NEON
+    on ARM64. Selection is at compile time, so there is no dispatch cost per
+    callback. Plain C++, no JUCE (also used by PcmConvertBench).
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <cstdint>
+
+#if defined(__AVX__)
+    #include <immintrin.h>
+    #define PLAYLISTED_PCM_AVX 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define PLAYLISTED_PCM_SSE2 1
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+    #include <arm_neon.h>
+    #define PLAYLISTED_PCM_NEON 1
+#endif
+
+namespace PcmDeinterleave
+{
+    constexpr float S16Scale = 1.0f / 32768.0f;
+
+    // ==============================================================================
+    // Scalar reference (and the tail of every vector kernel)
+
+    inline void f32Scalar(const float* src, float* left, float* right, int numFrames)
+    {
+        for (int i = 0; i < numFrames; ++i)
+        {
+            left[i] = src[2 * i];
+            right[i] = src[2 * i + 1];
+        }
+    }
+
+    inline void s16Scalar(const int16_t* src, float* left, float* right, int numFrames)
+    {
+        for (int i = 0; i < numFrames; ++i)
+        {
+            left[i] = (float)src[2 * i] * S16Scale;
+            right[i] = (float)src[2 * i + 1] * S16Scale;
+        }
+    }
+
+    // ==============================================================================
+    // Vector kernels. Unaligned loads and stores: amem buffers and ring offsets have no alignment.
+
+   #if PLAYLISTED_PCM_AVX
+    inline const char* getKernelName() { return "avx"; }
+
+    // Two 8-float registers (L0 R0 .. L3 R3 | L4 R4 .. L7 R7) to L0..L7 and R0..R7
+    inline void splitAvx(__m256 a, __m256 b, float* left, float* right)
+    {
+        // Regroup the 128-bit lanes first: AVX shuffles do not cross them
+        const __m256 lo = _mm256_permute2f128_ps(a, b, 0x20);   // L0 R0 L1 R1 | L4 R4 L5 R5
+        const __m256 hi = _mm256_permute2f128_ps(a, b, 0x31);   // L2 R2 L3 R3 | L6 R6 L7 R7
+        _mm256_storeu_ps(left,  _mm256_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0)));
+        _mm256_storeu_ps(right, _mm256_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1)));
+    }
+
+    inline void f32(const float* src, float* left, float* right, int numFrames)
+    {
+        int i = 0;
+        for (; i + 8 <= numFrames; i += 8)
+            splitAvx(_mm256_loadu_ps(src + 2 * i), _mm256_loadu_ps(src + 2 * i + 8), left + i, right + i);
+
+        f32Scalar(src + 2 * i, left + i, right + i, numFrames - i);
+    }
+
+    // Four interleaved frames (8 x int16) to 8 scaled floats, in order
+    inline __m256 s16ToFloatAvx(__m128i x, __m256 scale)
+    {
+        const __m128i lo = _mm_cvtepi16_epi32(x);                     // SSE4.1, implied by AVX
+        const __m128i hi = _mm_cvtepi16_epi32(_mm_srli_si128(x, 8));
+        const __m256i both = _mm256_insertf128_si256(_mm256_castsi128_si256(lo), hi, 1);
+        return _mm256_mul_ps(_mm256_cvtepi32_ps(both), scale);
+    }
+
+    inline void s16(const int16_t* src, float* left, float* right, int numFrames)
+    {
+        const __m256 scale = _mm256_set1_ps(S16Scale);
+        int i = 0;
+        for (; i + 8 <= numFrames; i += 8)
+        {
+            const __m256 a = s16ToFloatAvx(_mm_loadu_si128((const __m128i*)(src + 2 * i)), scale);
+            const __m256 b = s16ToFloatAvx(_mm_loadu_si128((const __m128i*)(src + 2 * i + 8)), scale);
+            splitAvx(a, b, left + i, right + i);
+        }
+
+        s16Scalar(src + 2 * i, left + i, right + i, numFrames - i);
+    }
+
+   #elif PLAYLISTED_PCM_SSE2
+    inline const char* getKernelName() { return "sse2"; }
+
+    // (L0 R0 L1 R1), (L2 R2 L3 R3) to L0..L3 and R0..R3
+    inline void splitSse(__m128 a, __m128 b, float* left, float* right)
+    {
+        _mm_storeu_ps(left,  _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+        _mm_storeu_ps(right, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+    }
+
+    inline void f32(const float* src, float* left, float* right, int numFrames)
+    {
+        int i = 0;
+        for (; i + 4 <= numFrames; i += 4)
+            splitSse(_mm_loadu_ps(src + 2 * i), _mm_loadu_ps(src + 2 * i + 4), left + i, right + i);
+
+        f32Scalar(src + 2 * i, left + i, right + i, numFrames - i);
+    }
+
+    inline void s16(const int16_t* src, float* left, float* right, int numFrames)
+    {
+        const __m128 scale = _mm_set1_ps(S16Scale);
+        int i = 0;
+        for (; i + 4 <= numFrames; i += 4)
+        {
+            const __m128i x = _mm_loadu_si128((const __m128i*)(src + 2 * i));
+            // Sign-extend: put each sample in the top half of a 32-bit lane, shift it back down
+            const __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+            const __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16);
+            splitSse(_mm_mul_ps(_mm_cvtepi32_ps(lo), scale), _mm_mul_ps(_mm_cvtepi32_ps(hi), scale), left + i, right + i);
+        }
+
+        s16Scalar(src + 2 * i, left + i, right + i, numFrames - i);
+    }
+
+   #elif PLAYLISTED_PCM_NEON
+    inline const char* getKernelName() { return "neon"; }
+
+    inline void f32(const float* src, float* left, float* right, int numFrames)
+    {
+        int i = 0;
+        for (; i + 4 <= numFrames; i += 4)
+        {
+            const float32x4x2_t v = vld2q_f32(src + 2 * i);   // Deinterleaving load
+            vst1q_f32(left + i, v.val[0]);
+            vst1q_f32(right + i, v.val[1]);
+        }
+
+        f32Scalar(src + 2 * i, left + i, right + i, numFrames - i);
+    }
+
+    inline void s16(const int16_t* src, float* left, float* right, int numFrames)
+    {
+        int i = 0;
+        for (; i + 8 <= numFrames; i += 8)
+        {
+            const int16x8x2_t v = vld2q_s16(src + 2 * i);
+            vst1q_f32(left + i,      vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(v.val[0]))), S16Scale));
+            vst1q_f32(left + i + 4,  vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(v.val[0]))), S16Scale));
+            vst1q_f32(right + i,     vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(v.val[1]))), S16Scale));
+            vst1q_f32(right + i + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(v.val[1]))), S16Scale));
+        }
+
+        s16Scalar(src + 2 * i, left + i, right + i, numFrames - i);
+    }
+
+   #else
+    inline const char* getKernelName() { return "scalar"; }
+
+    inline void f32(const float* src, float* left, float* right, int numFrames) { f32Scalar(src, left, right, numFrames); }
+    inline void s16(const int16_t* src, float* left, float* right, int numFrames) { s16Scalar(src, left, right, numFrames); }
+   #endif
+}
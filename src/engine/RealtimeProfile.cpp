@@ -0,0 +1,172 @@
+/*
+  ==============================================================================
+
+    RealtimeProfile.cpp
+    Playlisted2 Engine
+
+  ==============================================================================
+*/
+
+#include "RealtimeProfile.h"
+
+#if JUCE_WINDOWS
+    #include <windows.h>
+#elif JUCE_MAC
+    #include <mach/mach.h>
+    #include <mach/mach_time.h>
+    #include <mach/thread_policy.h>
+    #include <pthread.h>
+#elif JUCE_LINUX
+    #include <pthread.h>
+    #include <sched.h>
+    #include <sys/mman.h>
+    #include <sys/resource.h>
+#endif
+
+#include <cerrno>
+#include <cstring>
+
+namespace
+{
+    // Touch the pages the pump's deepest call chains will use, so they are mapped before the first block
+    void prefaultStack()
+    {
+        constexpr size_t stackBytes = 128 * 1024;   // Well inside the smallest default thread stack (512 KB, macOS)
+        volatile uint8_t stack[stackBytes];
+        for (size_t i = 0; i < stackBytes; i += 4096)
+            stack[i] = 0;
+    }
+}
+
+RealtimeProfile RealtimeProfile::fromEnvironment()
+{
+    RealtimeProfile p;
+    p.enabled = juce::SystemStats::getEnvironmentVariable("PLAYLISTED_RT", "1").getIntValue() != 0;
+    p.policy = juce::SystemStats::getEnvironmentVariable("PLAYLISTED_RT_POLICY", "fifo").trim().equalsIgnoreCase("rr")
+             ? Policy::RoundRobin : Policy::Fifo;
+
+    const auto priority = juce::SystemStats::getEnvironmentVariable("PLAYLISTED_RT_PRIORITY", {});
+    if (priority.isNotEmpty()) p.priority = juce::jlimit(1, 99, priority.getIntValue());
+
+    const auto cpu = juce::SystemStats::getEnvironmentVariable("PLAYLISTED_RT_CPU", {});
+    if (cpu.isNotEmpty() && cpu.getIntValue() >= 0 && cpu.getIntValue() < juce::SystemStats::getNumCpus())
+        p.cpu = cpu.getIntValue();
+
+    p.lockMemory = juce::SystemStats::getEnvironmentVariable("PLAYLISTED_RT_MLOCK", {}).getIntValue() != 0;
+    return p;
+}
+
+juce::String RealtimeProfile::applyToCurrentThread(double periodMs, double computationMs) const
+{
+    prefaultStack();
+
+    if (!enabled) return "RT profile off (PLAYLISTED_RT=0)";
+
+    juce::StringArray applied;
+
+   #if JUCE_LINUX
+    {
+        const int osPolicy = policy == Policy::RoundRobin ? SCHED_RR : SCHED_FIFO;
+        const char* policyName = policy == Policy::RoundRobin ? "SCHED_RR" : "SCHED_FIFO";
+        int prio = juce::jlimit(sched_get_priority_min(osPolicy), sched_get_priority_max(osPolicy), priority);
+
+        sched_param param {};
+        param.sched_priority = prio;
+        int result = pthread_setschedparam(pthread_self(), osPolicy, &param);
+
+        // Root / CAP_SYS_NICE get the requested priority above; unprivileged users may
+        // still get RT up to RLIMIT_RTPRIO (e.g. the audio group)
+        rlimit limit {};
+        if (result == EPERM && getrlimit(RLIMIT_RTPRIO, &limit) == 0
+            && limit.rlim_cur != RLIM_INFINITY && limit.rlim_cur > 0 && (rlim_t)prio > limit.rlim_cur)
+        {
+            prio = (int)limit.rlim_cur;
+            param.sched_priority = prio;
+            result = pthread_setschedparam(pthread_self(), osPolicy, &param);
+        }
+
+        if (result == 0)
+            applied.add(juce::String(policyName) + " " + juce::String(prio));
+        else
+            applied.add(juce::String(policyName) + " not permitted (" + juce::String(std::strerror(result))
+                        + ", RLIMIT_RTPRIO " + juce::String((int)limit.rlim_cur) + "), normal priority");
+
+        if (cpu >= 0)
+        {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(cpu, &set);
+            applied.add(pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0
+                        ? "CPU " + juce::String(cpu) : "CPU affinity failed");
+        }
+    }
+   #elif JUCE_MAC
+    {
+        // Mach time-constraint policy: the kernel guarantees `computation` of every `period`
+        mach_timebase_info_data_t timebase;
+        mach_timebase_info(&timebase);
+        const double ticksPerMs = 1.0e6 * (double)timebase.denom / (double)timebase.numer;
+
+        thread_time_constraint_policy_data_t policyData;
+        policyData.period = (uint32_t)(periodMs * ticksPerMs);
+        policyData.computation = (uint32_t)(computationMs * ticksPerMs);
+        policyData.constraint = (uint32_t)(juce::jmin(periodMs, computationMs * 2.0) * ticksPerMs);
+        policyData.preemptible = 1;
+
+        const auto result = thread_policy_set(pthread_mach_thread_np(pthread_self()), THREAD_TIME_CONSTRAINT_POLICY,
+                                              (thread_policy_t)&policyData, THREAD_TIME_CONSTRAINT_POLICY_COUNT);
+        applied.add(result == KERN_SUCCESS
+                    ? "time constraint " + juce::String(computationMs, 1) + "/" + juce::String(periodMs, 1) + " ms"
+                    : "time constraint policy failed (" + juce::String((int)result) + ")");
+
+        if (cpu >= 0) applied.add("CPU affinity not supported on macOS");
+    }
+   #elif JUCE_WINDOWS
+    {
+        juce::ignoreUnused(periodMs, computationMs);
+
+        applied.add(SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL)
+                    ? "TIME_CRITICAL" : "TIME_CRITICAL failed");
+
+        // MMCSS lifts the thread out of normal scheduling - loaded dynamically, avrt is not linked
+        using AvSetMmThreadCharacteristicsFn = HANDLE (WINAPI*)(LPCWSTR, LPDWORD);
+        if (auto avrt = LoadLibraryW(L"avrt.dll"))
+        {
+            auto setCharacteristics = (AvSetMmThreadCharacteristicsFn)GetProcAddress(avrt, "AvSetMmThreadCharacteristicsW");
+            DWORD taskIndex = 0;
+            applied.add(setCharacteristics != nullptr && setCharacteristics(L"Pro Audio", &taskIndex) != nullptr
+                        ? "MMCSS Pro Audio" : "MMCSS failed");
+        }
+
+        if (cpu >= 0)
+            applied.add(SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << cpu) != 0
+                        ? "CPU " + juce::String(cpu) : "CPU affinity failed");
+    }
+   #else
+    juce::ignoreUnused(periodMs, computationMs);
+   #endif
+
+    return "RT profile: " + applied.joinIntoString(", ");
+}
+
+juce::String RealtimeProfile::lockProcessMemory() const
+{
+    if (!enabled || !lockMemory) return "memory not locked (PLAYLISTED_RT_MLOCK=0)";
+
+   #if JUCE_LINUX
+    // Current pages only: MCL_FUTURE would make later allocations fail once RLIMIT_MEMLOCK is reached.
+    // Deck segments created later are locked one by one (IPCConfig::shouldLockSegments).
+    if (mlockall(MCL_CURRENT) == 0) return "process memory locked (mlockall)";
+    return "mlockall failed (" + juce::String(std::strerror(errno)) + "), segments locked individually";
+   #elif JUCE_WINDOWS
+    // Room in the working set for what VirtualLock pins (segments)
+    SIZE_T minWs = 0, maxWs = 0;
+    auto process = GetCurrentProcess();
+    if (GetProcessWorkingSetSize(process, &minWs, &maxWs)
+        && SetProcessWorkingSetSize(process, minWs + 64 * 1024 * 1024, juce::jmax(maxWs, minWs + 64 * 1024 * 1024)))
+        return "working set raised by 64 MB, segments locked individually";
+    return "working set unchanged, segments locked individually";
+   #else
+    return "segments locked individually (no mlockall on this platform)";
+   #endif
+}
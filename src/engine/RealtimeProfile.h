@@ -0,0 +1,134 @@
+/*
+  ==============================================================================
+
+    RealtimeProfile.h
+    Playlisted2 Engine
+
+    Real-time setup for the engine's audio pump thread, and the deadline
+    statistics that show whether it pays off.
+
+    - Scheduling: Linux SCHED_FIFO / SCHED_RR at a configurable priority
+      (retried at RLIMIT_RTPRIO if not permitted, else normal priority), macOS
+      Mach time-constraint policy, Windows TIME_CRITICAL + MMCSS "Pro Audio".
+    - Optional CPU affinity (Linux, Windows).
+    - Optional memory locking: mlockall (Linux) / working set (Windows), and
+      the IPC segments (see IPCConfig::shouldLockSegments).
+    - The pump's stack is prefaulted when the profile is applied.
+
+    Environment (read once by the engine):
+        PLAYLISTED_RT=0                  keep JUCE's plain "highest" priority
+        PLAYLISTED_RT_POLICY=fifo|rr     Linux policy (default fifo)
+        PLAYLISTED_RT_PRIORITY=1..99     Linux priority (default 70)
+        PLAYLISTED_RT_CPU=<n>            pin the pump to CPU n
+        PLAYLISTED_RT_MLOCK=1            lock process memory and segments
+
+    Every step is best effort: what could not be applied is reported in the
+    description and the pump simply runs with less.
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <juce_core/juce_core.h>
+#include <algorithm>
+#include <iterator>
+#include <cstdint>
+
+struct RealtimeProfile
+{
+    enum class Policy { Fifo, RoundRobin };
+
+    bool enabled = true;
+    Policy policy = Policy::Fifo;
+    int priority = 70;
+    int cpu = -1;               // -1 = no affinity
+    bool lockMemory = false;
+
+    static RealtimeProfile fromEnvironment();
+
+    // Pump thread, once at start. periodMs / computationMs describe the pump's duty cycle
+    // (used by the macOS time-constraint policy). Returns what was applied, for the log.
+    juce::String applyToCurrentThread(double periodMs, double computationMs) const;
+
+    // Message thread, at startup. Returns what was applied, for the log.
+    juce::String lockProcessMemory() const;
+};
+
+// Pump wake-up lateness and work time. Pump thread only; the summary it takes is plain data,
+// so it can be handed to another thread and formatted there.
+class PumpDeadlineStats
+{
+public:
+    static constexpr double missThresholdMs = 1.0;   // Woke this much past the deadline: counted as missed
+
+    // One interval
+    struct Summary
+    {
+        uint64_t wakeups = 0, missed = 0, missedTotal = 0;
+        uint64_t lateBuckets[5] = {};
+        double maxLateMs = 0.0, avgWorkMs = 0.0, maxWorkMs = 0.0;
+
+        // Allocates: not on the pump
+        juce::String toString() const
+        {
+            juce::String text;
+            text << "deadlines: " << (int)missed << "/" << (int)wakeups << " missed (>= "
+                 << juce::String(missThresholdMs, 1) << " ms late, " << (int)missedTotal << " total), late <0.5/<1/<2/<5/>=5 ms "
+                 << (int)lateBuckets[0] << "/" << (int)lateBuckets[1] << "/" << (int)lateBuckets[2] << "/"
+                 << (int)lateBuckets[3] << "/" << (int)lateBuckets[4]
+                 << ", max late " << juce::String(maxLateMs, 2) << " ms, work avg "
+                 << juce::String(avgWorkMs, 3) << " max " << juce::String(maxWorkMs, 3) << " ms";
+            return text;
+        }
+    };
+
+    // A timed sleep ended: how far past its deadline we actually woke
+    void addWakeup(double lateMs)
+    {
+        lateMs = std::max(0.0, lateMs);
+        ++wakeups;
+        if (lateMs >= missThresholdMs) ++missed;
+        maxLateMs = std::max(maxLateMs, lateMs);
+
+        if (lateMs < 0.5)      ++lateBuckets[0];
+        else if (lateMs < 1.0) ++lateBuckets[1];
+        else if (lateMs < 2.0) ++lateBuckets[2];
+        else if (lateMs < 5.0) ++lateBuckets[3];
+        else                   ++lateBuckets[4];
+    }
+
+    // One pass over every deck
+    void addWork(double workMs)
+    {
+        ++passes;
+        totalWorkMs += workMs;
+        maxWorkMs = std::max(maxWorkMs, workMs);
+    }
+
+    uint64_t getMissedTotal() const { return missedTotal + missed; }
+
+    // Summary since the last call, then starts a new interval. Does not allocate.
+    Summary takeSummary()
+    {
+        Summary s;
+        s.wakeups = wakeups;
+        s.missed = missed;
+        s.missedTotal = getMissedTotal();
+        std::copy(std::begin(lateBuckets), std::end(lateBuckets), std::begin(s.lateBuckets));
+        s.maxLateMs = maxLateMs;
+        s.avgWorkMs = passes > 0 ? totalWorkMs / (double)passes : 0.0;
+        s.maxWorkMs = maxWorkMs;
+
+        missedTotal += missed;
+        wakeups = missed = passes = 0;
+        std::fill(std::begin(lateBuckets), std::end(lateBuckets), (uint64_t)0);
+        maxLateMs = maxWorkMs = totalWorkMs = 0.0;
+        return s;
+    }
+
+private:
+    uint64_t missedTotal = 0;
+    uint64_t wakeups = 0, missed = 0, passes = 0;
+    uint64_t lateBuckets[5] = {};
+    double maxLateMs = 0.0, maxWorkMs = 0.0, totalWorkMs = 0.0;
+};
@@ -0,0 +1,138 @@
+/*
+  ==============================================================================
+
+    SpscPcmFifo.h
+    Playlisted2 Engine
+
+    Planar stereo FIFO between a decoder callback thread (producer, e.g. VLC's
+    amem) and the engine pump (consumer), without a lock.
+
+    - Free-running frame counters masked by a power-of-two capacity, as in
+      SpscAudioRing; each side owns one index. Both sides are wait-free.
+    - Flush protocol: any thread may requestFlush(). It publishes a new epoch
+      together with the write index at that moment, in one 64-bit atomic. The
+      consumer applies it on its next call: everything written before the
+      request is skipped, and the caller is told so it can reset its own
+      state (delay line, ramps). Nobody blocks, and the producer never
+      touches the read index. The latest request wins.
+    - A full FIFO drops what does not fit (counted); a consumer read that
+      comes up short is counted as a late block by the caller.
+
+    Storage is allocated once in the constructor. Plain C++, no JUCE.
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+class SpscPcmFifo
+{
+public:
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "Flush requests need lock-free 64-bit atomics");
+
+    // capacityFrames must be a power of two
+    explicit SpscPcmFifo(uint32_t capacityFrames)
+        : capacity(capacityFrames), mask(capacityFrames - 1),
+          left(capacityFrames, 0.0f), right(capacityFrames, 0.0f)
+    {
+    }
+
+    uint32_t getCapacity() const { return capacity; }
+
+    // ==============================================================================
+    // Producer
+
+    // fill(left, right, offset, count) writes `count` frames, `offset` frames into the block,
+    // once per contiguous run (twice at the wrap). Returns frames written; the rest is dropped.
+    template <typename FillFn>
+    uint32_t write(uint32_t numFrames, FillFn&& fill)
+    {
+        const uint32_t w = writeIndex.load(std::memory_order_relaxed);
+        const uint32_t r = readIndex.load(std::memory_order_acquire);
+        const uint32_t free = capacity - (w - r);
+        const uint32_t toWrite = numFrames < free ? numFrames : free;
+
+        if (toWrite < numFrames)
+            droppedFrames.fetch_add(numFrames - toWrite, std::memory_order_relaxed);
+
+        const uint32_t start = w & mask;
+        const uint32_t first = toWrite < capacity - start ? toWrite : capacity - start;
+        if (first > 0)           fill(left.data() + start, right.data() + start, 0u, first);
+        if (toWrite > first)     fill(left.data(), right.data(), first, toWrite - first);
+
+        writeIndex.store(w + toWrite, std::memory_order_release);
+        return toWrite;
+    }
+
+    // ==============================================================================
+    // Any thread
+
+    void requestFlush()
+    {
+        uint64_t current = flushRequest.load(std::memory_order_relaxed);
+        uint64_t desired;
+        do
+        {
+            const uint64_t epoch = (current >> 32) + 1;
+            desired = (epoch << 32) | writeIndex.load(std::memory_order_acquire);
+        }
+        while (!flushRequest.compare_exchange_weak(current, desired, std::memory_order_acq_rel, std::memory_order_relaxed));
+    }
+
+    uint32_t getDroppedFrames() const { return droppedFrames.load(std::memory_order_relaxed); }
+
+    // ==============================================================================
+    // Consumer
+
+    // Skips what was written before the latest flush request. True if one was pending.
+    bool applyPendingFlush()
+    {
+        const uint64_t request = flushRequest.load(std::memory_order_acquire);
+        const uint32_t epoch = (uint32_t)(request >> 32);
+        if (epoch == consumerEpoch) return false;
+
+        consumerEpoch = epoch;
+        const uint32_t flushTo = (uint32_t)request;
+        const uint32_t r = readIndex.load(std::memory_order_relaxed);
+
+        // Audio read since the request (flushTo behind r) was written after it: keep our position
+        if ((int32_t)(flushTo - r) > 0)
+            readIndex.store(flushTo, std::memory_order_release);
+        return true;
+    }
+
+    uint32_t getNumReady() const
+    {
+        return writeIndex.load(std::memory_order_acquire) - readIndex.load(std::memory_order_relaxed);
+    }
+
+    // consume(left, right, offset, count) per contiguous run. Returns frames read.
+    template <typename ConsumeFn>
+    uint32_t read(uint32_t numFrames, ConsumeFn&& consume)
+    {
+        const uint32_t r = readIndex.load(std::memory_order_relaxed);
+        const uint32_t ready = writeIndex.load(std::memory_order_acquire) - r;
+        const uint32_t toRead = numFrames < ready ? numFrames : ready;
+
+        const uint32_t start = r & mask;
+        const uint32_t first = toRead < capacity - start ? toRead : capacity - start;
+        if (first > 0)          consume(left.data() + start, right.data() + start, 0u, first);
+        if (toRead > first)     consume(left.data(), right.data(), first, toRead - first);
+
+        readIndex.store(r + toRead, std::memory_order_release);
+        return toRead;
+    }
+
+private:
+    const uint32_t capacity, mask;
+    std::vector<float> left, right;
+
+    alignas(64) std::atomic<uint32_t> writeIndex { 0 };
+    alignas(64) std::atomic<uint32_t> readIndex { 0 };
+    alignas(64) std::atomic<uint64_t> flushRequest { 0 };   // epoch << 32 | write index at the request
+    std::atomic<uint32_t> droppedFrames { 0 };
+    uint32_t consumerEpoch = 0;                               // Consumer only
+};
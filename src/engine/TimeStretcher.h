@@ -0,0 +1,366 @@
+/*
+  ==============================================================================
+
+    TimeStretcher.h
+    Playlisted2 Engine
+
+    Pitch-preserving playback speed for the deck (WSOLA). The player decodes
+    at 1x; this turns its audio into `rate` times faster / slower audio at
+    the same pitch, so speed and the plugin's pitch shift stay independent.
+
+    Per output hop (half a window, ~11 ms at 44.1/48 kHz):
+    - the analysis position moves on by hop * rate source frames;
+    - within +-tolerance of it, the segment most similar (normalized cross
+      correlation, on the mono mix) to the natural continuation of the last
+      one is picked, so waveforms line up and nothing phases or clicks;
+    - that segment is overlap-added with a periodic Hann window, whose two
+      halves sum to one.
+
+    The rate is read once per hop, so it can change at any time without a
+    flush: the next hop simply advances by a different amount. At exactly
+    1x the search is skipped and the next segment is the continuation
+    itself, which makes the output the input, frame for frame, and the
+    stretcher can stay in the path at every speed.
+
+    The correlation search is the only hot loop: dot products in AVX, SSE2
+    or NEON, selected at compile time like PcmDeinterleave.
+
+    All storage is allocated in the constructor for the highest sample rate;
+    prepare() / reset() / everything else do not allocate. One thread (the
+    pump). Plain C++, no JUCE (also used by TimeStretchBench).
+
+  ==============================================================================
+*/
+
+#pragma once
+#include "PcmDeinterleave.h"   // PLAYLISTED_PCM_AVX / SSE2 / NEON and their intrinsics
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+namespace TimeStretchKernels
+{
+    inline float dotScalar(const float* a, const float* b, int n)
+    {
+        float sum = 0.0f;
+        for (int i = 0; i < n; ++i)
+            sum += a[i] * b[i];
+        return sum;
+    }
+
+    // Unaligned loads: candidates start at every frame. Four accumulators hide the add latency.
+   #if PLAYLISTED_PCM_AVX
+    inline float dot(const float* a, const float* b, int n)
+    {
+        __m256 s0 = _mm256_setzero_ps(), s1 = s0, s2 = s0, s3 = s0;
+        int i = 0;
+        for (; i + 32 <= n; i += 32)
+        {
+            s0 = _mm256_add_ps(s0, _mm256_mul_ps(_mm256_loadu_ps(a + i),      _mm256_loadu_ps(b + i)));
+            s1 = _mm256_add_ps(s1, _mm256_mul_ps(_mm256_loadu_ps(a + i + 8),  _mm256_loadu_ps(b + i + 8)));
+            s2 = _mm256_add_ps(s2, _mm256_mul_ps(_mm256_loadu_ps(a + i + 16), _mm256_loadu_ps(b + i + 16)));
+            s3 = _mm256_add_ps(s3, _mm256_mul_ps(_mm256_loadu_ps(a + i + 24), _mm256_loadu_ps(b + i + 24)));
+        }
+        const __m256 s = _mm256_add_ps(_mm256_add_ps(s0, s1), _mm256_add_ps(s2, s3));
+        __m128 h = _mm_add_ps(_mm256_castps256_ps128(s), _mm256_extractf128_ps(s, 1));
+        h = _mm_add_ps(h, _mm_movehl_ps(h, h));
+        h = _mm_add_ss(h, _mm_shuffle_ps(h, h, 1));
+        return _mm_cvtss_f32(h) + dotScalar(a + i, b + i, n - i);
+    }
+   #elif PLAYLISTED_PCM_SSE2
+    inline float dot(const float* a, const float* b, int n)
+    {
+        __m128 s0 = _mm_setzero_ps(), s1 = s0, s2 = s0, s3 = s0;
+        int i = 0;
+        for (; i + 16 <= n; i += 16)
+        {
+            s0 = _mm_add_ps(s0, _mm_mul_ps(_mm_loadu_ps(a + i),      _mm_loadu_ps(b + i)));
+            s1 = _mm_add_ps(s1, _mm_mul_ps(_mm_loadu_ps(a + i + 4),  _mm_loadu_ps(b + i + 4)));
+            s2 = _mm_add_ps(s2, _mm_mul_ps(_mm_loadu_ps(a + i + 8),  _mm_loadu_ps(b + i + 8)));
+            s3 = _mm_add_ps(s3, _mm_mul_ps(_mm_loadu_ps(a + i + 12), _mm_loadu_ps(b + i + 12)));
+        }
+        __m128 h = _mm_add_ps(_mm_add_ps(s0, s1), _mm_add_ps(s2, s3));
+        h = _mm_add_ps(h, _mm_movehl_ps(h, h));
+        h = _mm_add_ss(h, _mm_shuffle_ps(h, h, 1));
+        return _mm_cvtss_f32(h) + dotScalar(a + i, b + i, n - i);
+    }
+   #elif PLAYLISTED_PCM_NEON
+    inline float dot(const float* a, const float* b, int n)
+    {
+        float32x4_t s0 = vdupq_n_f32(0.0f), s1 = s0, s2 = s0, s3 = s0;
+        int i = 0;
+        for (; i + 16 <= n; i += 16)
+        {
+            s0 = vmlaq_f32(s0, vld1q_f32(a + i),      vld1q_f32(b + i));
+            s1 = vmlaq_f32(s1, vld1q_f32(a + i + 4),  vld1q_f32(b + i + 4));
+            s2 = vmlaq_f32(s2, vld1q_f32(a + i + 8),  vld1q_f32(b + i + 8));
+            s3 = vmlaq_f32(s3, vld1q_f32(a + i + 12), vld1q_f32(b + i + 12));
+        }
+        const float32x4_t s = vaddq_f32(vaddq_f32(s0, s1), vaddq_f32(s2, s3));
+        const float32x2_t h = vadd_f32(vget_low_f32(s), vget_high_f32(s));
+        return vget_lane_f32(vpadd_f32(h, h), 0) + dotScalar(a + i, b + i, n - i);
+    }
+   #else
+    inline float dot(const float* a, const float* b, int n) { return dotScalar(a, b, n); }
+   #endif
+}
+
+class TimeStretcher
+{
+public:
+    static constexpr double minRate = 0.1;
+    static constexpr double maxRate = 4.0;
+
+    explicit TimeStretcher(double maxSampleRate = 192000.0, int maxBlockFrames = 4096)
+    {
+        const int maxWindow = getWindowFramesFor(maxSampleRate);
+        const int maxHop = maxWindow / 2;
+
+        // Kept: template start / search start to the end of the next hop's reach, plus one push
+        inputCapacity = maxWindow * 2 + (int)std::ceil(maxHop * maxRate) + maxHop + maxBlockFrames;
+        outputCapacity = maxHop + maxBlockFrames;
+
+        for (auto* v : { &inLeft, &inRight, &inMono })
+            v->assign((size_t)inputCapacity, 0.0f);
+        outLeft.assign((size_t)outputCapacity, 0.0f);
+        outRight.assign((size_t)outputCapacity, 0.0f);
+        tailLeft.assign((size_t)maxHop, 0.0f);
+        tailRight.assign((size_t)maxHop, 0.0f);
+        windowTable.assign((size_t)maxWindow, 0.0f);
+
+        prepare(44100.0);
+    }
+
+    // 20-25 ms windows (1024 frames at 44.1/48 kHz): long enough for bass periods,
+    // short enough not to smear transients
+    static int getWindowFramesFor(double sampleRate)
+    {
+        int frames = 256;
+        while (frames < sampleRate * 0.02 && frames < 8192) frames *= 2;
+        return frames;
+    }
+
+    void prepare(double sampleRate)
+    {
+        window = std::min(getWindowFramesFor(sampleRate), (int)windowTable.size());
+        hop = window / 2;
+        tolerance = window / 4;
+
+        // Periodic Hann: w[i] + w[i + hop] == 1
+        for (int i = 0; i < window; ++i)
+            windowTable[(size_t)i] = 0.5f - 0.5f * (float)std::cos(2.0 * 3.14159265358979323846 * i / window);
+
+        reset();
+    }
+
+    // Drops everything; the next output starts with the next input frame
+    void reset()
+    {
+        numInput = 0;
+        outRead = outCount = 0;
+        prevSegment = 0;
+        analysisPos = 0.0;
+        primed = false;
+    }
+
+    void setRate(double newRate) { rate = std::clamp(newRate, minRate, maxRate); }
+    double getRate() const { return rate; }
+
+    int getHopFrames() const { return hop; }
+    int getNumOutputReady() const { return outCount - outRead; }
+
+    // Source frames still missing before processHop() can run
+    int getInputNeeded() const { return std::max(0, getNextHopReach() - numInput); }
+
+    // Room for pushInput()
+    int getInputRoom()
+    {
+        compactInput();
+        return inputCapacity - numInput;
+    }
+
+    // Returns frames taken (up to getInputRoom())
+    int pushInput(const float* left, const float* right, int numFrames)
+    {
+        const int n = std::min(numFrames, getInputRoom());
+        std::memcpy(inLeft.data() + numInput, left, sizeof(float) * (size_t)n);
+        std::memcpy(inRight.data() + numInput, right, sizeof(float) * (size_t)n);
+        for (int i = 0; i < n; ++i)
+            inMono[(size_t)(numInput + i)] = 0.5f * (left[i] + right[i]);
+        numInput += n;
+        return n;
+    }
+
+    // One hop of output. Without enough input it does nothing and returns false, unless
+    // endOfInput: then the missing input is silence, for as long as the hop still carries
+    // some of the real input.
+    bool processHop(bool endOfInput)
+    {
+        compactInput();
+        if (outputCapacity - outCount < hop) compactOutput();
+        if (outputCapacity - outCount < hop) return false;
+
+        const int reach = getNextHopReach();
+        if (reach > numInput)
+        {
+            if (!endOfInput || getLastRealStart() >= numInput) return false;
+            padInput(reach);
+        }
+
+        const int segment = findSegment();
+        const float* rise = windowTable.data();
+        const float* fall = windowTable.data() + hop;
+
+        if (!primed)
+        {
+            // No previous segment: the template itself fades out, so the first hop is the input
+            for (int i = 0; i < hop; ++i)
+            {
+                tailLeft[(size_t)i] = fall[i] * inLeft[(size_t)i];
+                tailRight[(size_t)i] = fall[i] * inRight[(size_t)i];
+            }
+            primed = true;
+        }
+
+        float* dstL = outLeft.data() + outCount;
+        float* dstR = outRight.data() + outCount;
+        const float* segL = inLeft.data() + segment;
+        const float* segR = inRight.data() + segment;
+        for (int i = 0; i < hop; ++i)
+        {
+            dstL[i] = tailLeft[(size_t)i] + rise[i] * segL[i];
+            dstR[i] = tailRight[(size_t)i] + rise[i] * segR[i];
+            tailLeft[(size_t)i] = fall[i] * segL[hop + i];
+            tailRight[(size_t)i] = fall[i] * segR[hop + i];
+        }
+        outCount += hop;
+
+        prevSegment = segment;
+        analysisPos = isUnity() ? (double)(segment + hop) : analysisPos + hop * rate;
+        return true;
+    }
+
+    // Returns frames read (up to getNumOutputReady())
+    int readOutput(float* left, float* right, int numFrames)
+    {
+        const int n = std::min(numFrames, getNumOutputReady());
+        std::memcpy(left, outLeft.data() + outRead, sizeof(float) * (size_t)n);
+        std::memcpy(right, outRight.data() + outRead, sizeof(float) * (size_t)n);
+        outRead += n;
+        return n;
+    }
+
+    // Output the buffered input plus `extraInput` more source frames will make. At the end of
+    // the input this is everything left, so the caller can plan the track's last block.
+    int getOutputFramesFor(int extraInput, bool endOfInput) const
+    {
+        const int total = numInput + extraInput;
+        const double position = primed ? analysisPos : 0.0;
+
+        // Output past the end (the last hop's padding) does not count, nor do hops without real input
+        if (endOfInput)
+        {
+            int frames = getNumOutputReady() + (int)std::floor((total - position) / rate);
+            if (getLastRealStart() >= total) frames = std::min(frames, getNumOutputReady());
+            return std::max(0, frames);
+        }
+
+        const int reach = getNextHopReach();
+        if (total < reach) return getNumOutputReady();
+        return getNumOutputReady() + (1 + (int)((total - reach) / (hop * rate))) * hop;
+    }
+
+private:
+    bool isUnity() const { return std::abs(rate - 1.0) < 1.0e-4; }
+
+    // Where the continuation of the last segment starts: what the next one should resemble
+    int getTemplateStart() const { return primed ? prevSegment + hop : 0; }
+
+    int getNominalStart() const { return isUnity() ? getTemplateStart() : (int)std::lround(analysisPos); }
+
+    // The next hop still carries real input while its tail (the continuation) or its segment does
+    int getLastRealStart() const { return std::min(getTemplateStart(), getNominalStart()); }
+
+    // Input the next hop reads up to (exclusive)
+    int getNextHopReach() const { return getNominalStart() + (isUnity() ? 0 : tolerance) + window; }
+
+    // Best-aligned segment start for the next hop
+    int findSegment()
+    {
+        const int nominal = getNominalStart();
+        if (isUnity()) return nominal;
+
+        const float* templ = inMono.data() + getTemplateStart();
+        const float* mono = inMono.data();
+        const int first = std::max(0, nominal - tolerance);
+        const int last = nominal + tolerance;
+
+        // Energy of each candidate, slid along rather than recomputed
+        double energy = 0.0;
+        for (int i = 0; i < hop; ++i)
+            energy += (double)mono[first + i] * mono[first + i];
+
+        int best = std::clamp(nominal, first, last);
+        double bestScore = -1.0e30;
+        for (int start = first; start <= last; ++start)
+        {
+            const double score = (double)TimeStretchKernels::dot(templ, mono + start, hop) / std::sqrt(energy + 1.0e-9);
+            if (score > bestScore || (score == bestScore && start == nominal))
+            {
+                bestScore = score;
+                best = start;
+            }
+            energy += (double)mono[start + hop] * mono[start + hop] - (double)mono[start] * mono[start];
+            energy = std::max(0.0, energy);
+        }
+        return best;
+    }
+
+    void padInput(int upTo)
+    {
+        const size_t count = (size_t)(upTo - numInput);
+        std::fill_n(inLeft.data() + numInput, count, 0.0f);
+        std::fill_n(inRight.data() + numInput, count, 0.0f);
+        std::fill_n(inMono.data() + numInput, count, 0.0f);
+    }
+
+    // Drops input no future hop can read: before the next template and search window
+    void compactInput()
+    {
+        if (!primed) return;
+
+        const int keepFrom = std::max(0, std::min(getTemplateStart(), getNominalStart() - tolerance));
+        if (keepFrom == 0) return;
+
+        const int keep = std::max(0, numInput - keepFrom);
+        for (auto* v : { &inLeft, &inRight, &inMono })
+            std::memmove(v->data(), v->data() + keepFrom, sizeof(float) * (size_t)keep);
+
+        numInput = keep;
+        prevSegment -= keepFrom;
+        analysisPos -= keepFrom;
+    }
+
+    void compactOutput()
+    {
+        const int ready = getNumOutputReady();
+        std::memmove(outLeft.data(), outLeft.data() + outRead, sizeof(float) * (size_t)ready);
+        std::memmove(outRight.data(), outRight.data() + outRead, sizeof(float) * (size_t)ready);
+        outRead = 0;
+        outCount = ready;
+    }
+
+    std::vector<float> inLeft, inRight, inMono;       // Source frames, [0, numInput)
+    std::vector<float> outLeft, outRight;             // Finished output, [outRead, outCount)
+    std::vector<float> tailLeft, tailRight;           // Fading half of the last segment
+    std::vector<float> windowTable;
+
+    int inputCapacity = 0, outputCapacity = 0;
+    int window = 1024, hop = 512, tolerance = 256;
+    int numInput = 0, outRead = 0, outCount = 0;
+    int prevSegment = 0;          // Input index of the last segment
+    double analysisPos = 0.0;     // Input index the next hop is centred on
+    double rate = 1.0;
+    bool primed = false;
+};
@@ -4,14 +4,38 @@
     VLCMediaPlayer_Desktop.cpp
     Playlisted2 Engine
 
-    Uses S16N format (proven working with VLC 3.0.21 amem).
+    Uses FL32 format: amem hands over VLC's own float mix, no 16-bit
+    quantisation. S16N (proven working with VLC 3.0.21 amem) remains as a
+    fallback: PLAYLISTED_VLC_AUDIO_FORMAT=s16n.
     FIX: Volume smoothing to prevent clicks/pops on volume changes.
     FIX: Use LoadLibraryW for Unicode DLL paths.
+    ADDED: setVideoEnabled(false) loads media with :no-video and drops the
+           A/V sync delay (audio-only decks / headless engine).
+    PERF: The amem callback converts whole runs with the PcmDeinterleave
+          kernels (AVX / SSE2 / NEON) instead of one setSample() per sample
+          and channel.
+    PERF: audioLock is gone. VLC's callback thread and the pump share a
+          wait-free SpscPcmFifo; pause / seek / rate / amem flushes only post
+          a flush epoch, applied by the pump on its next read.
+    ADDED: A/V sync is measured instead of assumed (AvSyncController): the pts
+           amem passes with each buffer against VLC's clock, which paces the
+           video, plus the frames queued up to the DAW. Early audio is held in
+           the delay line, late audio is advanced with libVLC's audio delay;
+           corrections fade in over one block. The delay line copies in whole
+           runs instead of "% delayLen" per sample. libVLC's half of a
+           correction is set from the message thread, never on the pump.
+    FIX: After setPosition, audio VLC delivers before its seek flush (still
+         the old position) is dropped, so the engine pre-rolls on the target.
+         Seeks are counted: while several are in flight (a drag), audio is
+         only taken once the newest one's flush has arrived.
+    FIX: setRate no longer flushes the audio path (a dropout per speed-slider
+         move); VLC's scaletempo keeps the pitch, the queued audio plays out.
 
   ==============================================================================
 */
 
 #include "VLCMediaPlayer_Desktop.h"
+#include "PcmDeinterleave.h"
 #include <cstring>
 #include <juce_core/juce_core.h>
 
@@ -80,14 +104,23 @@ void VLCMediaPlayer_Desktop::ensureInitialized()
             "--no-skip-frames", 
             
             // Let VLC pace video with its internal clock to prevent drift.
-            // The 260ms delay line in getNextAudioBlock handles the fixed 
-            // pipeline offset (amem+FIFO+IPC is faster than video decode+render).
+            // Audio is measured against the same clock (amem pts) and the
+            // A/V sync controller corrects the offset of the audio path.
             "--clock-jitter=0",
 
             // 500ms caching gives decoder headroom
             "--file-caching=500",     
-            "--network-caching=500" 
+            "--network-caching=500",
+
+            // VLC paces amem in real time, so speed changes happen here: its
+            // scaletempo filter keeps the pitch (the default, stated on purpose)
+            "--audio-time-stretch"
         };
+        if (juce::SystemStats::getEnvironmentVariable("PLAYLISTED_VLC_AUDIO_FORMAT", {}).trim().equalsIgnoreCase("s16n"))
+            amemFormat = AmemFormat::Int16;
+
+        avSync.setTrimMs(juce::SystemStats::getEnvironmentVariable("PLAYLISTED_AV_TRIM_MS", "0").getIntValue());
+
         m_instance = libvlc_new(sizeof(args) / sizeof(args[0]), args);
         if (m_instance)
         {
@@ -95,7 +128,7 @@ void VLCMediaPlayer_Desktop::ensureInitialized()
             if (m_mediaPlayer)
             {
                 libvlc_audio_set_callbacks(m_mediaPlayer, audioPlay, audioPause, audioResume, audioFlush, audioDrain, this);
-                libvlc_audio_set_format(m_mediaPlayer, "S16N", static_cast<int>(currentSampleRate), 2);
+                applyAudioFormat();
             }
         }
     }
@@ -103,6 +136,14 @@ void VLCMediaPlayer_Desktop::ensureInitialized()
     isInitialized = true;
 }
 
+void VLCMediaPlayer_Desktop::applyAudioFormat()
+{
+    if (!m_mediaPlayer) return;
+
+    const int rate = (currentSampleRate > 0) ? static_cast<int>(currentSampleRate) : 44100;
+    libvlc_audio_set_format(m_mediaPlayer, amemFormat == AmemFormat::Float32 ? "FL32" : "S16N", rate, 2);
+}
+
 bool VLCMediaPlayer_Desktop::prepareToPlay(int samplesPerBlock, double sampleRate)
 {
     if (sampleRate > 1000.0) currentSampleRate = sampleRate;
@@ -110,28 +151,21 @@ bool VLCMediaPlayer_Desktop::prepareToPlay(int samplesPerBlock, double sampleRat
 
     ensureInitialized();
     maxBlockSize = samplesPerBlock;
-    
-    ringBuffer.setSize(2, InternalBufferSize); 
-    fifo.setTotalSize(ringBuffer.getNumSamples());
-    fifo.reset();
+    fifo.requestFlush();
 
-    if (m_mediaPlayer)
-    {
-        libvlc_audio_set_format(m_mediaPlayer, "S16N", static_cast<int>(currentSampleRate), 2);
-    }
+    applyAudioFormat();
 
     smoothedVolume = volume;
     
-    // Delay line for A/V sync — max 500ms at 96kHz = 48000 samples, use 65536 for headroom
-    delayBuffer.setSize(2, 65536);
+    // Delay line for A/V sync: maxAvDelaySeconds plus one block, rounded up for masking
+    delayBuffer.setSize(2, juce::nextPowerOfTwo((int)(currentSampleRate * maxAvDelaySeconds) + maxDelayBlock));
     delayBuffer.clear();
+    delayFadeBuffer.setSize(2, maxDelayBlock);
+    delayLength = delayBuffer.getNumSamples();
+    delayMask = delayLength - 1;
     delayWritePos = 0;
     delayTotalWritten = 0;
-    
-    // Compensate for audio-ahead-of-video pipeline latency (~100-200ms).
-    // Audio path (amem → FIFO → IPC → DAW) is faster than video path 
-    // (VLC decode → render to HWND), so we delay audio by 150ms.
-    avSyncDelaySamples = (int)(currentSampleRate * 0.26);
+    readDelaySamples = avSync.getDelayFrames();
     
     isPrepared = true;
     return true;
@@ -140,11 +174,6 @@ bool VLCMediaPlayer_Desktop::prepareToPlay(int samplesPerBlock, double sampleRat
 void VLCMediaPlayer_Desktop::releaseResources()
 {
     stop();
-    fifo.reset();
-    ringBuffer.clear();
-    delayBuffer.clear();
-    delayWritePos = 0;
-    delayTotalWritten = 0;
     isPrepared = false;
 }
 
@@ -165,6 +194,9 @@ void VLCMediaPlayer_Desktop::setWindowHandle(void* handle)
 
 void VLCMediaPlayer_Desktop::setVideoEnabled(bool enabled)
 {
+    // Audio only: no video decoding on the next load, and no video pipeline to wait for
+    videoEnabled = enabled;
+
     if (m_mediaPlayer)
     {
         libvlc_video_set_track(m_mediaPlayer, enabled ? 0 : -1);
@@ -173,20 +205,31 @@ void VLCMediaPlayer_Desktop::setVideoEnabled(bool enabled)
 
 void VLCMediaPlayer_Desktop::flushAudioBuffers()
 {
-    juce::ScopedLock sl(audioLock);
-    fifo.reset();
-    ringBuffer.clear();
-    delayBuffer.clear();
+    fifo.requestFlush();
+}
+
+void VLCMediaPlayer_Desktop::syncFlush()
+{
+    if (!fifo.applyPendingFlush()) return;
+
+    // Unprimed again: nothing older than the flush is read back out of the delay line
     delayWritePos = 0;
     delayTotalWritten = 0;
+    avSync.restart(juce::Time::getMillisecondCounterHiRes());
+    smoothedVolume = volume;
+}
+
+void VLCMediaPlayer_Desktop::applyPendingAudioDelay()
+{
+    const int64_t delayUs = pendingVlcDelayUs.exchange(noPendingDelay, std::memory_order_acquire);
+    if (delayUs != noPendingDelay && m_mediaPlayer)
+        libvlc_audio_set_delay(m_mediaPlayer, delayUs);
 }
 
 void VLCMediaPlayer_Desktop::setAudioDelay(int64_t delayMs)
 {
-    // Convert ms to samples at current sample rate
-    // Positive = delay audio (let video catch up)
-    int delaySamples = (int)((delayMs * (int64_t)currentSampleRate) / 1000LL);
-    avSyncDelaySamples = juce::jmax(0, delaySamples);
+    // Display and DAW output latency are not measured; the trim covers them
+    avSync.setTrimMs((int)delayMs);
 }
 
 bool VLCMediaPlayer_Desktop::loadFile(const juce::String& path)
@@ -195,8 +238,7 @@ bool VLCMediaPlayer_Desktop::loadFile(const juce::String& path)
     if (!m_instance || !m_mediaPlayer) return false;
     
     libvlc_media_player_set_rate(m_mediaPlayer, 1.0f);
-    int rate = (currentSampleRate > 0) ? static_cast<int>(currentSampleRate) : 44100;
-    libvlc_audio_set_format(m_mediaPlayer, "S16N", rate, 2);
+    applyAudioFormat();
 
     juce::URL fileURL = juce::URL(juce::File(path));
     juce::String urlString = fileURL.toString(true);
@@ -204,8 +246,14 @@ bool VLCMediaPlayer_Desktop::loadFile(const juce::String& path)
     libvlc_media_t* media = libvlc_media_new_location(m_instance, urlString.toUTF8());
     if (media == nullptr) return false;
 
+    if (!videoEnabled)
+        libvlc_media_add_option(media, ":no-video");
+
     libvlc_media_player_set_media(m_mediaPlayer, media);
     libvlc_media_release(media);
+    pendingVlcDelayUs.store(noPendingDelay, std::memory_order_relaxed);   // Measured on the old media
+    seekRequests.store(seekFlushes.load(std::memory_order_relaxed), std::memory_order_release);   // New media: no seek outstanding
+    avSync.mediaChanged(juce::Time::getMillisecondCounterHiRes());
     
     flushAudioBuffers();
     return true;
@@ -235,8 +283,10 @@ void VLCMediaPlayer_Desktop::setRate(float newRate)
 { 
     if (m_mediaPlayer) 
     {
-        flushAudioBuffers();
+        // No flush: what is queued plays out at the old speed, scaletempo takes over from there.
+        // The pts of the queued audio no longer match the clock, so measure A/V sync afresh.
         libvlc_media_player_set_rate(m_mediaPlayer, newRate);
+        avSync.restart(juce::Time::getMillisecondCounterHiRes());
     }
 }
 
@@ -261,19 +311,35 @@ void VLCMediaPlayer_Desktop::setPosition(float pos)
 { 
     if (m_mediaPlayer) 
     {
+        // Until VLC flushes amem for this seek, what it delivers is still from an older position.
+        // A flush that raced a load may have counted one seek ahead: start from there.
+        uint32_t requests = seekRequests.load(std::memory_order_relaxed);
+        const uint32_t flushes = seekFlushes.load(std::memory_order_relaxed);
+        if ((int32_t)(requests - flushes) < 0) requests = flushes;
+
+        seekIssuedMs.store(juce::Time::getMillisecondCounter(), std::memory_order_relaxed);
+        seekRequests.store(requests + 1, std::memory_order_release);
         flushAudioBuffers();
         libvlc_media_player_set_position(m_mediaPlayer, pos);
     }
 }
 
+double VLCMediaPlayer_Desktop::getPositionSeconds() const
+{
+    if (!m_mediaPlayer) return 0.0;
+    const libvlc_time_t ms = libvlc_media_player_get_time(m_mediaPlayer);
+    return ms > 0 ? (double)ms / 1000.0 : 0.0;
+}
+
 int64_t VLCMediaPlayer_Desktop::getLengthMs() const { 
     if (!m_mediaPlayer) return 0; 
     return libvlc_media_player_get_length(m_mediaPlayer);
 }
 
-int VLCMediaPlayer_Desktop::getNumAudioSamplesAvailable() const
+int VLCMediaPlayer_Desktop::getNumAudioSamplesAvailable()
 {
-    return fifo.getNumReady();
+    syncFlush();
+    return (int)fifo.getNumReady();
 }
 
 void VLCMediaPlayer_Desktop::audioPlay(void* data, const void* samples, unsigned count, int64_t pts) {
@@ -284,135 +350,146 @@ void VLCMediaPlayer_Desktop::audioPause(void*, int64_t) {}
 void VLCMediaPlayer_Desktop::audioResume(void*, int64_t) {}
 void VLCMediaPlayer_Desktop::audioFlush(void* data, int64_t) {
     auto* self = static_cast<VLCMediaPlayer_Desktop*>(data);
-    if (self) self->flushAudioBuffers();
+    if (self) {
+        // One flush per seek, in order: this one answers the oldest seek still outstanding
+        const uint32_t flushes = self->seekFlushes.load(std::memory_order_relaxed);
+        if ((int32_t)(self->seekRequests.load(std::memory_order_acquire) - flushes) > 0)
+            self->seekFlushes.store(flushes + 1, std::memory_order_relaxed);
+        self->flushAudioBuffers();
+    }
 }
 void VLCMediaPlayer_Desktop::audioDrain(void*) {}
 
 void VLCMediaPlayer_Desktop::addAudioSamples(const void* samples, unsigned count, int64_t pts) {
-    juce::ScopedLock sl(audioLock);
-    const int space = fifo.getFreeSpace();
-    int toWrite = juce::jmin(static_cast<int>(count), space);
-    if (toWrite > 0) {
-        int start1, size1, start2, size2;
-        fifo.prepareToWrite(toWrite, start1, size1, start2, size2);
+    // Stale audio from before the newest seek (VLC has not flushed for it yet) never reaches the FIFO
+    const uint32_t requests = seekRequests.load(std::memory_order_acquire);
+    if ((int32_t)(requests - seekFlushes.load(std::memory_order_relaxed)) > 0) {
+        if (juce::Time::getMillisecondCounter() - seekIssuedMs.load(std::memory_order_relaxed) < seekFlushTimeoutMs) return;
+        seekFlushes.store(requests, std::memory_order_relaxed);   // A flush went missing (VLC merged seeks)
+    }
+
+    // One kernel call per contiguous run of the FIFO (two at the wrap); what does not fit is dropped
+    if (amemFormat == AmemFormat::Float32) {
+        const float* src = static_cast<const float*>(samples);
+        fifo.write(count, [src](float* left, float* right, uint32_t offset, uint32_t n) {
+            PcmDeinterleave::f32(src + offset * 2, left, right, (int)n);
+        });
+    } else {
         const int16_t* src = static_cast<const int16_t*>(samples);
-        const float scale = 1.0f / 32768.0f;
-        if (size1 > 0) { 
-            for (int i = 0; i < size1; ++i) { 
-                ringBuffer.setSample(0, start1 + i, src[i * 2] * scale);
-                ringBuffer.setSample(1, start1 + i, src[i * 2 + 1] * scale);
-            } 
-        }
-        if (size2 > 0) { 
-            for (int i = 0; i < size2; ++i) { 
-                ringBuffer.setSample(0, start2 + i, src[(size1 + i) * 2] * scale);
-                ringBuffer.setSample(1, start2 + i, src[(size1 + i) * 2 + 1] * scale);
-            } 
-        }
-        fifo.finishedWrite(size1 + size2);
+        fifo.write(count, [src](float* left, float* right, uint32_t offset, uint32_t n) {
+            PcmDeinterleave::s16(src + offset * 2, left, right, (int)n);
+        });
     }
+
+    // A/V measurement for the newest frame: when VLC wants it heard vs what is queued in front of it
+    const double rate = currentSampleRate;
+    if (videoEnabled && pts > 0 && count > 0)
+        avSync.addMeasurement(libvlc_delay(pts) + (int64_t)((double)(count - 1) * 1.0e6 / rate),
+                              (int64_t)fifo.getNumReady() + outputLatencyFrames.load(std::memory_order_relaxed), rate);
 }
 
 void VLCMediaPlayer_Desktop::getNextAudioBlock(const juce::AudioSourceChannelInfo& info) {
     if (!isPrepared) { info.clearActiveBufferRegion(); return; }
     if (libvlc_media_player_get_state(m_mediaPlayer) == libvlc_Paused) { info.clearActiveBufferRegion(); return; }
     
-    juce::ScopedLock sl(audioLock);
+    syncFlush();
     
     const int numSamples = info.numSamples;
-    int available = fifo.getNumReady();
-    int toRead = juce::jmin(numSamples, available);
+    const int toRead = juce::jmin(numSamples, (int)fifo.getNumReady());
     
-    // No delay? Straight FIFO-to-output (original path, zero overhead)
-    if (avSyncDelaySamples <= 0)
+    // Audio only? Straight FIFO-to-output (original path, zero overhead)
+    if (!videoEnabled)
     {
         if (toRead > 0) {
-            int start1, size1, start2, size2;
-            fifo.prepareToRead(toRead, start1, size1, start2, size2);
-            
             const float targetVol = volume;
             const float startVol = smoothedVolume;
             const float volStep = (targetVol - startVol) / (float)toRead;
             
-            if (size1 > 0) {
-                for (int ch = 0; ch < 2; ++ch) {
-                    const float* src = ringBuffer.getReadPointer(ch, start1);
-                    float* dst = info.buffer->getWritePointer(ch, info.startSample);
-                    float vol = startVol;
-                    for (int i = 0; i < size1; ++i) { dst[i] = src[i] * vol; vol += volStep; }
-                }
-            }
-            if (size2 > 0) {
+            fifo.read((uint32_t)toRead, [&](const float* left, const float* right, uint32_t offset, uint32_t n) {
+                const float* channels[2] = { left, right };
                 for (int ch = 0; ch < 2; ++ch) {
-                    const float* src = ringBuffer.getReadPointer(ch, start2);
-                    float* dst = info.buffer->getWritePointer(ch, info.startSample + size1);
-                    float vol = startVol + volStep * size1;
-                    for (int i = 0; i < size2; ++i) { dst[i] = src[i] * vol; vol += volStep; }
+                    float* dst = info.buffer->getWritePointer(ch, info.startSample + (int)offset);
+                    float vol = startVol + volStep * (float)offset;
+                    for (uint32_t i = 0; i < n; ++i) { dst[i] = channels[ch][i] * vol; vol += volStep; }
                 }
-            }
+            });
             smoothedVolume = targetVol;
-            fifo.finishedRead(size1 + size2);
         }
         if (toRead < numSamples)
             info.buffer->clear(info.startSample + toRead, numSamples - toRead);
         return;
     }
     
-    // --- Delay line path ---
-    const int delayLen = delayBuffer.getNumSamples();
-    
+    getNextDelayedBlock(info, toRead);
+}
+
+void VLCMediaPlayer_Desktop::writeDelayLine(const float* left, const float* right, int numFrames)
+{
+    const float* channels[2] = { left, right };
+    const int first = juce::jmin(numFrames, delayLength - delayWritePos);
+
+    for (int ch = 0; ch < 2; ++ch) {
+        juce::FloatVectorOperations::copy(delayBuffer.getWritePointer(ch, delayWritePos), channels[ch], first);
+        if (numFrames > first)
+            juce::FloatVectorOperations::copy(delayBuffer.getWritePointer(ch), channels[ch] + first, numFrames - first);
+    }
+    delayWritePos = (delayWritePos + numFrames) & delayMask;
+    delayTotalWritten += numFrames;
+}
+
+void VLCMediaPlayer_Desktop::readDelayLine(juce::AudioBuffer<float>& dest, int destStart, int numFrames, int delayFrames)
+{
+    // The block that ends delayFrames behind the write head
+    const int readPos = (delayWritePos - delayFrames - numFrames) & delayMask;
+    const int first = juce::jmin(numFrames, delayLength - readPos);
+
+    for (int ch = 0; ch < juce::jmin(2, dest.getNumChannels()); ++ch) {
+        dest.copyFrom(ch, destStart, delayBuffer, ch, readPos, first);
+        if (numFrames > first)
+            dest.copyFrom(ch, destStart + first, delayBuffer, ch, 0, numFrames - first);
+    }
+}
+
+void VLCMediaPlayer_Desktop::getNextDelayedBlock(const juce::AudioSourceChannelInfo& info, int toRead) {
+    const int numSamples = info.numSamples;
+    jassert(numSamples <= maxDelayBlock);
+
     // Step 1: Drain FIFO into delay line
     if (toRead > 0) {
-        int start1, size1, start2, size2;
-        fifo.prepareToRead(toRead, start1, size1, start2, size2);
-        
-        if (size1 > 0) {
-            for (int ch = 0; ch < 2; ++ch) {
-                const float* src = ringBuffer.getReadPointer(ch, start1);
-                float* dly = delayBuffer.getWritePointer(ch);
-                for (int i = 0; i < size1; ++i)
-                    dly[(delayWritePos + i) % delayLen] = src[i];
-            }
-            delayWritePos = (delayWritePos + size1) % delayLen;
-            delayTotalWritten += size1;
-        }
-        if (size2 > 0) {
-            for (int ch = 0; ch < 2; ++ch) {
-                const float* src = ringBuffer.getReadPointer(ch, start2);
-                float* dly = delayBuffer.getWritePointer(ch);
-                for (int i = 0; i < size2; ++i)
-                    dly[(delayWritePos + i) % delayLen] = src[i];
-            }
-            delayWritePos = (delayWritePos + size2) % delayLen;
-            delayTotalWritten += size2;
-        }
-        fifo.finishedRead(size1 + size2);
+        fifo.read((uint32_t)toRead, [this](const float* left, const float* right, uint32_t, uint32_t n) {
+            writeDelayLine(left, right, (int)n);
+        });
     }
     
+    // A correction that is due. libVLC's half is handed to the message thread (the call takes
+    // libVLC's locks) and affects the audio VLC hands over after that; settleMs covers the lag.
+    AvSyncController::Correction correction;
+    if (avSync.update(juce::Time::getMillisecondCounterHiRes(), currentSampleRate, delayLength - maxDelayBlock, correction))
+        pendingVlcDelayUs.store(correction.vlcDelayUs, std::memory_order_release);
+    
     // Step 2: Read from delay line — but only if we've written enough to prime it
-    int effectiveDelay = avSyncDelaySamples;
-    if (delayTotalWritten < effectiveDelay + numSamples)
+    const int delay = avSync.getDelayFrames();
+    if (delayTotalWritten < delay + numSamples)
     {
         // Not primed yet — output silence, video catches up during this time
         info.clearActiveBufferRegion();
+        readDelaySamples = delay;
         return;
     }
     
-    // Read behind write head by effectiveDelay samples
-    int readPos = (delayWritePos - effectiveDelay - numSamples + delayLen * 2) % delayLen;
+    readDelayLine(*info.buffer, info.startSample, numSamples, delay);
     
-    const float targetVol = volume;
-    const float startVol = smoothedVolume;
-    const float volStep = (targetVol - startVol) / (float)numSamples;
-    
-    for (int ch = 0; ch < juce::jmin(2, info.buffer->getNumChannels()); ++ch) {
-        const float* dly = delayBuffer.getReadPointer(ch);
-        float* dst = info.buffer->getWritePointer(ch, info.startSample);
-        float vol = startVol;
-        for (int i = 0; i < numSamples; ++i) {
-            dst[i] = dly[(readPos + i) % delayLen] * vol;
-            vol += volStep;
+    // New correction: crossfade from the old read position to the new one over this block
+    if (delay != readDelaySamples && delayTotalWritten >= readDelaySamples + numSamples
+        && numSamples <= delayFadeBuffer.getNumSamples()) {
+        readDelayLine(delayFadeBuffer, 0, numSamples, readDelaySamples);
+        for (int ch = 0; ch < juce::jmin(2, info.buffer->getNumChannels()); ++ch) {
+            info.buffer->applyGainRamp(ch, info.startSample, numSamples, 0.0f, 1.0f);
+            info.buffer->addFromWithRamp(ch, info.startSample, delayFadeBuffer.getReadPointer(ch), numSamples, 1.0f, 0.0f);
         }
     }
-    smoothedVolume = targetVol;
-}
\ No newline at end of file
+    readDelaySamples = delay;
+    
+    info.buffer->applyGainRamp(info.startSample, numSamples, smoothedVolume, volume);
+    smoothedVolume = volume;
+}
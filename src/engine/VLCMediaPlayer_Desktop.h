@@ -6,6 +6,10 @@
 
     FIX: Volume smoothing to prevent clicks on volume changes.
     FIX: LoadLibraryW for Unicode DLL paths.
+    PERF: amem delivers FL32 (S16N fallback), deinterleaved by vector kernels.
+    PERF: No lock between VLC's callback thread and the pump: SpscPcmFifo with
+          epoch flushes; dropped frames are counted.
+    ADDED: Measured A/V sync (AvSyncController) replaces the fixed 260 ms delay.
 
   ==============================================================================
 */
@@ -16,6 +20,8 @@
 #include <juce_core/juce_core.h>
 #include <juce_audio_basics/juce_audio_basics.h>
 #include <juce_graphics/juce_graphics.h> 
+#include "SpscPcmFifo.h"
+#include "AvSyncController.h"
 
 extern "C" {
     #include <vlc/libvlc.h>
@@ -42,8 +48,9 @@ public:
     float getRate() const;
     bool hasFinished() const;
 
+    // Pump thread (the FIFO's consumer): both apply a pending flush first
     void getNextAudioBlock(const juce::AudioSourceChannelInfo& info);
-    int getNumAudioSamplesAvailable() const;
+    int getNumAudioSamplesAvailable();
 
     void setWindowHandle(void* handle);
     
@@ -52,12 +59,27 @@ public:
     float getPosition() const;
     void setPosition(float pos);
     int64_t getLengthMs() const;
+    double getPositionSeconds() const;   // Full resolution, for the status timeline
     
+    // Any thread, never blocks: the pump drops the buffered audio on its next call
     void flushAudioBuffers();
+
+    // Frames VLC delivered into a full FIFO (late decoder blocks are counted by the engine's decode stage)
+    uint32_t getDroppedFrames() const { return fifo.getDroppedFrames(); }
     
-    // A/V Sync: delay in milliseconds (positive = delay audio, let video catch up)
+    // A/V sync trim on top of the measured correction, in ms (positive = delay audio)
     void setAudioDelay(int64_t delayMs);
 
+    // Message thread: hands libVLC the audio delay of the pump's last correction, if any
+    void applyPendingAudioDelay();
+
+    // Pump thread: frames queued after this player (engine queue + IPC ring), part of the audio latency
+    void setOutputLatencyFrames(int frames) { outputLatencyFrames.store(frames, std::memory_order_relaxed); }
+
+    // Measured skew (> 0: audio late, before the trim) and the correction in effect (delay line + libVLC)
+    double getAvSkewMs() const        { return avSync.getMeasuredSkewMs(); }
+    double getAvCorrectionMs() const  { return avSync.getCorrectionMs(currentSampleRate); }
+
 private:
     void ensureInitialized();
     bool isInitialized = false;
@@ -71,26 +93,52 @@ private:
 
     void addAudioSamples(const void* samples, unsigned count, int64_t pts);
 
+    // What amem hands addAudioSamples(): FL32 by default, S16N with PLAYLISTED_VLC_AUDIO_FORMAT=s16n
+    enum class AmemFormat { Float32, Int16 };
+    void applyAudioFormat();
+
+    // Pump thread: applies a pending flush to the FIFO and resets the delay line
+    void syncFlush();
+
+    // Pump thread: A/V delay line, at most two contiguous copies per call
+    void writeDelayLine(const float* left, const float* right, int numFrames);
+    void readDelayLine(juce::AudioBuffer<float>& dest, int destStart, int numFrames, int delayFrames);
+    void getNextDelayedBlock(const juce::AudioSourceChannelInfo& info, int toRead);
+
     libvlc_instance_t* m_instance = nullptr;
     libvlc_media_player_t* m_mediaPlayer = nullptr;
-    juce::CriticalSection audioLock;
     
-    static const int InternalBufferSize = 16384;
-    juce::AudioBuffer<float> ringBuffer {2, InternalBufferSize}; 
-    juce::AbstractFifo fifo {InternalBufferSize};
+    static const int InternalBufferSize = 16384;   // Power of two (SpscPcmFifo)
+    SpscPcmFifo fifo { InternalBufferSize };
+
+    // Seek generations: setPosition counts requests (pump), VLC's amem flushes count them off
+    // (callback thread). Audio delivered while any is outstanding is from before the newest seek.
+    std::atomic<uint32_t> seekRequests { 0 }, seekFlushes { 0 };
+    std::atomic<juce::uint32> seekIssuedMs { 0 };   // Newest request; its flush is given up on after the timeout
+    static constexpr juce::uint32 seekFlushTimeoutMs = 500;
 
-    double currentSampleRate = 44100.0;
+    AmemFormat amemFormat = AmemFormat::Float32;   // Chosen once in ensureInitialized()
+    std::atomic<double> currentSampleRate { 44100.0 };   // Also read by the callback (A/V measurement)
     int maxBlockSize = 512;
     
     // Volume with smoothing
     float volume = 1.0f;
     float smoothedVolume = 1.0f;
-    int avSyncDelaySamples = 0;  // Audio delay in samples for A/V sync
+    std::atomic<bool> videoEnabled { true };   // false: media loads with :no-video, no A/V sync
     
-    // Delay line buffer for A/V sync
-    juce::AudioBuffer<float> delayBuffer;
+    // A/V sync: measurement and correction, and the delay line it drives (pump thread)
+    AvSyncController avSync;
+    std::atomic<int> outputLatencyFrames { 0 };
+    static constexpr int64_t noPendingDelay = INT64_MIN;
+    std::atomic<int64_t> pendingVlcDelayUs { noPendingDelay };   // Pump -> message thread (libvlc_audio_set_delay)
+    static constexpr double maxAvDelaySeconds = 1.0;
+    static constexpr int maxDelayBlock = 8192;   // Largest block read through the delay line
+    juce::AudioBuffer<float> delayBuffer;        // Power-of-two length
+    juce::AudioBuffer<float> delayFadeBuffer;    // Old read position while a correction fades in
+    int delayLength = 0, delayMask = 0;
     int delayWritePos = 0;
     int64_t delayTotalWritten = 0;
+    int readDelaySamples = 0;                    // Delay the last block was read at
     
     bool isPrepared = false;
 